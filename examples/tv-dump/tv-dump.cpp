@@ -69,9 +69,9 @@ void dump_code_points(
     ios_format_preserver ifp{cout};
 
     using CUT = code_unit_type_t<ET>;
-    ranges::istream_iterator<CUT> ifs_in{ifs}, ifs_end{};
+    auto sv = make_streambuf_view<CUT>(ifs.rdbuf());
 
-    auto tv = make_text_view<ET>(ifs_in, ifs_end);
+    auto tv = make_text_view<ET>(sv);
     for (const auto &ch : tv) {
         auto csid = ch.get_character_set_id();
         cout << "0x" << hex << setw(8) << setfill('0')
@@ -137,7 +137,6 @@ int main(
         cerr << "error: failed to open file " << file_name << "." << endl;
         return exit_failure;
     }
-    ifs >> noskipws;
 
     try {
         if (strcmp(encoding, "utf-8") == 0) {
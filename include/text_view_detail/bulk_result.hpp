@@ -0,0 +1,87 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_BULK_RESULT_HPP // {
+#define TEXT_VIEW_BULK_RESULT_HPP
+
+
+#include <cstddef>
+#include <text_view_detail/error_status.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+/*
+ * decode_n_result
+ * Reports the outcome of a bulk decode operation.  code_units is the number
+ * of code units consumed from the input and code_points is the number of
+ * code points written to the output.  If an error occurred, status holds the
+ * error and code_units is the offset of the code unit sequence that could not
+ * be decoded; the input up to that offset has been fully decoded.
+ */
+struct decode_n_result {
+    std::ptrdiff_t code_units;
+    std::ptrdiff_t code_points;
+    decode_status status;
+};
+
+
+/*
+ * encode_n_result
+ * Reports the outcome of a bulk encode operation.  code_points is the number
+ * of code points consumed from the input and code_units is the number of code
+ * units written to, or when measuring, required by the output.  If an error
+ * occurred, status holds the error and code_points is the offset of the code
+ * point that could not be encoded; the input up to that offset has been fully
+ * encoded.
+ */
+struct encode_n_result {
+    std::ptrdiff_t code_points;
+    std::ptrdiff_t code_units;
+    encode_status status;
+};
+
+
+/*
+ * validate_result
+ * Reports the outcome of a validation operation.  code_units is the length
+ * of the longest well-formed prefix of the input; if status reports an error,
+ * code_units is therefore the offset of the first ill-formed code unit
+ * sequence.
+ */
+struct validate_result {
+    std::ptrdiff_t code_units;
+    decode_status status;
+};
+
+
+/*
+ * transcode_result
+ * Reports the outcome of a transcode operation.  input_code_units is the
+ * number of code units consumed from the input and output_code_units is the
+ * number of code units written to the output.  If a code unit sequence of the
+ * input could not be decoded, input_status holds the error; if a decoded
+ * character could not be encoded, output_status holds the error.  In either
+ * case, input_code_units is the offset of the code unit sequence that could
+ * not be transcoded; the input up to that offset has been fully transcoded.
+ */
+struct transcode_result {
+    std::ptrdiff_t input_code_units;
+    std::ptrdiff_t output_code_units;
+    decode_status input_status;
+    encode_status output_status;
+};
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_BULK_RESULT_HPP
@@ -8,8 +8,13 @@
 #define TEXT_VIEW_CACHING_ITERATOR_HPP
 
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
 #include <deque>
-#include <memory>
+#include <iterator>
+#include <utility>
+#include <vector>
 #include <experimental/ranges/iterator>
 #include <text_view_detail/basic_view.hpp>
 
@@ -28,12 +33,39 @@ namespace text_detail {
 // caching_iterator; this is necessary so that the copies share the same data
 // structures and reference the same copy of the adapted input iterator.
 //
+// The shared data structures are allocated once, when a caching_iterator is
+// constructed from an input iterator, and are released with the last
+// caching_iterator that shares them.  Since input iterators cannot be shared
+// between threads, the number of caching_iterators that share them is
+// maintained with a reference count that is not atomic; copying a
+// caching_iterator copies a pointer and increments a counter.
+//
 // The shared cache held by a set of caching_iterators grows indefinitely as
 // the underlying input iterator is dereferenced and advanced.  Calling
 // clear_cache() on a given caching_iterator discards values not reachable from
 // that iterator and invalidates all other iterators that adapt the same input
 // iterator.
 //
+// A caching_iterator constructed with a window size holds no more than that
+// number of values in the shared cache; reading a value from the underlying
+// input iterator when the cache is full discards the oldest cached value.
+// Iterators that reference a discarded value, or that were invalidated by
+// clear_cache(), are invalidated and must not be used other than to be
+// assigned to or destroyed; doing so is detected by an assertion when NDEBUG
+// is not defined.  The cache_high_water_mark() member function returns the
+// largest number of values held in the shared cache at once, with or without
+// a window, and may be used to determine a suitable window size.
+//
+// When a non-zero capacity N is specified, values are cached in a buffer of
+// that capacity held within the shared data instead of in a std::deque, so
+// that reading values does not allocate memory while no more than N values
+// are cached between calls to clear_cache().  Clearing the cache moves the
+// values reachable from the iterator to the start of the buffer so that the
+// cached values remain contiguous.  Should more than N values be cached, they
+// are moved to a std::vector that is used from then on.  This suits
+// iterators, such as itext_iterator, that usually clear the cache after
+// reading a bounded number of values.
+//
 // The cached_range() and look_ahead_range() member functions provide access to
 // the cached values read from the underlying input iterator.  The values held
 // in the look_ahead_range() correspond to values that will be read as the
@@ -41,7 +73,106 @@ namespace text_detail {
 // to retrieve values that were read by algorithms, such as parsers, that
 // require some degree of look ahead, but that still require further processing.
 
-template<ranges::InputIterator I>
+// Cursors share their data through a reference count, and the data is only
+// deleted when the last cursor that refers to it releases it.  GCC 12 and
+// later versions cannot see that the count stays above zero when one of two
+// cursors sharing the data releases it.  Once release() is inlined, they
+// diagnose the later uses of the data through the other cursor as uses after
+// it is freed.  The diagnostic is reported at those uses rather than at the
+// delete, so it is disabled for the cache buffer and cursor that hold them.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuse-after-free"
+#endif
+
+// The storage for the values cached by a caching_iterator with capacity N.
+// The values are held in a std::deque when N is 0.
+template<typename T, std::size_t N>
+class caching_iterator_buffer {
+public:
+    using iterator = const T*;
+
+    iterator begin() const noexcept {
+        return data();
+    }
+    iterator end() const noexcept {
+        return data() + count;
+    }
+    std::size_t size() const noexcept {
+        return count;
+    }
+    const T& operator[](std::size_t i) const noexcept {
+        return data()[i];
+    }
+
+    void push_back(T value) {
+        if (spilled()) {
+            overflow.push_back(std::move(value));
+        } else if (count < N) {
+            values[count] = std::move(value);
+        } else {
+            overflow.reserve(2 * N);
+            overflow.assign(
+                std::make_move_iterator(values),
+                std::make_move_iterator(values + count));
+            overflow.push_back(std::move(value));
+        }
+        ++count;
+    }
+
+    void erase_front(std::size_t n) {
+        if (spilled()) {
+            overflow.erase(overflow.begin(), overflow.begin() + n);
+        } else {
+            std::move(values + n, values + count, values);
+        }
+        count -= n;
+    }
+
+private:
+    bool spilled() const noexcept {
+        return overflow.capacity() != 0;
+    }
+    const T* data() const noexcept {
+        return spilled() ? overflow.data() : values;
+    }
+
+    T values[N];
+    std::vector<T> overflow;
+    std::size_t count = 0;
+};
+
+template<typename T>
+class caching_iterator_buffer<T, 0> {
+public:
+    using iterator = typename std::deque<T>::const_iterator;
+
+    iterator begin() const noexcept {
+        return values.begin();
+    }
+    iterator end() const noexcept {
+        return values.end();
+    }
+    std::size_t size() const noexcept {
+        return values.size();
+    }
+    const T& operator[](std::size_t i) const noexcept {
+        return values[i];
+    }
+
+    void push_back(T value) {
+        values.push_back(std::move(value));
+    }
+
+    void erase_front(std::size_t n) {
+        values.erase(values.begin(), values.begin() + n);
+    }
+
+private:
+    std::deque<T> values;
+};
+
+template<ranges::InputIterator I, std::size_t N = 0>
 requires ! ranges::ForwardIterator<I>
 class caching_cursor
 {
@@ -53,10 +184,17 @@ class caching_cursor
 
     class shared_data {
     public:
-        shared_data(I current) : current(current) {}
+        shared_data(I current, std::size_t window)
+            : current(current), window{window} {}
 
         iterator_type current;
-        std::deque<value_type> cache;
+        caching_iterator_buffer<value_type, N> cache;
+        // The number of values read from the input iterator that have been
+        // discarded from the front of the cache.
+        std::size_t offset = 0;
+        std::size_t window;
+        std::size_t high_water_mark = 0;
+        std::size_t references = 1;
     };
 
 public:
@@ -74,6 +212,11 @@ public:
             base_type{caching_cursor{std::move(current)}}
         {}
 
+        mixin(iterator_type current, std::size_t window)
+        :
+            base_type{caching_cursor{std::move(current), window}}
+        {}
+
         using base_type::base_type;
 
         const iterator_type& base() const noexcept {
@@ -92,12 +235,17 @@ public:
             return this->get().clear_cache();
         }
 
+        std::size_t cache_high_water_mark() const noexcept {
+            return this->get().cache_high_water_mark();
+        }
+
     private:
         std::size_t position() const {
             return this->get().position;
         }
-        std::size_t cache_size() const {
-            return this->get().current_data->cache.size();
+        std::size_t cache_end() const {
+            return this->get().current_data->offset
+                 + this->get().current_data->cache.size();
         }
     };
 
@@ -105,10 +253,55 @@ public:
 
     caching_cursor(iterator_type current)
     :
-        current_data(make_shared<shared_data>(std::move(current))),
+        current_data(new shared_data(std::move(current), 0)),
         position{0}
     {}
 
+    caching_cursor(iterator_type current, std::size_t window)
+    :
+        current_data(new shared_data(std::move(current), window)),
+        position{0}
+    {
+        assert(window != 0);
+    }
+
+    caching_cursor(const caching_cursor &other) noexcept
+    :
+        current_data(other.current_data),
+        position{other.position}
+    {
+        acquire();
+    }
+
+    caching_cursor(caching_cursor &&other) noexcept
+    :
+        current_data(other.current_data),
+        position{other.position}
+    {
+        other.current_data = nullptr;
+    }
+
+    ~caching_cursor() {
+        release();
+    }
+
+    caching_cursor& operator=(const caching_cursor &other) noexcept {
+        caching_cursor tmp{other};
+        std::swap(current_data, tmp.current_data);
+        std::swap(position, tmp.position);
+        return *this;
+    }
+
+    caching_cursor& operator=(caching_cursor &&other) noexcept {
+        if (this != &other) {
+            release();
+            current_data = other.current_data;
+            position = other.position;
+            other.current_data = nullptr;
+        }
+        return *this;
+    }
+
     reference read() const {
         return dereference();
     }
@@ -135,44 +328,79 @@ public:
     auto cached_range() const noexcept {
         return make_basic_view(
                    current_data->cache.begin(),
-                   current_data->cache.begin()+position);
+                   current_data->cache.begin()+index());
     }
 
     auto look_ahead_range() const noexcept {
         return make_basic_view(
-                   current_data->cache.begin()+position,
+                   current_data->cache.begin()+index(),
                    current_data->cache.end());
     }
 
     // clear_cache() invalidates all other iterators.
     void clear_cache() const {
-        current_data->cache.erase(
-            current_data->cache.begin(),
-            current_data->cache.begin()+position);
-        position = 0;
+        current_data->cache.erase_front(index());
+        current_data->offset = position;
+    }
+
+    // Returns the largest number of values that have been cached at once.
+    std::size_t cache_high_water_mark() const noexcept {
+        return current_data->high_water_mark;
     }
 
 private:
+    void acquire() const noexcept {
+        if (current_data) {
+            ++current_data->references;
+        }
+    }
+
+    void release() noexcept {
+        if (current_data && --current_data->references == 0) {
+            delete current_data;
+        }
+    }
+
+    // Returns the index within the cache of the value at the current
+    // position.
+    std::size_t index() const noexcept {
+        assert(position >= current_data->offset &&
+               "caching_iterator was invalidated");
+        return position - current_data->offset;
+    }
+
     const value_type& dereference() const {
-        if (position >= current_data->cache.size()) {
+        if (index() >= current_data->cache.size()) {
+            std::size_t window = current_data->window;
+            if (window != 0 && current_data->cache.size() >= window) {
+                std::size_t n = current_data->cache.size() - window + 1;
+                current_data->cache.erase_front(n);
+                current_data->offset += n;
+            }
             current_data->cache.push_back(*current_data->current);
             ++current_data->current;
+            current_data->high_water_mark = std::max(
+                current_data->high_water_mark, current_data->cache.size());
         }
-        return current_data->cache[position];
+        return current_data->cache[index()];
     }
 
-    std::shared_ptr<shared_data> current_data;
-    mutable std::size_t position;
+    shared_data *current_data = nullptr;
+    std::size_t position = 0;
 };
 
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic pop
+#endif
+
 
 /*
  * caching_iterator
  */
-template<ranges::InputIterator I>
+template<ranges::InputIterator I, std::size_t N = 0>
 requires ! ranges::ForwardIterator<I>
 using caching_iterator =
-    ranges::basic_iterator<caching_cursor<I>>;
+    ranges::basic_iterator<caching_cursor<I, N>>;
 
 
 /*
@@ -185,6 +413,31 @@ make_caching_iterator(I i) {
     return { i };
 }
 
+// Overload to construct a caching_iterator with an explicitly specified
+// capacity.
+template<std::size_t N, ranges::InputIterator I>
+requires ! ranges::ForwardIterator<I>
+caching_iterator<I, N>
+make_caching_iterator(I i) {
+    return { i };
+}
+
+// Overloads to construct a caching_iterator that caches no more than window
+// values.
+template<ranges::InputIterator I>
+requires ! ranges::ForwardIterator<I>
+caching_iterator<I>
+make_caching_iterator(I i, std::size_t window) {
+    return { i, window };
+}
+
+template<std::size_t N, ranges::InputIterator I>
+requires ! ranges::ForwardIterator<I>
+caching_iterator<I, N>
+make_caching_iterator(I i, std::size_t window) {
+    return { i, window };
+}
+
 
 /*
  * caching_iterator_sentinel
@@ -200,35 +453,35 @@ public:
     caching_iterator_sentinel(sentinel s)
         : s(std::move(s)) {}
 
-    template<ranges::InputIterator I>
+    template<ranges::InputIterator I, std::size_t N>
     requires ranges::Sentinel<S, I>
     friend bool operator==(
-        const caching_iterator<I> &ci,
+        const caching_iterator<I, N> &ci,
         const caching_iterator_sentinel &cis)
     {
         return cis.equal(ci);
     }
-    template<ranges::InputIterator I>
+    template<ranges::InputIterator I, std::size_t N>
     requires ranges::Sentinel<S, I>
     friend bool operator!=(
-        const caching_iterator<I> &ci,
+        const caching_iterator<I, N> &ci,
         const caching_iterator_sentinel &cis)
     {
         return !(ci == cis);
     }
-    template<ranges::InputIterator I>
+    template<ranges::InputIterator I, std::size_t N>
     requires ranges::Sentinel<S, I>
     friend bool operator==(
         const caching_iterator_sentinel &cis,
-        const caching_iterator<I> &ci)
+        const caching_iterator<I, N> &ci)
     {
         return ci == cis;
     }
-    template<ranges::InputIterator I>
+    template<ranges::InputIterator I, std::size_t N>
     requires ranges::Sentinel<S, I>
     friend bool operator!=(
         const caching_iterator_sentinel &cis,
-        const caching_iterator<I> &ci)
+        const caching_iterator<I, N> &ci)
     {
         return !(cis == ci);
     }
@@ -238,10 +491,10 @@ public:
     }
 
 private:
-    template<ranges::InputIterator I>
+    template<ranges::InputIterator I, std::size_t N>
     requires ranges::Sentinel<S, I>
-    bool equal(const caching_iterator<I> &ci) const {
-        return ci.position() == ci.cache_size()
+    bool equal(const caching_iterator<I, N> &ci) const {
+        return ci.position() == ci.cache_end()
             && ci.base() == s;
     }
 
@@ -0,0 +1,128 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_CODE_POINT_COUNT_HPP // {
+#define TEXT_VIEW_CODE_POINT_COUNT_HPP
+
+
+#include <experimental/ranges/iterator>
+#include <text_view_detail/adl_customization.hpp>
+#include <text_view_detail/bulk_result.hpp>
+#include <text_view_detail/codecs/codec_util.hpp>
+#include <text_view_detail/concepts.hpp>
+#include <text_view_detail/itext_iterator.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+namespace text_detail {
+
+/*
+ * Code point counter concept.  Satisfied by encodings that provide a
+ * code_point_count() member for counting the characters of contiguous code
+ * unit sequences, when used with views that hold pointers to such sequences.
+ */
+template<typename ET, typename VT>
+concept bool CodePointCounter() {
+    return ContiguousCodeUnitView<ET, VT>()
+        && requires (const code_unit_type_t<ET> *p) {
+               { ET::code_point_count(p, p) } noexcept -> std::ptrdiff_t;
+           };
+}
+
+/*
+ * Stateful contiguous bulk decoder concept.  Satisfied by encodings, such as
+ * the BOM encodings, that provide a decode_n() member for decoding contiguous
+ * code unit sequences starting in a specified encoding state, when used with
+ * views that hold pointers to such sequences.
+ */
+template<typename ET, typename VT>
+concept bool StatefulContiguousBulkDecoder() {
+    return ContiguousCodeUnitView<ET, VT>()
+        && requires (typename ET::state_type &state,
+                     const code_unit_type_t<ET> *p,
+                     code_point_type_t<
+                         character_set_type_t<character_type_t<ET>>> *o)
+           {
+               { ET::decode_n(state, p, p, o, o) } noexcept
+                   -> decode_n_result;
+           };
+}
+
+} // namespace text_detail
+
+
+/*
+ * code_point_count
+ * Returns the number of characters in a text view; that is, the value that
+ * ranges::distance() would return.  As when iterating the view, each
+ * ill-formed code unit sequence counts as one character and no exception is
+ * thrown for it regardless of the error policy.
+ */
+// Overload for views of contiguous code units with an encoding that provides
+// a dedicated counting routine.  Well-formed code unit sequences are counted
+// without being decoded.
+template<TextView TVT>
+requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+      && text_detail::CodePointCounter<
+             encoding_type_t<TVT>, typename TVT::view_type>()
+ranges::difference_type_t<ranges::iterator_t<const TVT>>
+code_point_count(const TVT &tv) noexcept
+{
+    return encoding_type_t<TVT>::code_point_count(
+        text_detail::adl_begin(tv.base()),
+        text_detail::adl_end(tv.base()));
+}
+
+// Overload for views of contiguous code units with a stateful encoding that
+// provides decode_n(), such as the BOM encodings.  The byte order mark is
+// resolved once, after which well-formed code unit sequences are decoded a
+// block at a time by the codec for the resolved byte order.
+template<TextView TVT>
+requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+      && text_detail::StatefulContiguousBulkDecoder<
+             encoding_type_t<TVT>, typename TVT::view_type>()
+ranges::difference_type_t<ranges::iterator_t<const TVT>>
+code_point_count(const TVT &tv) noexcept
+{
+    return text_detail::code_point_count_by_decode_n<encoding_type_t<TVT>>(
+        tv.initial_state(),
+        text_detail::adl_begin(tv.base()),
+        text_detail::adl_end(tv.base()));
+}
+
+// Overload for views of forward code unit iterators.  The decode() member of
+// the encoding is called directly, without the bookkeeping performed by the
+// view's iterator.
+template<TextView TVT>
+requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+ranges::difference_type_t<ranges::iterator_t<const TVT>>
+code_point_count(const TVT &tv)
+{
+    return text_detail::code_point_count_by_decode<encoding_type_t<TVT>>(
+        tv.initial_state(),
+        text_detail::adl_begin(tv.base()),
+        text_detail::adl_end(tv.base()));
+}
+
+// Overload for views of input code unit iterators.  The view is iterated.
+template<TextView TVT>
+ranges::difference_type_t<ranges::iterator_t<const TVT>>
+code_point_count(const TVT &tv)
+{
+    return ranges::distance(tv);
+}
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_CODE_POINT_COUNT_HPP
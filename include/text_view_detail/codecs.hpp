@@ -8,8 +8,11 @@
 #define TEXT_VIEW_CODECS_HPP
 
 
+#include <text_view_detail/codecs/fixed_width_codec.hpp>
+#include <text_view_detail/codecs/latin1_codec.hpp>
 #include <text_view_detail/codecs/trivial_codec.hpp>
 #include <text_view_detail/codecs/utf8_codec.hpp>
+#include <text_view_detail/codecs/utf8_dfa_codec.hpp>
 #include <text_view_detail/codecs/utf8bom_codec.hpp>
 #include <text_view_detail/codecs/utf16_codec.hpp>
 #include <text_view_detail/codecs/utf16be_codec.hpp>
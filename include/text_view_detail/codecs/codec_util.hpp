@@ -8,8 +8,12 @@
 #define TEXT_VIEW_CODECS_CODEC_UTIL_HPP
 
 
+#include <algorithm>
+#include <cstddef>
 #include <utility>
 #include <experimental/ranges/concepts>
+#include <text_view_detail/bulk_result.hpp>
+#include <text_view_detail/error_status.hpp>
 
 
 namespace std {
@@ -73,6 +77,303 @@ private:
 };
 
 
+/*
+ * Decodes a contiguous code unit sequence one character at a time with the
+ * decode() member of a stateless codec.  Used as the fallback for codecs and
+ * code unit types that lack a dedicated bulk decoding routine.  As for the
+ * dedicated routines, an ill-formed code unit sequence is not skipped.
+ */
+template<typename Codec>
+decode_n_result decode_n_by_decode(
+    const typename Codec::code_unit_type *in_first,
+    const typename Codec::code_unit_type *in_last,
+    typename Codec::code_point_type *out_first,
+    typename Codec::code_point_type *out_last)
+noexcept
+{
+    typename Codec::state_type state{};
+    const typename Codec::code_unit_type *in_next = in_first;
+    typename Codec::code_point_type *out_next = out_first;
+    decode_status ds = decode_status::no_error;
+    while (in_next != in_last && out_next != out_last) {
+        const typename Codec::code_unit_type *in_prev = in_next;
+        typename Codec::character_type c;
+        int decoded_code_units = 0;
+        ds = Codec::decode(state, in_next, in_last, c, decoded_code_units);
+        if (error_occurred(ds)) {
+            in_next = in_prev;
+            break;
+        }
+        *out_next++ = c.get_code_point();
+    }
+    return { in_next - in_first, out_next - out_first, ds };
+}
+
+
+/*
+ * Resolves the byte order mark of a contiguous code unit sequence that is
+ * decoded with a BOM codec starting in the specified state.  If a BOM has
+ * not yet been read, the first character is decoded with the decode() member
+ * of the codec; that reads a BOM, if present, and records the byte order in
+ * the state.  in_next is advanced past a BOM so that decoding can continue
+ * with the codec for the resolved byte order.  If the first character is
+ * ill-formed, the error is returned and neither the state nor in_next is
+ * modified.
+ */
+template<typename Codec>
+decode_status resolve_bom(
+    typename Codec::state_type &state,
+    const typename Codec::code_unit_type *&in_next,
+    const typename Codec::code_unit_type *in_last)
+noexcept
+{
+    if (state.bom_read_or_written || in_next == in_last) {
+        return decode_status::no_error;
+    }
+    typename Codec::state_type tmp_state = state;
+    const typename Codec::code_unit_type *tmp_next = in_next;
+    typename Codec::character_type c;
+    int decoded_code_units = 0;
+    decode_status ds = Codec::decode(
+        tmp_state, tmp_next, in_last, c, decoded_code_units);
+    if (error_occurred(ds)) {
+        return ds;
+    }
+    state = tmp_state;
+    if (ds == decode_status::no_character) {
+        in_next = tmp_next;
+    }
+    return decode_status::no_error;
+}
+
+
+/*
+ * Validates a contiguous code unit sequence by decoding it a block at a time
+ * with the decode_n() member of a codec.  Used as the fallback for codecs and
+ * code unit types that lack a dedicated validation routine.
+ */
+template<typename Codec>
+validate_result validate_by_decode_n(
+    const typename Codec::code_unit_type *in_first,
+    const typename Codec::code_unit_type *in_last)
+noexcept
+{
+    constexpr int buffer_size = 256;
+    typename Codec::code_point_type buffer[buffer_size];
+    const typename Codec::code_unit_type *in_next = in_first;
+    for (;;) {
+        decode_n_result r = Codec::decode_n(
+            in_next, in_last, buffer, buffer + buffer_size);
+        in_next += r.code_units;
+        if (r.status != decode_status::no_error || in_next == in_last) {
+            return { in_next - in_first, r.status };
+        }
+    }
+}
+
+
+/*
+ * Counts the code points of the longest well-formed prefix of a contiguous
+ * code unit sequence by decoding it a block at a time with the decode_n()
+ * member of a codec.  Used by codecs and code unit types that lack a
+ * dedicated counting routine.
+ */
+template<typename Codec>
+decode_n_result decoded_length_by_decode_n(
+    const typename Codec::code_unit_type *in_first,
+    const typename Codec::code_unit_type *in_last)
+noexcept
+{
+    constexpr int buffer_size = 256;
+    typename Codec::code_point_type buffer[buffer_size];
+    const typename Codec::code_unit_type *in_next = in_first;
+    std::ptrdiff_t length = 0;
+    for (;;) {
+        decode_n_result r = Codec::decode_n(
+            in_next, in_last, buffer, buffer + buffer_size);
+        in_next += r.code_units;
+        length += r.code_points;
+        if (r.status != decode_status::no_error || in_next == in_last) {
+            return { in_next - in_first, length, r.status };
+        }
+    }
+}
+
+
+/*
+ * Encodes a contiguous code point sequence one code point at a time with the
+ * encode() member of a codec.  Used as the fallback for codecs and code unit
+ * types that lack a dedicated bulk encoding routine.  Code units are encoded
+ * to a temporary buffer when the output may be too small to hold them so
+ * that none are written unless all of them fit.
+ */
+template<typename Codec>
+encode_n_result encode_n_by_encode(
+    const typename Codec::code_point_type *in_first,
+    const typename Codec::code_point_type *in_last,
+    typename Codec::code_unit_type *out_first,
+    typename Codec::code_unit_type *out_last)
+noexcept
+{
+    using code_unit_type = typename Codec::code_unit_type;
+    typename Codec::state_type state{};
+    const typename Codec::code_point_type *in_next = in_first;
+    code_unit_type *out_next = out_first;
+    encode_status es = encode_status::no_error;
+    for (; in_next != in_last; ++in_next) {
+        typename Codec::character_type c;
+        c.set_code_point(*in_next);
+        code_unit_type buffer[Codec::max_code_units];
+        code_unit_type *buffer_next = buffer;
+        int encoded_code_units = 0;
+        if (out_last - out_next >= Codec::max_code_units) {
+            es = Codec::encode(state, out_next, c, encoded_code_units);
+        } else {
+            es = Codec::encode(state, buffer_next, c, encoded_code_units);
+            if (! error_occurred(es) &&
+                out_last - out_next < buffer_next - buffer)
+            {
+                break;
+            }
+            out_next = std::copy(buffer, buffer_next, out_next);
+        }
+        if (error_occurred(es)) {
+            break;
+        }
+    }
+    return { in_next - in_first, out_next - out_first, es };
+}
+
+
+/*
+ * Measures the number of code units required to encode a contiguous code
+ * point sequence by encoding it one code point at a time with the encode()
+ * member of a codec.  Used as the fallback for codecs and code unit types
+ * that lack a dedicated measuring routine.
+ */
+template<typename Codec>
+encode_n_result encoded_length_by_encode(
+    const typename Codec::code_point_type *in_first,
+    const typename Codec::code_point_type *in_last)
+noexcept
+{
+    using code_unit_type = typename Codec::code_unit_type;
+    typename Codec::state_type state{};
+    const typename Codec::code_point_type *in_next = in_first;
+    std::ptrdiff_t length = 0;
+    encode_status es = encode_status::no_error;
+    for (; in_next != in_last; ++in_next) {
+        typename Codec::character_type c;
+        c.set_code_point(*in_next);
+        code_unit_type buffer[Codec::max_code_units];
+        code_unit_type *buffer_next = buffer;
+        int encoded_code_units = 0;
+        es = Codec::encode(state, buffer_next, c, encoded_code_units);
+        if (error_occurred(es)) {
+            break;
+        }
+        length += buffer_next - buffer;
+    }
+    return { in_next - in_first, length, es };
+}
+
+
+/*
+ * Counts the characters produced by iterating a code unit sequence by
+ * decoding them one at a time with the decode() member of a codec.  As for
+ * itext_iterator, each ill-formed code unit sequence counts as one character
+ * and code unit sequences that only encode a state transition are not
+ * counted.  Used as the fallback for codecs and code unit iterators that lack
+ * a dedicated counting routine.
+ */
+template<typename Codec, typename CUIT, typename CUST>
+std::ptrdiff_t code_point_count_by_decode(
+    typename Codec::state_type state,
+    CUIT in_next,
+    CUST in_last)
+{
+    std::ptrdiff_t count = 0;
+    while (in_next != in_last) {
+        typename Codec::character_type c;
+        int decoded_code_units = 0;
+        decode_status ds = Codec::decode(
+            state, in_next, in_last, c, decoded_code_units);
+        if (ds != decode_status::no_character) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+
+/*
+ * Counts the characters produced by iterating a contiguous code unit sequence
+ * of a stateless codec.  count_prefix counts the code points of the longest
+ * well-formed prefix of a sequence and reports its length and the error that
+ * ends it in a decode_n_result.  Ill-formed code unit sequences are decoded
+ * with the decode() member of the codec so that counting resumes where
+ * iteration would resynchronize.
+ */
+template<typename Codec, typename CountPrefix>
+std::ptrdiff_t code_point_count_by_prefix(
+    const typename Codec::code_unit_type *in_first,
+    const typename Codec::code_unit_type *in_last,
+    CountPrefix count_prefix)
+noexcept
+{
+    typename Codec::state_type state{};
+    std::ptrdiff_t count = 0;
+    while (in_first != in_last) {
+        decode_n_result r = count_prefix(in_first, in_last);
+        count += r.code_points;
+        in_first += r.code_units;
+        if (in_first == in_last) {
+            break;
+        }
+        typename Codec::character_type c;
+        int decoded_code_units = 0;
+        Codec::decode(state, in_first, in_last, c, decoded_code_units);
+        ++count;
+    }
+    return count;
+}
+
+
+/*
+ * Counts the characters produced by iterating a contiguous code unit sequence
+ * of a stateful codec, starting in the specified state, with a decode_n()
+ * member that takes the state, as the BOM codecs provide.  Well-formed code
+ * unit sequences are decoded a block at a time; ill-formed ones are decoded
+ * with the decode() member of the codec so that counting resumes where
+ * iteration would resynchronize.
+ */
+template<typename Codec>
+std::ptrdiff_t code_point_count_by_decode_n(
+    typename Codec::state_type state,
+    const typename Codec::code_unit_type *in_first,
+    const typename Codec::code_unit_type *in_last)
+noexcept
+{
+    constexpr int buffer_size = 256;
+    typename Codec::code_point_type buffer[buffer_size];
+    std::ptrdiff_t count = 0;
+    while (in_first != in_last) {
+        decode_n_result r = Codec::decode_n(
+            state, in_first, in_last, buffer, buffer + buffer_size);
+        count += r.code_points;
+        in_first += r.code_units;
+        if (r.status == decode_status::no_error) {
+            continue;
+        }
+        typename Codec::character_type c;
+        int decoded_code_units = 0;
+        Codec::decode(state, in_first, in_last, c, decoded_code_units);
+        ++count;
+    }
+    return count;
+}
+
+
 } // namespace text_detail
 } // inline namespace text
 } // namespace experimental
@@ -0,0 +1,193 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#if !defined(TEXT_VIEW_CODECS_FIXED_WIDTH_CODEC_HPP) // {
+#define TEXT_VIEW_CODECS_FIXED_WIDTH_CODEC_HPP
+
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <text_view_detail/codecs/codec_util.hpp>
+#include <text_view_detail/concepts.hpp>
+#include <text_view_detail/error_status.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+// Restricts a stateless encoding to the characters that it encodes with a
+// single code unit, such as ASCII for UTF-8 or the Basic Multilingual Plane
+// less the surrogate code points for UTF-16.  Characters are encoded and
+// decoded by the underlying encoding; a code unit that does not encode a
+// character by itself is decoded as an ill-formed code unit sequence of one
+// code unit.  Each code unit therefore corresponds to one character, which
+// enables random access to the characters of a code unit sequence.
+template<TextEncoding ET>
+requires std::is_empty<typename ET::state_type>::value
+class fixed_width_codec {
+public:
+    using state_type = typename ET::state_type;
+    using state_transition_type = typename ET::state_transition_type;
+    using character_type = character_type_t<ET>;
+    using code_unit_type = code_unit_type_t<ET>;
+    static constexpr int min_code_units = 1;
+    static constexpr int max_code_units = 1;
+
+    template<CodeUnitOutputIterator<code_unit_type> CUIT>
+    static encode_status encode_state_transition(
+        state_type &state,
+        CUIT &out,
+        const state_transition_type &stt,
+        int &encoded_code_units)
+    noexcept
+    {
+        encoded_code_units = 0;
+
+        return encode_status::no_error;
+    }
+
+    template<CodeUnitOutputIterator<code_unit_type> CUIT>
+    static encode_status encode(
+        state_type &state,
+        CUIT &out,
+        character_type c,
+        int &encoded_code_units)
+    noexcept(text_detail::NoExceptOutputIterator<CUIT, code_unit_type>())
+    {
+        encoded_code_units = 0;
+
+        code_unit_type buffer[ET::max_code_units];
+        code_unit_type *buffer_next = buffer;
+        int buffer_code_units = 0;
+        encode_status es = ET::encode(
+            state, buffer_next, c, buffer_code_units);
+        if (error_occurred(es)) {
+            return es;
+        }
+        if (buffer_next - buffer != 1) {
+            return encode_status::invalid_character;
+        }
+        *out++ = buffer[0];
+        ++encoded_code_units;
+
+        return encode_status::no_error;
+    }
+
+    template<CodeUnitIterator CUIT, typename CUST>
+    requires ranges::ForwardIterator<CUIT>
+          && ranges::ConvertibleTo<ranges::value_type_t<CUIT>, code_unit_type>
+          && ranges::Sentinel<CUST, CUIT>
+    static decode_status decode(
+        state_type &state,
+        CUIT &in_next,
+        CUST in_end,
+        character_type &c,
+        int &decoded_code_units)
+    noexcept(text_detail::NoExceptInputIterator<CUIT, CUST>())
+    {
+        CUIT in_first = in_next;
+        decode_status ds = ET::decode(
+            state, in_next, in_end, c, decoded_code_units);
+        return single_code_unit_status(
+            ds, in_first, in_next, decoded_code_units);
+    }
+
+    template<CodeUnitIterator CUIT, typename CUST>
+    requires ranges::ForwardIterator<CUIT>
+          && ranges::ConvertibleTo<ranges::value_type_t<CUIT>, code_unit_type>
+          && ranges::Sentinel<CUST, CUIT>
+    static decode_status rdecode(
+        state_type &state,
+        CUIT &in_next,
+        CUST in_end,
+        character_type &c,
+        int &decoded_code_units)
+    noexcept(text_detail::NoExceptInputIterator<CUIT, CUST>())
+    {
+        CUIT in_first = in_next;
+        decode_status ds = ET::rdecode(
+            state, in_next, in_end, c, decoded_code_units);
+        return single_code_unit_status(
+            ds, in_first, in_next, decoded_code_units);
+    }
+
+    // Decodes a character from a code unit that is known to encode a
+    // character by itself with the decode_unchecked() member of the
+    // underlying encoding.  Provided only when the underlying encoding
+    // provides decode_unchecked().
+    template<CodeUnitIterator CUIT, typename CUST>
+    requires ranges::ForwardIterator<CUIT>
+          && ranges::ConvertibleTo<ranges::value_type_t<CUIT>, code_unit_type>
+          && ranges::Sentinel<CUST, CUIT>
+          && requires (state_type &state,
+                       CUIT &in_next,
+                       CUST in_end,
+                       character_type &c,
+                       int &decoded_code_units)
+             {
+                 ET::decode_unchecked(
+                     state, in_next, in_end, c, decoded_code_units);
+             }
+    static decode_status decode_unchecked(
+        state_type &state,
+        CUIT &in_next,
+        CUST in_end,
+        character_type &c,
+        int &decoded_code_units)
+    noexcept(text_detail::NoExceptInputIterator<CUIT, CUST>())
+    {
+        return ET::decode_unchecked(
+            state, in_next, in_end, c, decoded_code_units);
+    }
+
+    // Returns the number of characters that iterating the contiguous code
+    // unit sequence [in_first, in_last) produces; one for each code unit.
+    static std::ptrdiff_t code_point_count(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        return in_last - in_first;
+    }
+
+private:
+    // Reports a character decoded from more than one code unit, a code unit
+    // sequence that only encodes a state transition, and an ill-formed code
+    // unit sequence as an ill-formed code unit sequence of one code unit.
+    template<typename CUIT>
+    static decode_status single_code_unit_status(
+        decode_status ds,
+        CUIT in_first,
+        CUIT &in_next,
+        int &decoded_code_units)
+    noexcept(noexcept(++in_first))
+    {
+        if (ds == decode_status::no_error && decoded_code_units == 1) {
+            return ds;
+        }
+        if (ds == decode_status::underflow && in_next == in_first) {
+            return ds;
+        }
+        in_next = ++in_first;
+        decoded_code_units = 1;
+        return error_occurred(ds)
+               ? ds
+               : decode_status::invalid_code_unit_sequence;
+    }
+};
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_CODECS_FIXED_WIDTH_CODEC_HPP
@@ -0,0 +1,199 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#if !defined(TEXT_VIEW_CODECS_LATIN1_CODEC_HPP) // {
+#define TEXT_VIEW_CODECS_LATIN1_CODEC_HPP
+
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <text_view_detail/bulk_result.hpp>
+#include <text_view_detail/codecs/codec_util.hpp>
+#include <text_view_detail/concepts.hpp>
+#include <text_view_detail/error_status.hpp>
+#include <text_view_detail/character.hpp>
+#include <text_view_detail/trivial_encoding_state.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+// ISO/IEC 8859-1 encodes the first 256 code points of Unicode as single code
+// units of the same value.  As for trivial_codec, every code unit decodes to
+// a character; code points above U+00FF cannot be encoded.  Code units are
+// treated as unsigned 8-bit values so that a signed char code unit type
+// decodes to the same code points.
+template<Character CT, CodeUnit CUT>
+class latin1_codec {
+public:
+    using state_type = trivial_encoding_state;
+    using state_transition_type = trivial_encoding_state_transition;
+    using character_type = CT;
+    using code_unit_type = CUT;
+    using code_point_type =
+        code_point_type_t<character_set_type_t<character_type>>;
+    static constexpr int min_code_units = 1;
+    static constexpr int max_code_units = 1;
+
+    static_assert(sizeof(code_unit_type) * CHAR_BIT >= 8);
+
+    template<CodeUnitOutputIterator<code_unit_type> CUIT>
+    static encode_status encode_state_transition(
+        state_type &state,
+        CUIT &out,
+        const state_transition_type &stt,
+        int &encoded_code_units)
+    noexcept
+    {
+        encoded_code_units = 0;
+
+        return encode_status::no_error;
+    }
+
+    template<CodeUnitOutputIterator<code_unit_type> CUIT>
+    static encode_status encode(
+        state_type &state,
+        CUIT &out,
+        character_type c,
+        int &encoded_code_units)
+    noexcept(text_detail::NoExceptOutputIterator<CUIT, code_unit_type>())
+    {
+        encoded_code_units = 0;
+
+        code_point_type cp{c.get_code_point()};
+        if (cp > 0xFF) {
+            return encode_status::invalid_character;
+        }
+        *out++ = code_unit_type(cp);
+        ++encoded_code_units;
+
+        return encode_status::no_error;
+    }
+
+    template<CodeUnitIterator CUIT, typename CUST>
+    requires ranges::ForwardIterator<CUIT>
+          && ranges::ConvertibleTo<ranges::value_type_t<CUIT>, code_unit_type>
+          && ranges::Sentinel<CUST, CUIT>
+    static decode_status decode(
+        state_type &state,
+        CUIT &in_next,
+        CUST in_end,
+        character_type &c,
+        int &decoded_code_units)
+    noexcept(text_detail::NoExceptInputIterator<CUIT, CUST>())
+    {
+        decoded_code_units = 0;
+
+        if (in_next == in_end)
+            return decode_status::underflow;
+        code_unit_type cu = *in_next++;
+        ++decoded_code_units;
+        c.set_code_point(code_point_type(cu & 0xFF));
+        return decode_status::no_error;
+    }
+
+    template<CodeUnitIterator CUIT, typename CUST>
+    requires ranges::ForwardIterator<CUIT>
+          && ranges::ConvertibleTo<ranges::value_type_t<CUIT>, code_unit_type>
+          && ranges::Sentinel<CUST, CUIT>
+    static decode_status rdecode(
+        state_type &state,
+        CUIT &in_next,
+        CUST in_end,
+        character_type &c,
+        int &decoded_code_units)
+    noexcept(text_detail::NoExceptInputIterator<CUIT, CUST>())
+    {
+        decoded_code_units = 0;
+
+        if (in_next == in_end)
+            return decode_status::underflow;
+        code_unit_type rcu = *in_next++;
+        ++decoded_code_units;
+        c.set_code_point(code_point_type(rcu & 0xFF));
+        return decode_status::no_error;
+    }
+
+    // Decodes the contiguous code unit sequence [in_first, in_last) into the
+    // code point buffer [out_first, out_last).  Every code unit is zero
+    // extended; decoding stops only when the input is exhausted or the
+    // output is full.
+    static decode_n_result decode_n(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last,
+        code_point_type *out_first,
+        code_point_type *out_last)
+    noexcept
+    {
+        std::ptrdiff_t n = std::min(in_last - in_first, out_last - out_first);
+        for (std::ptrdiff_t i = 0; i != n; ++i) {
+            out_first[i] = code_point_type(in_first[i] & 0xFF);
+        }
+        return { n, n, decode_status::no_error };
+    }
+
+    // Encodes the contiguous code point sequence [in_first, in_last) into the
+    // code unit buffer [out_first, out_last).  Encoding stops when the input
+    // is exhausted, the output is full, or a code point above U+00FF is
+    // encountered.
+    static encode_n_result encode_n(
+        const code_point_type *in_first,
+        const code_point_type *in_last,
+        code_unit_type *out_first,
+        code_unit_type *out_last)
+    noexcept
+    {
+        std::ptrdiff_t n = std::min(in_last - in_first, out_last - out_first);
+        for (std::ptrdiff_t i = 0; i != n; ++i) {
+            if (in_first[i] > 0xFF) {
+                return { i, i, encode_status::invalid_character };
+            }
+            out_first[i] = code_unit_type(in_first[i]);
+        }
+        return { n, n, encode_status::no_error };
+    }
+
+    // Returns the number of code units required to encode the contiguous code
+    // point sequence [in_first, in_last), stopping at the first code point
+    // above U+00FF.
+    static encode_n_result encoded_length(
+        const code_point_type *in_first,
+        const code_point_type *in_last)
+    noexcept
+    {
+        const code_point_type *in_next = in_first;
+        while (in_next != in_last && *in_next <= 0xFF) {
+            ++in_next;
+        }
+        return { in_next - in_first,
+                 in_next - in_first,
+                 in_next == in_last ? encode_status::no_error
+                                    : encode_status::invalid_character };
+    }
+
+    // Returns the number of characters that iterating the contiguous code
+    // unit sequence [in_first, in_last) produces; one for each code unit.
+    static std::ptrdiff_t code_point_count(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        return in_last - in_first;
+    }
+};
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_CODECS_LATIN1_CODEC_HPP
@@ -0,0 +1,93 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#if !defined(TEXT_VIEW_CODECS_TRANSCODE_KERNELS_HPP) // {
+#define TEXT_VIEW_CODECS_TRANSCODE_KERNELS_HPP
+
+
+#include <text_view_detail/bulk_result.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+// Transcoding operations between Unicode encoding forms on contiguous code
+// unit sequences.  These are implemented out of line so that vectorized
+// implementations can be selected at run-time according to the features of
+// the processor.  Transcoding stops when the input is exhausted, when the
+// output has insufficient space for the code units of the next character, or
+// when an ill-formed code unit sequence is encountered.  Ill-formed code unit
+// sequences are diagnosed according to the rules implemented by utf8_codec
+// and utf16_codec.
+
+// Transcodes UTF-8 [in_first, in_last) to UTF-16 [out_first, out_last).
+transcode_result utf8_to_utf16(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char16_t *out_first,
+    char16_t *out_last) noexcept;
+
+// Transcodes UTF-16 [in_first, in_last) to UTF-8 [out_first, out_last).
+transcode_result utf16_to_utf8(
+    const char16_t *in_first,
+    const char16_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept;
+
+
+// Measures the number of UTF-16 code units required to transcode the UTF-8
+// code unit sequence [in_first, in_last).  The result is that which
+// utf8_to_utf16() would report for an output buffer of unlimited size.
+transcode_result utf8_to_utf16_length(
+    const unsigned char *in_first,
+    const unsigned char *in_last) noexcept;
+
+// Measures the number of UTF-8 code units required to transcode the UTF-16
+// code unit sequence [in_first, in_last).  The result is that which
+// utf16_to_utf8() would report for an output buffer of unlimited size.
+transcode_result utf16_to_utf8_length(
+    const char16_t *in_first,
+    const char16_t *in_last) noexcept;
+
+
+// Transcoding operations between ISO/IEC 8859-1 (Latin-1) and UTF-8.  Every
+// Latin-1 code unit is a valid character; code points above U+00FF in the
+// UTF-8 input are reported as characters that cannot be encoded.
+
+// Transcodes Latin-1 [in_first, in_last) to UTF-8 [out_first, out_last).
+transcode_result latin1_to_utf8(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept;
+
+// Transcodes UTF-8 [in_first, in_last) to Latin-1 [out_first, out_last).
+transcode_result utf8_to_latin1(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept;
+
+// Measures the number of code units that latin1_to_utf8() and
+// utf8_to_latin1() respectively would write to an output buffer of
+// unlimited size.
+transcode_result latin1_to_utf8_length(
+    const unsigned char *in_first,
+    const unsigned char *in_last) noexcept;
+transcode_result utf8_to_latin1_length(
+    const unsigned char *in_first,
+    const unsigned char *in_last) noexcept;
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_CODECS_TRANSCODE_KERNELS_HPP
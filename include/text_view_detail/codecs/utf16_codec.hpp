@@ -9,7 +9,10 @@
 
 
 #include <climits>
+#include <cstddef>
+#include <iterator>
 #include <text_view_detail/codecs/codec_util.hpp>
+#include <text_view_detail/codecs/utf16_kernels.hpp>
 #include <text_view_detail/concepts.hpp>
 #include <text_view_detail/error_status.hpp>
 #include <text_view_detail/character.hpp>
@@ -29,6 +32,8 @@ public:
     using state_transition_type = trivial_encoding_state_transition;
     using character_type = CT;
     using code_unit_type = CUT;
+    using code_point_type =
+        code_point_type_t<character_set_type_t<character_type>>;
     static constexpr int min_code_units = 1;
     static constexpr int max_code_units = 2;
 
@@ -129,6 +134,39 @@ public:
         return decode_status::no_error;
     }
 
+    // Decodes a character from a code unit sequence that is known to be
+    // well-formed.  A code unit in the range [0xD800, 0xE000) is presumed to
+    // be a leading surrogate that is followed by a trailing surrogate;
+    // decoding an ill-formed code unit sequence has undefined behavior.
+    // Used by itext_iterator when text_assume_valid_error_policy is in
+    // effect.
+    template<CodeUnitIterator CUIT, typename CUST>
+    requires ranges::ForwardIterator<CUIT>
+          && ranges::ConvertibleTo<ranges::value_type_t<CUIT>, code_unit_type>
+          && ranges::Sentinel<CUST, CUIT>
+    static decode_status decode_unchecked(
+        state_type &state,
+        CUIT &in_next,
+        CUST in_end,
+        character_type &c,
+        int &decoded_code_units)
+    noexcept(text_detail::NoExceptInputIterator<CUIT, CUST>())
+    {
+        decoded_code_units = 0;
+
+        if (in_next == in_end)
+            return decode_status::underflow;
+        code_point_type cp = code_point_type(*in_next++);
+        ++decoded_code_units;
+        if (cp >= 0xD800 && cp < 0xE000) {
+            code_point_type cu2 = code_point_type(*in_next++);
+            ++decoded_code_units;
+            cp = 0x10000 + (((cp & 0x3FF) << 10) | (cu2 & 0x3FF));
+        }
+        c.set_code_point(cp);
+        return decode_status::no_error;
+    }
+
     template<CodeUnitIterator CUIT, typename CUST>
     requires ranges::ForwardIterator<CUIT>
           && ranges::ConvertibleTo<ranges::value_type_t<CUIT>, code_unit_type>
@@ -176,6 +214,215 @@ public:
         return decode_status::no_error;
     }
 
+    // Decodes the character that precedes in_next in the contiguous code unit
+    // sequence [in_first, in_next) and moves in_next to its first code unit.
+    // Single code unit sequences and surrogate pairs are decoded directly;
+    // ill-formed code unit sequences are handled by rdecode() so that results
+    // are identical to those of rdecode().
+    static decode_status decode_prev(
+        state_type &state,
+        const code_unit_type *in_first,
+        const code_unit_type *&in_next,
+        character_type &c,
+        int &decoded_code_units)
+    noexcept
+    {
+        decoded_code_units = 0;
+
+        using code_point_type =
+            code_point_type_t<character_set_type_t<character_type>>;
+
+        if (in_next == in_first)
+            return decode_status::underflow;
+        code_unit_type rcu1 = in_next[-1];
+        if (rcu1 < 0xD800 || (rcu1 >= 0xE000 && rcu1 <= 0xFFFF)) {
+            c.set_code_point(code_point_type(rcu1));
+            --in_next;
+            ++decoded_code_units;
+            return decode_status::no_error;
+        }
+        if (rcu1 >= 0xDC00 && rcu1 < 0xE000 && in_next - in_first >= 2) {
+            code_unit_type rcu2 = in_next[-2];
+            if (rcu2 >= 0xD800 && rcu2 < 0xDC00) {
+                c.set_code_point(code_point_type(
+                    0x10000 + (((rcu2 & 0x3FF) << 10) | (rcu1 & 0x3FF))));
+                in_next -= 2;
+                decoded_code_units = 2;
+                return decode_status::no_error;
+            }
+        }
+
+        std::reverse_iterator<const code_unit_type*> rnext{in_next};
+        std::reverse_iterator<const code_unit_type*> rend{in_first};
+        decode_status ds = rdecode(state, rnext, rend, c, decoded_code_units);
+        in_next = rnext.base();
+        return ds;
+    }
+
+    // Decodes the contiguous code unit sequence [in_first, in_last) into the
+    // code point buffer [out_first, out_last).  Decoding stops when the input
+    // is exhausted, the output is full, or an error is encountered; errors
+    // are reported exactly as decode() would report them, but the ill-formed
+    // code unit sequence is not skipped.  16-bit code units are decoded by
+    // vectorized implementations when supported by the processor; these
+    // widen blocks of code units that contain no surrogate code units and
+    // pair surrogates one at a time.
+    static decode_n_result decode_n(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last,
+        code_point_type *out_first,
+        code_point_type *out_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 2 && sizeof(code_point_type) == 4) {
+            return utf16_decode_n(
+                reinterpret_cast<const char16_t*>(in_first),
+                reinterpret_cast<const char16_t*>(in_last),
+                reinterpret_cast<char32_t*>(out_first),
+                reinterpret_cast<char32_t*>(out_last));
+        }
+
+        const code_unit_type *in_next = in_first;
+        code_point_type *out_next = out_first;
+        decode_status ds = decode_status::no_error;
+
+        while (in_next != in_last && out_next != out_last) {
+            code_unit_type cu1 = *in_next;
+            if (is_invalid_leading_code_unit(cu1)) {
+                ds = decode_status::invalid_code_unit_sequence;
+                break;
+            }
+            if (cu1 < 0xD800 || cu1 >= 0xE000) {
+                *out_next++ = cu1;
+                ++in_next;
+                continue;
+            }
+
+            if (in_last - in_next < 2) {
+                ds = decode_status::underflow;
+                break;
+            }
+            code_unit_type cu2 = in_next[1];
+            if (is_invalid_second_code_unit(cu2)) {
+                ds = decode_status::invalid_code_unit_sequence;
+                break;
+            }
+            *out_next++ = 0x10000 + (((cu1 & 0x3FF) << 10) | (cu2 & 0x3FF));
+            in_next += 2;
+        }
+
+        return { in_next - in_first, out_next - out_first, ds };
+    }
+
+    // Returns the end of the longest prefix of [in_first, in_last) that
+    // consists of single code unit sequences; that is, code units that are
+    // not surrogate code points.  16-bit code units are scanned for surrogate
+    // code units by vectorized implementations when supported by the
+    // processor.
+    static const code_unit_type* single_code_unit_run_end(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 2) {
+            return reinterpret_cast<const code_unit_type*>(
+                utf16_find_surrogate(
+                    reinterpret_cast<const char16_t*>(in_first),
+                    reinterpret_cast<const char16_t*>(in_last)));
+        }
+        while (in_first != in_last &&
+               (*in_first < 0xD800 ||
+                (*in_first >= 0xE000 && *in_first <= 0xFFFF)))
+        {
+            ++in_first;
+        }
+        return in_first;
+    }
+
+    // Validates the contiguous code unit sequence [in_first, in_last) without
+    // decoding it.  The same rules that decode() applies are enforced; the
+    // offset of the first ill-formed code unit sequence, such as an unpaired
+    // surrogate code unit, is reported.  16-bit code units are validated by
+    // vectorized implementations when supported by the processor.
+    static validate_result validate(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 2) {
+            return utf16_validate(
+                reinterpret_cast<const char16_t*>(in_first),
+                reinterpret_cast<const char16_t*>(in_last));
+        }
+        return validate_by_decode_n<utf16_codec>(in_first, in_last);
+    }
+
+    // Encodes the contiguous code point sequence [in_first, in_last) into the
+    // code unit buffer [out_first, out_last).  Encoding stops when the input
+    // is exhausted, the output lacks space for the code units of the next
+    // code point, or a code point that encode() rejects is encountered; no
+    // code units are written for that code point.  16-bit code units are
+    // encoded by vectorized implementations when supported by the processor;
+    // these narrow blocks of code points that are in the BMP and encode
+    // surrogate pairs one at a time.
+    static encode_n_result encode_n(
+        const code_point_type *in_first,
+        const code_point_type *in_last,
+        code_unit_type *out_first,
+        code_unit_type *out_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 2 && sizeof(code_point_type) == 4) {
+            return utf16_encode_n(
+                reinterpret_cast<const char32_t*>(in_first),
+                reinterpret_cast<const char32_t*>(in_last),
+                reinterpret_cast<char16_t*>(out_first),
+                reinterpret_cast<char16_t*>(out_last));
+        }
+        return encode_n_by_encode<utf16_codec>(
+            in_first, in_last, out_first, out_last);
+    }
+
+    // Returns the number of code units required to encode the contiguous code
+    // point sequence [in_first, in_last), stopping at the first code point
+    // that encode() rejects.
+    static encode_n_result encoded_length(
+        const code_point_type *in_first,
+        const code_point_type *in_last)
+    noexcept
+    {
+        if (sizeof(code_point_type) == 4) {
+            return utf16_encoded_length_strict(
+                reinterpret_cast<const char32_t*>(in_first),
+                reinterpret_cast<const char32_t*>(in_last));
+        }
+        return encoded_length_by_encode<utf16_codec>(in_first, in_last);
+    }
+
+    // Returns the number of characters that iterating the contiguous code
+    // unit sequence [in_first, in_last) produces, counting each ill-formed
+    // code unit sequence as one character.  Well-formed code unit sequences
+    // are counted without being decoded; 16-bit code units are validated and
+    // counted by vectorized implementations when supported by the processor.
+    static std::ptrdiff_t code_point_count(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 2) {
+            return code_point_count_by_prefix<utf16_codec>(
+                in_first,
+                in_last,
+                [](const code_unit_type *first, const code_unit_type *last) {
+                    return utf16_count_code_points(
+                        reinterpret_cast<const char16_t*>(first),
+                        reinterpret_cast<const char16_t*>(last));
+                });
+        }
+        return code_point_count_by_decode<utf16_codec>(
+            state_type{}, in_first, in_last);
+    }
+
 private:
     static bool is_invalid_leading_code_unit(
         code_unit_type cu)
@@ -0,0 +1,133 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#if !defined(TEXT_VIEW_CODECS_UTF16_KERNELS_HPP) // {
+#define TEXT_VIEW_CODECS_UTF16_KERNELS_HPP
+
+
+#include <text_view_detail/bulk_result.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+// Bulk UTF-16 operations on contiguous 16-bit code unit sequences.  These are
+// implemented out of line so that vectorized implementations can be selected
+// at run-time according to the features of the processor.
+
+// Returns the first surrogate code unit in [first, last), or last if there is
+// none.
+const char16_t* utf16_find_surrogate(
+    const char16_t *first,
+    const char16_t *last) noexcept;
+
+// Validates [first, last) according to the rules implemented by utf16_codec.
+validate_result utf16_validate(
+    const char16_t *first,
+    const char16_t *last) noexcept;
+
+// Decodes [in_first, in_last) into the code point buffer [out_first,
+// out_last) according to the rules implemented by utf16_codec::decode_n().
+decode_n_result utf16_decode_n(
+    const char16_t *in_first,
+    const char16_t *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept;
+
+// Encodes the code points [in_first, in_last) to the buffer [out_first,
+// out_last) according to the rules implemented by utf16_codec::encode().
+encode_n_result utf16_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    char16_t *out_first,
+    char16_t *out_last) noexcept;
+
+// Counts the code points of the longest well-formed prefix of the UTF-16 code
+// unit sequence [first, last).  code_units is the length of the prefix and
+// status is the error, if any, that ends it.
+decode_n_result utf16_count_code_points(
+    const char16_t *first,
+    const char16_t *last) noexcept;
+
+
+// Bulk operations on UTF-16BE and UTF-16LE code unit sequences, which are
+// sequences of bytes that are not necessarily aligned for 16-bit access.
+// Code units are loaded a vector at a time and their bytes reversed when the
+// byte order differs from that of the host.  Offsets and lengths are in
+// bytes.
+
+// Validates [first, last) according to the rules implemented by
+// utf16be_codec and utf16le_codec respectively.
+validate_result utf16be_validate(
+    const unsigned char *first,
+    const unsigned char *last) noexcept;
+validate_result utf16le_validate(
+    const unsigned char *first,
+    const unsigned char *last) noexcept;
+
+// Decodes [in_first, in_last) into the code point buffer [out_first,
+// out_last) according to the rules implemented by the decode_n() member of
+// utf16be_codec and utf16le_codec respectively.
+decode_n_result utf16be_decode_n(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept;
+decode_n_result utf16le_decode_n(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept;
+
+// Encodes the code points [in_first, in_last) to the buffer [out_first,
+// out_last) according to the rules implemented by the encode() member of
+// utf16be_codec and utf16le_codec respectively.
+encode_n_result utf16be_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept;
+encode_n_result utf16le_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept;
+
+// Encodes as utf16be_encode_n() and utf16le_encode_n() do, but rejects code
+// points above U+10FFFF as utf16_codec::encode() does.
+encode_n_result utf16be_encode_n_strict(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept;
+encode_n_result utf16le_encode_n_strict(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept;
+
+// Returns the number of 16-bit code units required to encode the code points
+// [first, last) as UTF-16 in any byte order.  utf16_encoded_length() accepts
+// the code points that the big-endian and little-endian codecs encode;
+// utf16_encoded_length_strict() also rejects code points above U+10FFFF.
+encode_n_result utf16_encoded_length(
+    const char32_t *first,
+    const char32_t *last) noexcept;
+encode_n_result utf16_encoded_length_strict(
+    const char32_t *first,
+    const char32_t *last) noexcept;
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_CODECS_UTF16_KERNELS_HPP
@@ -11,6 +11,7 @@
 #include <climits>
 #include <cstdint>
 #include <text_view_detail/codecs/codec_util.hpp>
+#include <text_view_detail/codecs/utf16_kernels.hpp>
 #include <text_view_detail/concepts.hpp>
 #include <text_view_detail/error_status.hpp>
 #include <text_view_detail/character.hpp>
@@ -30,6 +31,8 @@ public:
     using state_transition_type = trivial_encoding_state_transition;
     using character_type = CT;
     using code_unit_type = CUT;
+    using code_point_type =
+        code_point_type_t<character_set_type_t<character_type>>;
     static constexpr int min_code_units = 2;
     static constexpr int max_code_units = 4;
 
@@ -199,6 +202,92 @@ public:
 
         return decode_status::no_error;
     }
+
+    // Decodes the contiguous code unit sequence [in_first, in_last) into the
+    // code point buffer [out_first, out_last).  Decoding stops when the input
+    // is exhausted, the output is full, or an error is encountered; errors
+    // are reported exactly as decode() would report them, but the ill-formed
+    // code unit sequence is not skipped.  8-bit code units are decoded by
+    // vectorized implementations when supported by the processor; these load
+    // blocks of 16-bit code units, reverse their bytes when the host is
+    // big-endian, and locate surrogate code units in the same pass.
+    static decode_n_result decode_n(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last,
+        code_point_type *out_first,
+        code_point_type *out_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 1 && sizeof(code_point_type) == 4) {
+            return utf16le_decode_n(
+                reinterpret_cast<const unsigned char*>(in_first),
+                reinterpret_cast<const unsigned char*>(in_last),
+                reinterpret_cast<char32_t*>(out_first),
+                reinterpret_cast<char32_t*>(out_last));
+        }
+        return decode_n_by_decode<utf16le_codec>(
+            in_first, in_last, out_first, out_last);
+    }
+
+    // Validates the contiguous code unit sequence [in_first, in_last) without
+    // decoding it.  The same rules that decode() applies are enforced; the
+    // offset of the first ill-formed code unit sequence, if any, is reported.
+    // 8-bit code units are validated by vectorized implementations when
+    // supported by the processor.
+    static validate_result validate(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 1) {
+            return utf16le_validate(
+                reinterpret_cast<const unsigned char*>(in_first),
+                reinterpret_cast<const unsigned char*>(in_last));
+        }
+        return validate_by_decode_n<utf16le_codec>(in_first, in_last);
+    }
+
+    // Encodes the contiguous code point sequence [in_first, in_last) into the
+    // code unit buffer [out_first, out_last).  Encoding stops when the input
+    // is exhausted, the output lacks space for the code units of the next
+    // code point, or a code point that encode() rejects is encountered; no
+    // code units are written for that code point.  8-bit code units are
+    // encoded by vectorized implementations when supported by the processor.
+    static encode_n_result encode_n(
+        const code_point_type *in_first,
+        const code_point_type *in_last,
+        code_unit_type *out_first,
+        code_unit_type *out_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 1 && sizeof(code_point_type) == 4) {
+            return utf16le_encode_n(
+                reinterpret_cast<const char32_t*>(in_first),
+                reinterpret_cast<const char32_t*>(in_last),
+                reinterpret_cast<unsigned char*>(out_first),
+                reinterpret_cast<unsigned char*>(out_last));
+        }
+        return encode_n_by_encode<utf16le_codec>(
+            in_first, in_last, out_first, out_last);
+    }
+
+    // Returns the number of code units required to encode the contiguous code
+    // point sequence [in_first, in_last), stopping at the first code point
+    // that encode() rejects.
+    static encode_n_result encoded_length(
+        const code_point_type *in_first,
+        const code_point_type *in_last)
+    noexcept
+    {
+        if (sizeof(code_point_type) == 4) {
+            encode_n_result r = utf16_encoded_length(
+                reinterpret_cast<const char32_t*>(in_first),
+                reinterpret_cast<const char32_t*>(in_last));
+            r.code_units *= 2;
+            return r;
+        }
+        return encoded_length_by_encode<utf16le_codec>(in_first, in_last);
+    }
 };
 
 
@@ -9,6 +9,7 @@
 
 
 #include <climits>
+#include <cstddef>
 #include <text_view_detail/codecs/codec_util.hpp>
 #include <text_view_detail/concepts.hpp>
 #include <text_view_detail/error_status.hpp>
@@ -143,6 +144,28 @@ public:
         return decode_status::no_error;
     }
 
+    // Returns the number of characters that iterating the contiguous code
+    // unit sequence [in_first, in_last) produces, counting each ill-formed
+    // code unit sequence as one character.  Every valid code unit encodes one
+    // character, so the count is the number of code units less those that
+    // decode() consumes as part of a preceding run of invalid code units.
+    static std::ptrdiff_t code_point_count(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        std::ptrdiff_t count = in_last - in_first;
+        bool prev_invalid = false;
+        for (; in_first != in_last; ++in_first) {
+            code_unit_type cu = *in_first;
+            bool invalid = (cu >= 0x0000D800 && cu <= 0x0000DFFF) ||
+                           cu > 0x0010FFFF;
+            count -= invalid && prev_invalid;
+            prev_invalid = invalid;
+        }
+        return count;
+    }
+
 private:
     template<CodeUnitIterator CUIT, ranges::Sentinel<CUIT> CUST>
     static void skip_to_valid_code_unit(
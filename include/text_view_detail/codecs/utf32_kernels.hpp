@@ -0,0 +1,63 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#if !defined(TEXT_VIEW_CODECS_UTF32_KERNELS_HPP) // {
+#define TEXT_VIEW_CODECS_UTF32_KERNELS_HPP
+
+
+#include <text_view_detail/bulk_result.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+// Bulk operations on UTF-32BE and UTF-32LE code unit sequences, which are
+// sequences of bytes that are not necessarily aligned for 32-bit access.
+// Code units are copied a vector at a time and their bytes reversed when the
+// byte order differs from that of the host.  Offsets and lengths are in
+// bytes.  These are implemented out of line so that vectorized
+// implementations can be selected at run-time according to the features of
+// the processor.
+
+// Decodes [in_first, in_last) into the code point buffer [out_first,
+// out_last) according to the rules implemented by the decode_n() member of
+// utf32be_codec and utf32le_codec respectively.
+decode_n_result utf32be_decode_n(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept;
+decode_n_result utf32le_decode_n(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept;
+
+// Encodes the code points [in_first, in_last) to the buffer [out_first,
+// out_last) according to the rules implemented by the encode() member of
+// utf32be_codec and utf32le_codec respectively.
+encode_n_result utf32be_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept;
+encode_n_result utf32le_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept;
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_CODECS_UTF32_KERNELS_HPP
@@ -11,6 +11,7 @@
 #include <climits>
 #include <cstdint>
 #include <text_view_detail/codecs/codec_util.hpp>
+#include <text_view_detail/codecs/utf32_kernels.hpp>
 #include <text_view_detail/concepts.hpp>
 #include <text_view_detail/error_status.hpp>
 #include <text_view_detail/character.hpp>
@@ -30,6 +31,8 @@ public:
     using state_transition_type = trivial_encoding_state_transition;
     using character_type = CT;
     using code_unit_type = CUT;
+    using code_point_type =
+        code_point_type_t<character_set_type_t<character_type>>;
     static constexpr int min_code_units = 4;
     static constexpr int max_code_units = 4;
 
@@ -166,6 +169,81 @@ public:
 
         return decode_status::no_error;
     }
+
+    // Decodes the contiguous code unit sequence [in_first, in_last) into the
+    // code point buffer [out_first, out_last).  Decoding stops when the input
+    // is exhausted, the output is full, or an error is encountered; errors
+    // are reported exactly as decode() would report them.  Every complete
+    // code unit is well-formed, so decoding only copies code units; 8-bit
+    // code units are copied by vectorized implementations that reverse their
+    // bytes when the host is little-endian.
+    static decode_n_result decode_n(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last,
+        code_point_type *out_first,
+        code_point_type *out_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 1 && sizeof(code_point_type) == 4) {
+            return utf32be_decode_n(
+                reinterpret_cast<const unsigned char*>(in_first),
+                reinterpret_cast<const unsigned char*>(in_last),
+                reinterpret_cast<char32_t*>(out_first),
+                reinterpret_cast<char32_t*>(out_last));
+        }
+        return decode_n_by_decode<utf32be_codec>(
+            in_first, in_last, out_first, out_last);
+    }
+
+    // Validates the contiguous code unit sequence [in_first, in_last) without
+    // decoding it.  decode() accepts any four code units, so only a trailing
+    // incomplete code unit is reported.
+    static validate_result validate(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        std::ptrdiff_t length = in_last - in_first;
+        std::ptrdiff_t complete = length - length % 4;
+        return { complete,
+                 complete == length ? decode_status::no_error
+                                    : decode_status::underflow };
+    }
+
+    // Encodes the contiguous code point sequence [in_first, in_last) into the
+    // code unit buffer [out_first, out_last).  Encoding stops when the input
+    // is exhausted or the output lacks space for the code units of the next
+    // code point.  8-bit code units are encoded by vectorized implementations
+    // when supported by the processor.
+    static encode_n_result encode_n(
+        const code_point_type *in_first,
+        const code_point_type *in_last,
+        code_unit_type *out_first,
+        code_unit_type *out_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 1 && sizeof(code_point_type) == 4) {
+            return utf32be_encode_n(
+                reinterpret_cast<const char32_t*>(in_first),
+                reinterpret_cast<const char32_t*>(in_last),
+                reinterpret_cast<unsigned char*>(out_first),
+                reinterpret_cast<unsigned char*>(out_last));
+        }
+        return encode_n_by_encode<utf32be_codec>(
+            in_first, in_last, out_first, out_last);
+    }
+
+    // Returns the number of code units required to encode the contiguous code
+    // point sequence [in_first, in_last).
+    static encode_n_result encoded_length(
+        const code_point_type *in_first,
+        const code_point_type *in_last)
+    noexcept
+    {
+        return { in_last - in_first,
+                 4 * (in_last - in_first),
+                 encode_status::no_error };
+    }
 };
 
 
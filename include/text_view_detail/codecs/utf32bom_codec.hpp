@@ -126,6 +126,8 @@ public:
     using character_type = CT;
     using code_unit_type = CUT;
     using unsigned_code_unit_type = std::make_unsigned_t<code_unit_type>;
+    using code_point_type =
+        code_point_type_t<character_set_type_t<character_type>>;
     static constexpr int min_code_units = 4;
     static constexpr int max_code_units = 4;
 
@@ -269,25 +271,16 @@ public:
     {
         decoded_code_units = 0;
 
-        decode_status return_value;
-        if (state.endian == state_type::big_endian) {
-            using utf32_codec = utf32be_codec<CT, CUT>;
-            using utf32_state_type = typename utf32_codec::state_type;
-            static_assert(std::is_empty<utf32_state_type>::value);
-
-            utf32_state_type discarded_utf32_state;
-            return_value = utf32_codec::decode(
-                discarded_utf32_state, in_next, in_end, c, decoded_code_units);
-        } else {
-            using utf32_codec = utf32le_codec<CT, CUT>;
-            using utf32_state_type = typename utf32_codec::state_type;
-            static_assert(std::is_empty<utf32_state_type>::value);
-
-            utf32_state_type discarded_utf32_state;
-            return_value = utf32_codec::decode(
-                discarded_utf32_state, in_next, in_end, c, decoded_code_units);
+        if (state.bom_read_or_written) {
+            // The byte order has been resolved; only the first character of
+            // the input requires the BOM checks below.
+            return decode_with_byte_order(
+                state, in_next, in_end, c, decoded_code_units);
         }
 
+        decode_status return_value = decode_with_byte_order(
+            state, in_next, in_end, c, decoded_code_units);
+
         if (return_value != decode_status::no_error) {
             return return_value;
         }
@@ -364,6 +357,92 @@ public:
 
         return return_value;
     }
+
+    // Decodes the contiguous code unit sequence [in_first, in_last) into the
+    // code point buffer [out_first, out_last), starting in the specified
+    // state.  The BOM, if not yet read, is resolved once with decode(); the
+    // remaining code units are decoded in a single call to the decode_n()
+    // member of the utf32be_codec or utf32le_codec class template for the
+    // resolved byte order.  Results are otherwise as for those members; a
+    // BOM that is read is included in code_units and updates the state.
+    static decode_n_result decode_n(
+        state_type &state,
+        const code_unit_type *in_first,
+        const code_unit_type *in_last,
+        code_point_type *out_first,
+        code_point_type *out_last)
+    noexcept
+    {
+        if (out_first == out_last) {
+            return { 0, 0, decode_status::no_error };
+        }
+        const code_unit_type *in_next = in_first;
+        decode_status ds =
+            resolve_bom<utf32bom_codec>(state, in_next, in_last);
+        if (ds != decode_status::no_error) {
+            return { 0, 0, ds };
+        }
+        decode_n_result r = state.endian == state_type::big_endian
+            ? utf32be_codec<CT, CUT>::decode_n(
+                  in_next, in_last, out_first, out_last)
+            : utf32le_codec<CT, CUT>::decode_n(
+                  in_next, in_last, out_first, out_last);
+        r.code_units += in_next - in_first;
+        return r;
+    }
+
+    // Validates the contiguous code unit sequence [in_first, in_last) as it
+    // would be decoded starting in the specified state.  The BOM is resolved
+    // as for decode_n(), after which the validate() member of the codec for
+    // the resolved byte order is called.
+    static validate_result validate(
+        state_type state,
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        const code_unit_type *in_next = in_first;
+        decode_status ds =
+            resolve_bom<utf32bom_codec>(state, in_next, in_last);
+        if (ds != decode_status::no_error) {
+            return { 0, ds };
+        }
+        validate_result r = state.endian == state_type::big_endian
+            ? utf32be_codec<CT, CUT>::validate(in_next, in_last)
+            : utf32le_codec<CT, CUT>::validate(in_next, in_last);
+        r.code_units += in_next - in_first;
+        return r;
+    }
+
+private:
+    // Decodes a character with the codec for the byte order of the state.
+    template<CodeUnitIterator CUIT, typename CUST>
+    static decode_status decode_with_byte_order(
+        const state_type &state,
+        CUIT &in_next,
+        CUST in_end,
+        character_type &c,
+        int &decoded_code_units)
+    noexcept(text_detail::NoExceptInputIterator<CUIT, CUST>())
+    {
+        if (state.endian == state_type::big_endian) {
+            using utf32_codec = utf32be_codec<CT, CUT>;
+            using utf32_state_type = typename utf32_codec::state_type;
+            static_assert(std::is_empty<utf32_state_type>::value);
+
+            utf32_state_type discarded_utf32_state;
+            return utf32_codec::decode(
+                discarded_utf32_state, in_next, in_end, c, decoded_code_units);
+        } else {
+            using utf32_codec = utf32le_codec<CT, CUT>;
+            using utf32_state_type = typename utf32_codec::state_type;
+            static_assert(std::is_empty<utf32_state_type>::value);
+
+            utf32_state_type discarded_utf32_state;
+            return utf32_codec::decode(
+                discarded_utf32_state, in_next, in_end, c, decoded_code_units);
+        }
+    }
 };
 
 } // namespace text_detail
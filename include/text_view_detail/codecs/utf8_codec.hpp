@@ -9,7 +9,13 @@
 
 
 #include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <text_view_detail/bulk_result.hpp>
 #include <text_view_detail/codecs/codec_util.hpp>
+#include <text_view_detail/codecs/utf8_kernels.hpp>
 #include <text_view_detail/concepts.hpp>
 #include <text_view_detail/character.hpp>
 #include <text_view_detail/error_status.hpp>
@@ -30,6 +36,8 @@ public:
     using character_type = CT;
     using code_unit_type = CUT;
     using unsigned_code_unit_type = std::make_unsigned_t<code_unit_type>;
+    using code_point_type =
+        code_point_type_t<character_set_type_t<character_type>>;
     static constexpr int min_code_units = 1;
     static constexpr int max_code_units = 4;
 
@@ -191,6 +199,56 @@ public:
         return decode_status::invalid_code_unit_sequence;
     }
 
+    // Decodes a character from a code unit sequence that is known to be
+    // well-formed.  The length of the sequence is determined by the leading
+    // code unit alone and no code unit is examined for validity; decoding an
+    // ill-formed or truncated code unit sequence has undefined behavior.
+    // Used by itext_iterator when text_assume_valid_error_policy is in
+    // effect.
+    template<CodeUnitIterator CUIT, typename CUST>
+    requires ranges::ForwardIterator<CUIT>
+          && ranges::ConvertibleTo<
+                 ranges::value_type_t<CUIT>,
+                 unsigned_code_unit_type>
+          && ranges::Sentinel<CUST, CUIT>
+    static decode_status decode_unchecked(
+        state_type &state,
+        CUIT &in_next,
+        CUST in_end,
+        character_type &c,
+        int &decoded_code_units)
+    noexcept(text_detail::NoExceptInputIterator<CUIT, CUST>())
+    {
+        decoded_code_units = 0;
+
+        if (in_next == in_end)
+            return decode_status::underflow;
+        unsigned_code_unit_type cu1 = *in_next++;
+        ++decoded_code_units;
+        code_point_type cp;
+        int trailing_code_units;
+        if (cu1 <= 0x7F) {
+            c.set_code_point(code_point_type(cu1));
+            return decode_status::no_error;
+        } else if (cu1 <= 0xDF) {
+            cp = cu1 & 0x1F;
+            trailing_code_units = 1;
+        } else if (cu1 <= 0xEF) {
+            cp = cu1 & 0x0F;
+            trailing_code_units = 2;
+        } else {
+            cp = cu1 & 0x07;
+            trailing_code_units = 3;
+        }
+        for (; trailing_code_units != 0; --trailing_code_units) {
+            unsigned_code_unit_type cu = *in_next++;
+            ++decoded_code_units;
+            cp = (cp << 6) + (cu & 0x3F);
+        }
+        c.set_code_point(cp);
+        return decode_status::no_error;
+    }
+
     template<CodeUnitIterator CUIT, typename CUST>
     requires ranges::ForwardIterator<CUIT>
           && ranges::ConvertibleTo<
@@ -283,6 +341,273 @@ public:
         return decode_status::no_error;
     }
 
+    // Decodes the character that precedes in_next in the contiguous code unit
+    // sequence [in_first, in_next) and moves in_next to its first code unit.
+    // The leading code unit is located by skipping over trailing code units
+    // and the character is then decoded forward; ill-formed code unit
+    // sequences are handled by rdecode() so that results are identical to
+    // those of rdecode().
+    static decode_status decode_prev(
+        state_type &state,
+        const code_unit_type *in_first,
+        const code_unit_type *&in_next,
+        character_type &c,
+        int &decoded_code_units)
+    noexcept
+    {
+        decoded_code_units = 0;
+
+        if (in_next == in_first)
+            return decode_status::underflow;
+        unsigned_code_unit_type rcu1 = in_next[-1];
+        if (rcu1 <= 0x7F) {
+            using code_point_type =
+                code_point_type_t<character_set_type_t<character_type>>;
+            c.set_code_point(code_point_type(rcu1));
+            --in_next;
+            ++decoded_code_units;
+            return decode_status::no_error;
+        }
+
+        const code_unit_type *lead = in_next - 1;
+        const code_unit_type *scan_end =
+            in_next - in_first > max_code_units
+            ? in_next - max_code_units
+            : in_first;
+        while (lead != scan_end &&
+               unsigned_code_unit_type(*lead) >= 0x80 &&
+               unsigned_code_unit_type(*lead) <= 0xBF)
+        {
+            --lead;
+        }
+        const code_unit_type *lead_next = lead;
+        decode_status ds = decode(
+            state, lead_next, in_next, c, decoded_code_units);
+        if (ds == decode_status::no_error && lead_next == in_next) {
+            in_next = lead;
+            return ds;
+        }
+
+        std::reverse_iterator<const code_unit_type*> rnext{in_next};
+        std::reverse_iterator<const code_unit_type*> rend{in_first};
+        ds = rdecode(state, rnext, rend, c, decoded_code_units);
+        in_next = rnext.base();
+        return ds;
+    }
+
+    // Decodes the contiguous code unit sequence [in_first, in_last) into the
+    // code point buffer [out_first, out_last).  Decoding stops when the input
+    // is exhausted, the output is full, or an error is encountered; errors
+    // are reported exactly as decode() would report them, but the ill-formed
+    // code unit sequence is not skipped.
+    static decode_n_result decode_n(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last,
+        code_point_type *out_first,
+        code_point_type *out_last)
+    noexcept
+    {
+        const code_unit_type *in_next = in_first;
+        code_point_type *out_next = out_first;
+        decode_status ds = decode_status::no_error;
+
+        while (in_next != in_last && out_next != out_last) {
+            unsigned_code_unit_type cu1 = *in_next;
+            if (cu1 <= 0x7F) {
+                // Single code unit sequences are common enough to warrant
+                // checking eight of them at a time.
+                if (sizeof(code_unit_type) == 1) {
+                    while (in_last - in_next >= 8 && out_last - out_next >= 8) {
+                        std::uint64_t block;
+                        std::memcpy(&block, in_next, sizeof(block));
+                        if (block & UINT64_C(0x8080808080808080)) {
+                            break;
+                        }
+                        for (int i = 0; i < 8; ++i) {
+                            *out_next++ = static_cast<unsigned_code_unit_type>(
+                                              *in_next++);
+                        }
+                    }
+                    if (in_next == in_last || out_next == out_last) {
+                        break;
+                    }
+                    cu1 = *in_next;
+                    if (cu1 > 0x7F) {
+                        continue;
+                    }
+                }
+                *out_next++ = cu1;
+                ++in_next;
+                continue;
+            }
+
+            std::ptrdiff_t available = in_last - in_next;
+            if (is_invalid_leading_code_unit(cu1)) {
+                ds = decode_status::invalid_code_unit_sequence;
+                break;
+            }
+
+            if (available < 2) {
+                ds = decode_status::underflow;
+                break;
+            }
+            unsigned_code_unit_type cu2 = in_next[1];
+            if (is_invalid_second_code_unit(cu1, cu2)) {
+                ds = decode_status::invalid_code_unit_sequence;
+                break;
+            }
+            if ((cu1 & 0xE0) == 0xC0) {
+                *out_next++ = ((cu1 & 0x1F) << 6) + (cu2 & 0x3F);
+                in_next += 2;
+                continue;
+            }
+
+            if (available < 3) {
+                ds = decode_status::underflow;
+                break;
+            }
+            unsigned_code_unit_type cu3 = in_next[2];
+            if (is_invalid_third_or_fourth_code_unit(cu3)) {
+                ds = decode_status::invalid_code_unit_sequence;
+                break;
+            }
+            if ((cu1 & 0xF0) == 0xE0) {
+                *out_next++ = ((cu1 & 0x0F) << 12) +
+                              ((cu2 & 0x3F) << 6) +
+                               (cu3 & 0x3F);
+                in_next += 3;
+                continue;
+            }
+
+            if (available < 4) {
+                ds = decode_status::underflow;
+                break;
+            }
+            unsigned_code_unit_type cu4 = in_next[3];
+            if (is_invalid_third_or_fourth_code_unit(cu4)) {
+                ds = decode_status::invalid_code_unit_sequence;
+                break;
+            }
+            *out_next++ = ((cu1 & 0x07) << 18) +
+                          ((cu2 & 0x3F) << 12) +
+                          ((cu3 & 0x3F) << 6) +
+                           (cu4 & 0x3F);
+            in_next += 4;
+        }
+
+        return { in_next - in_first, out_next - out_first, ds };
+    }
+
+    // Returns the end of the longest prefix of [in_first, in_last) that
+    // consists of single code unit (ASCII) sequences.
+    static const code_unit_type* single_code_unit_run_end(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 1) {
+            while (in_last - in_first >= 8) {
+                std::uint64_t block;
+                std::memcpy(&block, in_first, sizeof(block));
+                if (block & UINT64_C(0x8080808080808080)) {
+                    break;
+                }
+                in_first += 8;
+            }
+        }
+        while (in_first != in_last &&
+               unsigned_code_unit_type(*in_first) <= 0x7F)
+        {
+            ++in_first;
+        }
+        return in_first;
+    }
+
+    // Validates the contiguous code unit sequence [in_first, in_last) without
+    // decoding it.  The same rules that decode() applies are enforced; the
+    // offset of the first ill-formed code unit sequence, if any, is reported.
+    // 8-bit code units are validated by vectorized implementations when
+    // supported by the processor.
+    static validate_result validate(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 1) {
+            return utf8_validate(
+                reinterpret_cast<const unsigned char*>(in_first),
+                reinterpret_cast<const unsigned char*>(in_last));
+        }
+        return validate_by_decode_n<utf8_codec>(in_first, in_last);
+    }
+
+    // Returns the number of characters that iterating the contiguous code
+    // unit sequence [in_first, in_last) produces, counting each ill-formed
+    // code unit sequence as one character.  Well-formed code unit sequences
+    // are counted without being decoded; 8-bit code units are validated and
+    // counted by vectorized implementations when supported by the processor.
+    static std::ptrdiff_t code_point_count(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 1) {
+            return code_point_count_by_prefix<utf8_codec>(
+                in_first,
+                in_last,
+                [](const code_unit_type *first, const code_unit_type *last) {
+                    return utf8_count_code_points(
+                        reinterpret_cast<const unsigned char*>(first),
+                        reinterpret_cast<const unsigned char*>(last));
+                });
+        }
+        return code_point_count_by_decode<utf8_codec>(
+            state_type{}, in_first, in_last);
+    }
+
+    // Encodes the contiguous code point sequence [in_first, in_last) into the
+    // code unit buffer [out_first, out_last).  Encoding stops when the input
+    // is exhausted, the output has insufficient space for the code units of
+    // the next code point, or a code point that encode() would reject as
+    // encode_status::invalid_character is encountered; the offset of that
+    // code point is reported.  8-bit code units are encoded by vectorized
+    // implementations when supported by the processor.
+    static encode_n_result encode_n(
+        const code_point_type *in_first,
+        const code_point_type *in_last,
+        code_unit_type *out_first,
+        code_unit_type *out_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 1 && sizeof(code_point_type) == 4) {
+            return utf8_encode_n(
+                reinterpret_cast<const char32_t*>(in_first),
+                reinterpret_cast<const char32_t*>(in_last),
+                reinterpret_cast<unsigned char*>(out_first),
+                reinterpret_cast<unsigned char*>(out_last));
+        }
+        return encode_n_by_encode<utf8_codec>(
+            in_first, in_last, out_first, out_last);
+    }
+
+    // Returns the number of code units that encode_n() requires to encode the
+    // contiguous code point sequence [in_first, in_last), so that an output
+    // buffer can be sized before encoding.  Errors are reported as for
+    // encode_n(), in which case the length of the prefix that precedes the
+    // invalid code point is returned.
+    static encode_n_result encoded_length(
+        const code_point_type *in_first,
+        const code_point_type *in_last)
+    noexcept
+    {
+        if (sizeof(code_unit_type) == 1 && sizeof(code_point_type) == 4) {
+            return utf8_encoded_length(
+                reinterpret_cast<const char32_t*>(in_first),
+                reinterpret_cast<const char32_t*>(in_last));
+        }
+        return encoded_length_by_encode<utf8_codec>(in_first, in_last);
+    }
+
 private:
     static bool is_invalid_leading_code_unit(
         unsigned_code_unit_type cu)
@@ -0,0 +1,442 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#if !defined(TEXT_VIEW_CODECS_UTF8_DFA_CODEC_HPP) // {
+#define TEXT_VIEW_CODECS_UTF8_DFA_CODEC_HPP
+
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <text_view_detail/bulk_result.hpp>
+#include <text_view_detail/codecs/codec_util.hpp>
+#include <text_view_detail/codecs/utf8_codec.hpp>
+#include <text_view_detail/concepts.hpp>
+#include <text_view_detail/character.hpp>
+#include <text_view_detail/error_status.hpp>
+#include <text_view_detail/trivial_encoding_state.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+/*
+ * Tables for the UTF-8 decoding automata of utf8_dfa_codec.  Code units are
+ * first mapped to one of twelve classes that distinguish the ranges of
+ * Unicode 9.0, table 3-7 in chapter 3.9, "Unicode Encoding Forms".  The
+ * automata then step from state to state according to the class of each
+ * code unit until a code point is accepted or the code unit is rejected.
+ */
+namespace utf8_dfa {
+
+enum code_unit_class : std::uint8_t {
+    c_ascii,    // 00..7F
+    c_cont_80,  // 80..8F
+    c_cont_90,  // 90..9F
+    c_cont_a0,  // A0..BF
+    c_invalid,  // C0..C1, F5..FF
+    c_lead_2,   // C2..DF
+    c_lead_e0,  // E0
+    c_lead_3,   // E1..EC, EE..EF
+    c_lead_ed,  // ED
+    c_lead_f0,  // F0
+    c_lead_4,   // F1..F3
+    c_lead_f4,  // F4
+    class_count
+};
+
+inline constexpr std::uint8_t classes[256] = {
+#define TEXT_VIEW_UTF8_DFA_X16(c) c, c, c, c, c, c, c, c, c, c, c, c, c, c, c, c
+    // 00..7F
+    TEXT_VIEW_UTF8_DFA_X16(c_ascii), TEXT_VIEW_UTF8_DFA_X16(c_ascii),
+    TEXT_VIEW_UTF8_DFA_X16(c_ascii), TEXT_VIEW_UTF8_DFA_X16(c_ascii),
+    TEXT_VIEW_UTF8_DFA_X16(c_ascii), TEXT_VIEW_UTF8_DFA_X16(c_ascii),
+    TEXT_VIEW_UTF8_DFA_X16(c_ascii), TEXT_VIEW_UTF8_DFA_X16(c_ascii),
+    // 80..BF
+    TEXT_VIEW_UTF8_DFA_X16(c_cont_80), TEXT_VIEW_UTF8_DFA_X16(c_cont_90),
+    TEXT_VIEW_UTF8_DFA_X16(c_cont_a0), TEXT_VIEW_UTF8_DFA_X16(c_cont_a0),
+    // C0..DF
+    c_invalid, c_invalid, c_lead_2, c_lead_2,
+    c_lead_2, c_lead_2, c_lead_2, c_lead_2,
+    c_lead_2, c_lead_2, c_lead_2, c_lead_2,
+    c_lead_2, c_lead_2, c_lead_2, c_lead_2,
+    TEXT_VIEW_UTF8_DFA_X16(c_lead_2),
+    // E0..EF
+    c_lead_e0, c_lead_3, c_lead_3, c_lead_3,
+    c_lead_3, c_lead_3, c_lead_3, c_lead_3,
+    c_lead_3, c_lead_3, c_lead_3, c_lead_3,
+    c_lead_3, c_lead_ed, c_lead_3, c_lead_3,
+    // F0..FF
+    c_lead_f0, c_lead_4, c_lead_4, c_lead_4,
+    c_lead_f4, c_invalid, c_invalid, c_invalid,
+    c_invalid, c_invalid, c_invalid, c_invalid,
+    c_invalid, c_invalid, c_invalid, c_invalid
+#undef TEXT_VIEW_UTF8_DFA_X16
+};
+
+// Bits of a leading code unit that contribute to the code point, by class.
+inline constexpr std::uint8_t leading_bits[class_count] = {
+    0x7F, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x0F, 0x0F, 0x0F, 0x07, 0x07, 0x07
+};
+
+// States of the forward automaton.  The 'first' states are those reached by
+// a leading code unit that restricts the range of the second code unit.
+enum forward_state : std::uint8_t {
+    f_accept,       // A code point has been decoded; also the start state.
+    f_reject,
+    f_need_1,       // One continuation code unit remains.
+    f_need_2,
+    f_need_3,
+    f_first_e0,     // E0 read; A0..BF required, then one more.
+    f_first_ed,     // ED read; 80..9F required, then one more.
+    f_first_f0,     // F0 read; 90..BF required, then two more.
+    f_first_f4,     // F4 read; 80..8F required, then two more.
+    forward_state_count
+};
+
+inline constexpr std::uint8_t
+forward_transitions[forward_state_count][class_count] = {
+    // ascii       cont_80     cont_90     cont_a0     invalid     lead_2
+    // lead_e0     lead_3      lead_ed     lead_f0     lead_4      lead_f4
+    // f_accept
+    { f_accept,   f_reject,   f_reject,   f_reject,   f_reject,   f_need_1,
+      f_first_e0, f_need_2,   f_first_ed, f_first_f0, f_need_3,   f_first_f4 },
+    // f_reject
+    { f_reject,   f_reject,   f_reject,   f_reject,   f_reject,   f_reject,
+      f_reject,   f_reject,   f_reject,   f_reject,   f_reject,   f_reject },
+    // f_need_1
+    { f_reject,   f_accept,   f_accept,   f_accept,   f_reject,   f_reject,
+      f_reject,   f_reject,   f_reject,   f_reject,   f_reject,   f_reject },
+    // f_need_2
+    { f_reject,   f_need_1,   f_need_1,   f_need_1,   f_reject,   f_reject,
+      f_reject,   f_reject,   f_reject,   f_reject,   f_reject,   f_reject },
+    // f_need_3
+    { f_reject,   f_need_2,   f_need_2,   f_need_2,   f_reject,   f_reject,
+      f_reject,   f_reject,   f_reject,   f_reject,   f_reject,   f_reject },
+    // f_first_e0
+    { f_reject,   f_reject,   f_reject,   f_need_1,   f_reject,   f_reject,
+      f_reject,   f_reject,   f_reject,   f_reject,   f_reject,   f_reject },
+    // f_first_ed
+    { f_reject,   f_need_1,   f_need_1,   f_reject,   f_reject,   f_reject,
+      f_reject,   f_reject,   f_reject,   f_reject,   f_reject,   f_reject },
+    // f_first_f0
+    { f_reject,   f_reject,   f_need_2,   f_need_2,   f_reject,   f_reject,
+      f_reject,   f_reject,   f_reject,   f_reject,   f_reject,   f_reject },
+    // f_first_f4
+    { f_reject,   f_need_2,   f_reject,   f_reject,   f_reject,   f_reject,
+      f_reject,   f_reject,   f_reject,   f_reject,   f_reject,   f_reject },
+};
+
+// States of the reverse automaton.  Since the range of the second code unit
+// of a sequence depends on its leading code unit, the class of the
+// continuation code unit read last is retained until the leading code unit
+// is read.
+enum reverse_state : std::uint8_t {
+    r_start,
+    r_accept,
+    r_reject,
+    r_read_1,       // One continuation code unit read.
+    r_read_2_80,    // Two read; the last one in 80..8F.
+    r_read_2_90,    // Two read; the last one in 90..9F.
+    r_read_2_a0,    // Two read; the last one in A0..BF.
+    r_read_3_80,    // Three read; the last one in 80..8F.
+    r_read_3_90,    // Three read; the last one in 90..9F.
+    r_read_3_a0,    // Three read; the last one in A0..BF.
+    reverse_state_count
+};
+
+inline constexpr std::uint8_t
+reverse_transitions[reverse_state_count][class_count] = {
+    // ascii       cont_80     cont_90     cont_a0     invalid     lead_2
+    // lead_e0     lead_3      lead_ed     lead_f0     lead_4      lead_f4
+    // r_start
+    { r_accept,   r_read_1,   r_read_1,   r_read_1,   r_reject,   r_reject,
+      r_reject,   r_reject,   r_reject,   r_reject,   r_reject,   r_reject },
+    // r_accept
+    { r_reject,   r_reject,   r_reject,   r_reject,   r_reject,   r_reject,
+      r_reject,   r_reject,   r_reject,   r_reject,   r_reject,   r_reject },
+    // r_reject
+    { r_reject,   r_reject,   r_reject,   r_reject,   r_reject,   r_reject,
+      r_reject,   r_reject,   r_reject,   r_reject,   r_reject,   r_reject },
+    // r_read_1
+    { r_reject,   r_read_2_80,r_read_2_90,r_read_2_a0,r_reject,   r_accept,
+      r_reject,   r_reject,   r_reject,   r_reject,   r_reject,   r_reject },
+    // r_read_2_80
+    { r_reject,   r_read_3_80,r_read_3_90,r_read_3_a0,r_reject,   r_reject,
+      r_reject,   r_accept,   r_accept,   r_reject,   r_reject,   r_reject },
+    // r_read_2_90
+    { r_reject,   r_read_3_80,r_read_3_90,r_read_3_a0,r_reject,   r_reject,
+      r_reject,   r_accept,   r_accept,   r_reject,   r_reject,   r_reject },
+    // r_read_2_a0
+    { r_reject,   r_read_3_80,r_read_3_90,r_read_3_a0,r_reject,   r_reject,
+      r_accept,   r_accept,   r_reject,   r_reject,   r_reject,   r_reject },
+    // r_read_3_80
+    { r_reject,   r_reject,   r_reject,   r_reject,   r_reject,   r_reject,
+      r_reject,   r_reject,   r_reject,   r_reject,   r_accept,   r_accept },
+    // r_read_3_90
+    { r_reject,   r_reject,   r_reject,   r_reject,   r_reject,   r_reject,
+      r_reject,   r_reject,   r_reject,   r_accept,   r_accept,   r_reject },
+    // r_read_3_a0
+    { r_reject,   r_reject,   r_reject,   r_reject,   r_reject,   r_reject,
+      r_reject,   r_reject,   r_reject,   r_accept,   r_accept,   r_reject },
+};
+
+} // namespace utf8_dfa
+
+
+/*
+ * A UTF-8 codec that decodes with table driven automata rather than with a
+ * cascade of range checks.  Each code unit costs a class lookup and a state
+ * transition regardless of its value, which avoids the branch mispredictions
+ * that utf8_codec incurs on text that mixes code unit sequences of different
+ * lengths.  Results, including the code units consumed to resynchronize after
+ * an ill-formed code unit sequence, are identical to those of utf8_codec, to
+ * which encoding and the bulk operations are delegated.
+ */
+template<Character CT, CodeUnit CUT>
+class utf8_dfa_codec {
+    using utf8_codec_type = utf8_codec<CT, CUT>;
+
+public:
+    using state_type = trivial_encoding_state;
+    using state_transition_type = trivial_encoding_state_transition;
+    using character_type = CT;
+    using code_unit_type = CUT;
+    using unsigned_code_unit_type = std::make_unsigned_t<code_unit_type>;
+    using code_point_type =
+        code_point_type_t<character_set_type_t<character_type>>;
+    static constexpr int min_code_units = 1;
+    static constexpr int max_code_units = 4;
+
+    static_assert(sizeof(code_unit_type) * CHAR_BIT >= 8);
+
+    template<CodeUnitOutputIterator<unsigned_code_unit_type> CUIT>
+    static encode_status encode_state_transition(
+        state_type &state,
+        CUIT &out,
+        const state_transition_type &stt,
+        int &encoded_code_units)
+    noexcept
+    {
+        return utf8_codec_type::encode_state_transition(
+            state, out, stt, encoded_code_units);
+    }
+
+    template<CodeUnitOutputIterator<unsigned_code_unit_type> CUIT>
+    static encode_status encode(
+        state_type &state,
+        CUIT &out,
+        character_type c,
+        int &encoded_code_units)
+    noexcept(text_detail::NoExceptOutputIterator<
+                 CUIT, unsigned_code_unit_type>())
+    {
+        return utf8_codec_type::encode(state, out, c, encoded_code_units);
+    }
+
+    template<CodeUnitIterator CUIT, typename CUST>
+    requires ranges::ForwardIterator<CUIT>
+          && ranges::ConvertibleTo<
+                 ranges::value_type_t<CUIT>,
+                 unsigned_code_unit_type>
+          && ranges::Sentinel<CUST, CUIT>
+    static decode_status decode(
+        state_type &state,
+        CUIT &in_next,
+        CUST in_end,
+        character_type &c,
+        int &decoded_code_units)
+    noexcept(text_detail::NoExceptInputIterator<CUIT, CUST>())
+    {
+        decoded_code_units = 0;
+
+        if (in_next == in_end)
+            return decode_status::underflow;
+
+        std::uint_least32_t cp = 0;
+        std::uint8_t s = utf8_dfa::f_accept;
+        do {
+            unsigned_code_unit_type cu = *in_next;
+            std::uint8_t cls = code_unit_class(cu);
+            std::uint8_t next_s = utf8_dfa::forward_transitions[s][cls];
+            if (next_s == utf8_dfa::f_reject) {
+                // The rejected code unit is not consumed unless it is not a
+                // leading code unit; see skip_to_leading_code_unit().
+                skip_to_leading_code_unit(in_next, in_end, decoded_code_units);
+                return decode_status::invalid_code_unit_sequence;
+            }
+            cp = s == utf8_dfa::f_accept
+               ? (cu & utf8_dfa::leading_bits[cls])
+               : ((cp << 6) | (cu & 0x3F));
+            s = next_s;
+            ++in_next;
+            ++decoded_code_units;
+        } while (s != utf8_dfa::f_accept && in_next != in_end);
+
+        if (s != utf8_dfa::f_accept)
+            return decode_status::underflow;
+        c.set_code_point(code_point_type(cp));
+        return decode_status::no_error;
+    }
+
+    template<CodeUnitIterator CUIT, typename CUST>
+    requires ranges::ForwardIterator<CUIT>
+          && ranges::ConvertibleTo<
+                 ranges::value_type_t<CUIT>,
+                 unsigned_code_unit_type>
+          && ranges::Sentinel<CUST, CUIT>
+    static decode_status rdecode(
+        state_type &state,
+        CUIT &in_next,
+        CUST in_end,
+        character_type &c,
+        int &decoded_code_units)
+    noexcept(text_detail::NoExceptInputIterator<CUIT, CUST>())
+    {
+        decoded_code_units = 0;
+
+        if (in_next == in_end)
+            return decode_status::underflow;
+
+        std::uint_least32_t cp = 0;
+        int shift = 0;
+        std::uint8_t s = utf8_dfa::r_start;
+        do {
+            unsigned_code_unit_type rcu = *in_next;
+            std::uint8_t cls = code_unit_class(rcu);
+            std::uint8_t next_s = utf8_dfa::reverse_transitions[s][cls];
+            if (next_s == utf8_dfa::r_reject) {
+                skip_to_trailing_code_unit(in_next, in_end, decoded_code_units);
+                return decode_status::invalid_code_unit_sequence;
+            }
+            if (next_s == utf8_dfa::r_accept) {
+                cp |= std::uint_least32_t(rcu & utf8_dfa::leading_bits[cls])
+                          << shift;
+            } else {
+                cp |= std::uint_least32_t(rcu & 0x3F) << shift;
+                shift += 6;
+            }
+            s = next_s;
+            ++in_next;
+            ++decoded_code_units;
+        } while (s != utf8_dfa::r_accept && in_next != in_end);
+
+        if (s != utf8_dfa::r_accept)
+            return decode_status::underflow;
+        c.set_code_point(code_point_type(cp));
+        return decode_status::no_error;
+    }
+
+    static decode_n_result decode_n(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last,
+        code_point_type *out_first,
+        code_point_type *out_last)
+    noexcept
+    {
+        return utf8_codec_type::decode_n(
+            in_first, in_last, out_first, out_last);
+    }
+
+    static const code_unit_type* single_code_unit_run_end(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        return utf8_codec_type::single_code_unit_run_end(in_first, in_last);
+    }
+
+    static validate_result validate(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        return utf8_codec_type::validate(in_first, in_last);
+    }
+
+    static std::ptrdiff_t code_point_count(
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        return utf8_codec_type::code_point_count(in_first, in_last);
+    }
+
+    static encode_n_result encode_n(
+        const code_point_type *in_first,
+        const code_point_type *in_last,
+        code_unit_type *out_first,
+        code_unit_type *out_last)
+    noexcept
+    {
+        return utf8_codec_type::encode_n(
+            in_first, in_last, out_first, out_last);
+    }
+
+    static encode_n_result encoded_length(
+        const code_point_type *in_first,
+        const code_point_type *in_last)
+    noexcept
+    {
+        return utf8_codec_type::encoded_length(in_first, in_last);
+    }
+
+private:
+    static std::uint8_t code_unit_class(
+        unsigned_code_unit_type cu)
+    {
+        // Code units wider than 8 bits that exceed 0xFF are never valid.
+        return cu <= 0xFF ? utf8_dfa::classes[cu] : utf8_dfa::c_invalid;
+    }
+
+    template<CodeUnitIterator CUIT, ranges::Sentinel<CUIT> CUST>
+    static void skip_to_leading_code_unit(
+        CUIT &in_next,
+        CUST in_end,
+        int &decoded_code_units)
+    noexcept(text_detail::NoExceptInputIterator<CUIT, CUST>())
+    {
+        while (in_next != in_end) {
+            unsigned_code_unit_type cu = *in_next;
+            if (cu <= 0x7F || (cu >= 0xC2 && cu <= 0xF4)) {
+                // Found a leading code unit.
+                return;
+            }
+            ++in_next;
+            ++decoded_code_units;
+        }
+    }
+
+    template<CodeUnitIterator CUIT, ranges::Sentinel<CUIT> CUST>
+    static void skip_to_trailing_code_unit(
+        CUIT &in_next,
+        CUST in_end,
+        int &decoded_code_units)
+    noexcept(text_detail::NoExceptInputIterator<CUIT, CUST>())
+    {
+        while (in_next != in_end) {
+            unsigned_code_unit_type cu = *in_next;
+            if (cu <= 0xBF) {
+                // Found a trailing code unit.
+                return;
+            }
+            ++in_next;
+            ++decoded_code_units;
+        }
+    }
+};
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_CODECS_UTF8_DFA_CODEC_HPP
@@ -0,0 +1,57 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#if !defined(TEXT_VIEW_CODECS_UTF8_KERNELS_HPP) // {
+#define TEXT_VIEW_CODECS_UTF8_KERNELS_HPP
+
+
+#include <text_view_detail/bulk_result.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+// Bulk UTF-8 operations on contiguous 8-bit code unit sequences.  These are
+// implemented out of line so that vectorized implementations can be selected
+// at run-time according to the features of the processor.
+
+// Validates [first, last) according to the rules implemented by utf8_codec.
+validate_result utf8_validate(
+    const unsigned char *first,
+    const unsigned char *last) noexcept;
+
+// Counts the code points of the longest well-formed prefix of the UTF-8 code
+// unit sequence [first, last).  code_units is the length of the prefix and
+// status is the error, if any, that ends it.
+decode_n_result utf8_count_code_points(
+    const unsigned char *first,
+    const unsigned char *last) noexcept;
+
+// Encodes the code points [in_first, in_last) as UTF-8 to the buffer
+// [out_first, out_last) according to the rules implemented by utf8_codec.
+encode_n_result utf8_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept;
+
+// Returns the number of code units required to encode the code points
+// [first, last) as UTF-8.
+encode_n_result utf8_encoded_length(
+    const char32_t *first,
+    const char32_t *last) noexcept;
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_CODECS_UTF8_KERNELS_HPP
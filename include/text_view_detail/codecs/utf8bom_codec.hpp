@@ -77,6 +77,8 @@ public:
     using character_type = CT;
     using code_unit_type = CUT;
     using unsigned_code_unit_type = std::make_unsigned_t<code_unit_type>;
+    using code_point_type =
+        code_point_type_t<character_set_type_t<character_type>>;
     static constexpr int min_code_units = 1;
     static constexpr int max_code_units = 4;
 
@@ -168,6 +170,13 @@ public:
         static_assert(std::is_empty<utf8_state_type>::value);
 
         utf8_state_type discarded_utf8_state;
+        if (state.bom_read_or_written) {
+            // The BOM has been resolved; only the first character of the
+            // input requires the BOM check below.
+            return utf8_codec::decode(
+                discarded_utf8_state, in_next, in_end, c, decoded_code_units);
+        }
+
         decode_status return_value = utf8_codec::decode(
             discarded_utf8_state, in_next, in_end, c, decoded_code_units);
 
@@ -228,6 +237,57 @@ public:
 
         return return_value;
     }
+
+    // Decodes the contiguous code unit sequence [in_first, in_last) into the
+    // code point buffer [out_first, out_last), starting in the specified
+    // state.  The BOM, if not yet read, is resolved once with decode(); the
+    // remaining code units are decoded in a single call to the decode_n()
+    // member of the utf8_codec class template.  Results are otherwise as for
+    // that member; a BOM that is read is included in code_units and updates
+    // the state.
+    static decode_n_result decode_n(
+        state_type &state,
+        const code_unit_type *in_first,
+        const code_unit_type *in_last,
+        code_point_type *out_first,
+        code_point_type *out_last)
+    noexcept
+    {
+        if (out_first == out_last) {
+            return { 0, 0, decode_status::no_error };
+        }
+        const code_unit_type *in_next = in_first;
+        decode_status ds =
+            resolve_bom<utf8bom_codec>(state, in_next, in_last);
+        if (ds != decode_status::no_error) {
+            return { 0, 0, ds };
+        }
+        decode_n_result r = utf8_codec<CT, CUT>::decode_n(
+            in_next, in_last, out_first, out_last);
+        r.code_units += in_next - in_first;
+        return r;
+    }
+
+    // Validates the contiguous code unit sequence [in_first, in_last) as it
+    // would be decoded starting in the specified state.  The BOM is resolved
+    // as for decode_n(), after which the validate() member of the utf8_codec
+    // class template is called.
+    static validate_result validate(
+        state_type state,
+        const code_unit_type *in_first,
+        const code_unit_type *in_last)
+    noexcept
+    {
+        const code_unit_type *in_next = in_first;
+        decode_status ds =
+            resolve_bom<utf8bom_codec>(state, in_next, in_last);
+        if (ds != decode_status::no_error) {
+            return { 0, ds };
+        }
+        validate_result r = utf8_codec<CT, CUT>::validate(in_next, in_last);
+        r.code_units += in_next - in_first;
+        return r;
+    }
 };
 
 } // namespace text_detail
@@ -0,0 +1,42 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_CPU_FEATURES_HPP // {
+#define TEXT_VIEW_CPU_FEATURES_HPP
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+/*
+ * cpu_features
+ * Instruction set extensions that are supported by both the processor and
+ * the operating system.  Used to select vectorized implementations of bulk
+ * encoding and decoding operations at run-time.
+ */
+struct cpu_features {
+    bool sse2;
+    bool ssse3;
+    bool sse4_2;
+    bool avx2;
+    bool avx512bw;
+};
+
+// Returns the features of the processor the program is running on.  The
+// processor is queried once; subsequent calls return the same object.
+const cpu_features& get_cpu_features() noexcept;
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_CPU_FEATURES_HPP
@@ -0,0 +1,157 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_ENCODED_SIZE_HPP // {
+#define TEXT_VIEW_ENCODED_SIZE_HPP
+
+
+#include <cstddef>
+#include <type_traits>
+#include <text_view_detail/adl_customization.hpp>
+#include <text_view_detail/bulk_result.hpp>
+#include <text_view_detail/concepts.hpp>
+#include <text_view_detail/error_policy.hpp>
+#include <text_view_detail/error_status.hpp>
+#include <text_view_detail/exceptions.hpp>
+#include <text_view_detail/itext_iterator.hpp>
+#include <text_view_detail/transcode.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+namespace text_detail {
+
+/*
+ * Returns the number of code units that writing the character c to an
+ * otext_iterator for the encoding ET with the error policy TEP produces.  As
+ * for otext_iterator, characters that cannot be encoded result in the
+ * substitution character being encoded or an exception being thrown.
+ */
+template<TextEncoding ET, TextErrorPolicy TEP>
+std::ptrdiff_t encoded_character_length(
+    typename ET::state_type &state,
+    const character_type_t<ET> &c)
+{
+    code_unit_type_t<ET> buffer[2 * ET::max_code_units];
+    code_unit_type_t<ET> *buffer_next = buffer;
+    int encoded_code_units = 0;
+    encode_status es = ET::encode(state, buffer_next, c, encoded_code_units);
+    if (text::error_occurred(es)) {
+        if (std::is_base_of<text_permissive_error_policy, TEP>::value) {
+            using CT = character_type_t<ET>;
+            using CST = character_set_type_t<CT>;
+            CT sc;
+            sc.set_code_point(CST::get_substitution_code_point());
+            ET::encode(state, buffer_next, sc, encoded_code_units);
+        } else {
+            throw text_encode_error{es};
+        }
+    }
+    return buffer_next - buffer;
+}
+
+} // namespace text_detail
+
+
+/*
+ * encoded_size
+ * Returns the number of code units that encoding the characters of a text
+ * view with the encoding ToET produces; that is, the number of code units
+ * written when the characters of the view are copied to an otext_iterator
+ * for ToET that has the same error policy as the view and starts from the
+ * initial encoding state.  Errors are handled as that copy would handle
+ * them; with the strict error policy, an exception is thrown for an
+ * ill-formed code unit sequence of the view or for a character that ToET
+ * cannot encode.  The result can be used to size the output of transcode()
+ * or to reserve the capacity of a container before writing to it.
+ */
+// Overload for views of contiguous code units.  Well-formed code unit
+// sequences are measured by the transcoded_length() member of the transcoder
+// for the pair of encodings without being decoded one character at a time.
+template<TextEncoding ToET, TextView TVT>
+requires ranges::Same<
+             character_type_t<encoding_type_t<TVT>>,
+             character_type_t<ToET>>
+      && text_detail::ContiguousCodeUnitView<
+             encoding_type_t<TVT>, typename TVT::view_type>()
+std::ptrdiff_t encoded_size(const TVT &tv)
+{
+    using FromET = encoding_type_t<TVT>;
+    using error_policy = typename TVT::error_policy;
+    using from_code_unit_type = code_unit_type_t<FromET>;
+
+    auto from_state = tv.initial_state();
+    auto to_state = ToET::initial_state();
+    const from_code_unit_type *in_next =
+        text_detail::adl_begin(tv.base());
+    const from_code_unit_type *in_last =
+        text_detail::adl_end(tv.base());
+    std::ptrdiff_t size = 0;
+    while (in_next != in_last) {
+        transcode_result r =
+            text_detail::transcoder<FromET, ToET>::transcoded_length(
+                from_state, to_state, in_next, in_last);
+        in_next += r.input_code_units;
+        size += r.output_code_units;
+        if (in_next == in_last) {
+            break;
+        }
+
+        // The code unit sequence at in_next could not be transcoded.  It is
+        // decoded as the view's iterator would decode it.
+        character_type_t<FromET> c;
+        int decoded_code_units = 0;
+        decode_status ds = FromET::decode(
+            from_state, in_next, in_last, c, decoded_code_units);
+        if (text::error_occurred(ds)) {
+            if (std::is_base_of<
+                    text_permissive_error_policy,
+                    error_policy
+                >::value)
+            {
+                using CST = character_set_type_t<character_type_t<FromET>>;
+                c.set_code_point(CST::get_substitution_code_point());
+            } else {
+                throw text_decode_error{ds};
+            }
+        } else if (ds != decode_status::no_error) {
+            continue;
+        }
+        size += text_detail::encoded_character_length<ToET, error_policy>(
+            to_state, c);
+    }
+    return size;
+}
+
+// Overload for other views.  The view is iterated and each character is
+// encoded to a temporary buffer.
+template<TextEncoding ToET, TextView TVT>
+requires ranges::Same<
+             character_type_t<encoding_type_t<TVT>>,
+             character_type_t<ToET>>
+std::ptrdiff_t encoded_size(const TVT &tv)
+{
+    using error_policy = typename TVT::error_policy;
+
+    auto to_state = ToET::initial_state();
+    std::ptrdiff_t size = 0;
+    for (const auto &c : tv) {
+        size += text_detail::encoded_character_length<ToET, error_policy>(
+            to_state, c);
+    }
+    return size;
+}
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_ENCODED_SIZE_HPP
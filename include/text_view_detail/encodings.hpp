@@ -12,6 +12,7 @@
 #include <text_view_detail/encodings/basic_encodings.hpp>
 #include <text_view_detail/encodings/unicode_encodings.hpp>
 #include <text_view_detail/encodings/std_encodings.hpp>
+#include <text_view_detail/encodings/fixed_width_encoding.hpp>
 
 
 #endif // } TEXT_VIEW_ENCODINGS_HPP
@@ -0,0 +1,46 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_FIXED_WIDTH_ENCODING_HPP // {
+#define TEXT_VIEW_FIXED_WIDTH_ENCODING_HPP
+
+
+#include <type_traits>
+#include <text_view_detail/codecs/fixed_width_codec.hpp>
+#include <text_view_detail/concepts.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+/*
+ * Fixed width encoding adaptor
+ * Restricts a stateless encoding to the characters that it encodes with a
+ * single code unit, such as ASCII for UTF-8 or the Basic Multilingual Plane
+ * for UTF-16.  Text in such an encoding satisfies TextRandomAccessDecoder
+ * for random access code unit iterators.
+ */
+template<TextEncoding ET>
+requires std::is_empty<typename ET::state_type>::value
+struct fixed_width_encoding
+    : public text_detail::fixed_width_codec<ET>
+{
+    using state_type = typename ET::state_type;
+
+    static const state_type& initial_state() noexcept {
+        return ET::initial_state();
+    }
+};
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_FIXED_WIDTH_ENCODING_HPP
@@ -11,8 +11,10 @@
 #include <cstdint>
 #include <text_view_detail/charsets/unicode_charsets.hpp>
 #include <text_view_detail/character.hpp>
+#include <text_view_detail/codecs/latin1_codec.hpp>
 #include <text_view_detail/codecs/trivial_codec.hpp>
 #include <text_view_detail/codecs/utf8_codec.hpp>
+#include <text_view_detail/codecs/utf8_dfa_codec.hpp>
 #include <text_view_detail/codecs/utf8bom_codec.hpp>
 #include <text_view_detail/codecs/utf16_codec.hpp>
 #include <text_view_detail/codecs/utf16be_codec.hpp>
@@ -46,6 +48,22 @@ struct iso_10646_wide_character_encoding
 #endif // __STDC_ISO_10646__
 
 
+/*
+ * ISO/IEC 8859-1 (Latin-1) character encoding
+ * Encodes the first 256 code points of Unicode as single code units.
+ */
+struct latin1_encoding
+    : public text_detail::latin1_codec<
+                 character<unicode_character_set>,
+                 char>
+{
+    static const state_type& initial_state() noexcept {
+        static const state_type state{};
+        return state;
+    }
+};
+
+
 /*
  * Unicode UTF-8 character encodings
  */
@@ -61,6 +79,20 @@ struct utf8_encoding
     }
 };
 
+// A UTF-8 encoding that decodes with table driven automata.  Decoding results
+// are identical to those of utf8_encoding.
+// FIXME: If P0482 were to be adopted, replace char with char8_t.
+struct utf8_dfa_encoding
+    : public text_detail::utf8_dfa_codec<
+                 character<unicode_character_set>,
+                 char>
+{
+    static const state_type& initial_state() noexcept {
+        static const state_type state{};
+        return state;
+    }
+};
+
 // FIXME: If P0482 were to be adopted, replace char with char8_t.
 struct utf8bom_encoding
     : public text_detail::utf8bom_codec<
@@ -42,6 +42,17 @@ class text_strict_error_policy : public text_error_policy {};
 // 3.9 of the Unicode 9.0 standard.
 class text_permissive_error_policy : public text_error_policy {};
 
+// When the assume valid error policy is in effect, code unit sequences are
+// presumed to be well-formed, as is the case for text that has already been
+// validated.  Encodings that provide a decode_unchecked() member are then
+// decoded without validity checks; in debug builds (when NDEBUG is not
+// defined) their code unit sequences are still checked and an assertion
+// fails if one is ill-formed.  The behavior of decoding an ill-formed code
+// unit sequence without checks is undefined.  Errors that are nevertheless
+// detected are handled as for the permissive error policy, so no exceptions
+// are thrown.
+class text_assume_valid_error_policy : public text_permissive_error_policy {};
+
 
 using text_default_error_policy = TEXT_VIEW_DEFAULT_ERROR_POLICY;
 
@@ -9,6 +9,7 @@
 
 
 #include <cassert>
+#include <type_traits>
 #include <experimental/ranges/iterator>
 #include <text_view_detail/adl_customization.hpp>
 #include <text_view_detail/caching_iterator.hpp>
@@ -63,18 +64,130 @@ private:
 };
 
 
-template<ranges::InputIterator I>
+// Input iterators are adapted by a caching_iterator with the capacity to
+// hold the code units of one character; itext_cursor clears the cache before
+// decoding each character.  Only ill-formed code unit sequences that are
+// skipped as a single error may exceed the capacity.
+template<TextEncoding ET, ranges::InputIterator I>
 struct itext_current_iterator_type {
-    using type = caching_iterator<I>;
+    using type = caching_iterator<I, ET::max_code_units>;
 };
-template<ranges::ForwardIterator I>
-struct itext_current_iterator_type<I> {
+template<TextEncoding ET, ranges::ForwardIterator I>
+struct itext_current_iterator_type<ET, I> {
     using type = I;
 };
 
-template<ranges::InputIterator I>
+template<TextEncoding ET, ranges::InputIterator I>
 using itext_current_iterator_type_t =
-    typename itext_current_iterator_type<I>::type;
+    typename itext_current_iterator_type<ET, I>::type;
+
+
+/*
+ * Contiguous code unit view concept
+ * Satisfied by views that hold pointers to a contiguous sequence of the code
+ * units of an encoding.  Encodings may provide operations on such sequences
+ * that are more efficient than those performed with the decode() and
+ * rdecode() members.
+ */
+template<typename ET, typename VT>
+concept bool ContiguousCodeUnitView() {
+    return std::is_pointer<ranges::iterator_t<std::add_const_t<VT>>>::value
+        && ranges::Same<
+               ranges::sentinel_t<std::add_const_t<VT>>,
+               ranges::iterator_t<std::add_const_t<VT>>>
+        && ranges::Same<
+               std::remove_cv_t<std::remove_pointer_t<
+                   ranges::iterator_t<std::add_const_t<VT>>>>,
+               code_unit_type_t<ET>>;
+}
+
+
+/*
+ * Single code unit run decoder concept
+ * Encodings that provide single_code_unit_run_end() are able to identify runs
+ * of code units that each encode, by themselves, a character with a code point
+ * value equal to the value of the code unit.  When the code units of a view
+ * are held in contiguous storage, such runs are decoded without calling
+ * decode().
+ */
+template<typename ET, typename VT>
+concept bool SingleCodeUnitRunDecoder() {
+    return ContiguousCodeUnitView<ET, VT>()
+        && requires (const code_unit_type_t<ET> *p) {
+               { ET::single_code_unit_run_end(p, p) } noexcept
+                   -> const code_unit_type_t<ET>*;
+           };
+}
+
+
+/*
+ * Contiguous reverse decoder concept
+ * Encodings that provide decode_prev() are able to decode the character that
+ * precedes a position in a contiguous code unit sequence without the use of
+ * reverse iterators.  Such encodings locate the code units of the character
+ * and decode them forward.
+ */
+template<typename ET, typename VT>
+concept bool ContiguousReverseDecoder() {
+    return ContiguousCodeUnitView<ET, VT>()
+        && requires (typename ET::state_type &state,
+                     const code_unit_type_t<ET> *p,
+                     character_type_t<ET> &c,
+                     int &decoded_code_units)
+           {
+               { ET::decode_prev(state, p, p, c, decoded_code_units) } noexcept
+                   -> decode_status;
+           };
+}
+
+
+/*
+ * Unchecked decoder concept
+ * Encodings that provide decode_unchecked() are able to decode code unit
+ * sequences that are known to be well-formed without checking them for
+ * validity.  Such encodings are decoded with decode_unchecked() when
+ * text_assume_valid_error_policy is in effect.
+ */
+template<typename ET, typename CUIT, typename CUST>
+concept bool UncheckedDecoder() {
+    return requires (typename ET::state_type &state,
+                     CUIT &in_next,
+                     CUST in_end,
+                     character_type_t<ET> &c,
+                     int &decoded_code_units)
+           {
+               { ET::decode_unchecked(
+                     state, in_next, in_end, c, decoded_code_units) }
+                   -> decode_status;
+           };
+}
+
+
+/*
+ * The end of the run of single code unit sequences that starts at the
+ * current position of an itext_cursor.  Code units in [current, run_end) are
+ * known to each encode a character.  Only cursors for views that satisfy
+ * SingleCodeUnitRunDecoder hold a run end.
+ */
+template<TextEncoding ET, ranges::View VT>
+class itext_cursor_run {
+protected:
+    template<typename I>
+    void reset_run(const I&) noexcept {}
+};
+
+template<TextEncoding ET, ranges::View VT>
+requires SingleCodeUnitRunDecoder<ET, VT>()
+class itext_cursor_run<ET, VT> {
+protected:
+    using run_iterator_type = ranges::iterator_t<std::add_const_t<VT>>;
+
+    void reset_run(const run_iterator_type &current) noexcept {
+        run_end = current;
+    }
+
+    run_iterator_type run_end = {};
+};
 
 
 template<TextEncoding ET, ranges::View VT>
@@ -148,13 +261,14 @@ public:
     }
 
 protected:
-    caching_iterator<iterator_type> current;
+    itext_current_iterator_type_t<encoding_type, iterator_type> current;
 };
 
 template<TextEncoding ET, ranges::View VT>
 requires ranges::ForwardIterator<ranges::iterator_t<VT>>
 class itext_cursor_data<ET, VT>
-    : public itext_cursor_base<ET, VT>
+    : public itext_cursor_base<ET, VT>,
+      protected itext_cursor_run<ET, VT>
 {
     using encoding_type = typename itext_cursor_data::encoding_type;
     using view_type = typename itext_cursor_data::view_type;
@@ -184,7 +298,9 @@ public:
     :
         itext_cursor_base<ET, VT>{std::move(state), view},
         current_view{first, first}
-    {}
+    {
+        this->reset_run(first);
+    }
 
     const iterator_type& base() const noexcept {
         return current_view.first;
@@ -342,8 +458,7 @@ public:
         while (this->current != end) {
             value_type tmp_value;
             int decoded_code_units = 0;
-            decode_status ds = encoding_type::decode(
-                this->state(),
+            decode_status ds = decode_character(
                 this->current,
                 end,
                 tmp_value,
@@ -368,32 +483,46 @@ public:
     void next()
         requires TextForwardDecoder<encoding_type, iterator_type>()
     {
-        ok = false;
-        this->current_view.first = this->current_view.last;
-        iterator_type tmp_iterator{this->current_view.first};
-        auto end(text_detail::adl_end(*this->underlying_view()));
-        while (tmp_iterator != end) {
-            value_type tmp_value;
-            int decoded_code_units = 0;
-            decode_status ds = encoding_type::decode(
-                this->state(),
-                tmp_iterator,
-                end,
-                tmp_value,
-                decoded_code_units);
-            this->current_view.last = tmp_iterator;
-            if (text::error_occurred(ds)) {
-                value.set_error(ds);
-                ok = true;
-                break;
-            }
-            else if (ds == decode_status::no_error) {
-                value.set_character(tmp_value);
-                ok = true;
-                break;
+        decode_next();
+    }
+
+    // Runs of single code unit sequences are located by scanning ahead a
+    // bounded number of code units at a time; the characters they encode are
+    // then produced directly from the code units until the end of the run is
+    // reached.  Bounding the scan limits the cost of constructing iterators
+    // that are only advanced a few times.
+    void next()
+        requires TextForwardDecoder<encoding_type, iterator_type>()
+              && SingleCodeUnitRunDecoder<encoding_type, view_type>()
+    {
+        if (this->current_view.last == this->run_end) {
+            constexpr difference_type max_scan_length = 64;
+            iterator_type scan_end{
+                text_detail::adl_end(*this->underlying_view())};
+            if (scan_end - this->current_view.last > max_scan_length) {
+                scan_end = this->current_view.last + max_scan_length;
             }
+            this->run_end = this->current_view.last +
+                (encoding_type::single_code_unit_run_end(
+                     this->current_view.last, scan_end) -
+                 this->current_view.last);
+        }
+        if (this->current_view.last != this->run_end) {
+            using code_unit_type = code_unit_type_t<encoding_type>;
+            using code_point_type =
+                code_point_type_t<character_set_type_t<value_type>>;
+            value_type tmp_value;
+            tmp_value.set_code_point(code_point_type(
+                std::make_unsigned_t<code_unit_type>(
+                    *this->current_view.last)));
+            value.set_character(tmp_value);
+            ok = true;
             this->current_view.first = this->current_view.last;
+            ++this->current_view.last;
+            return;
         }
+        decode_next();
+        this->reset_run(this->current_view.last);
     }
 
     // For input iterators, a proxy is returned for post increment operations
@@ -439,6 +568,43 @@ public:
             }
             this->current_view.last = this->current_view.first;
         }
+        this->reset_run(this->current_view.last);
+    }
+
+    void prev()
+        requires TextBidirectionalDecoder<encoding_type, iterator_type>()
+              && ContiguousReverseDecoder<encoding_type, view_type>()
+    {
+        ok = false;
+        this->current_view.last = this->current_view.first;
+        iterator_type first{text_detail::adl_begin(*this->underlying_view())};
+        while (this->current_view.last != first) {
+            value_type tmp_value;
+            int decoded_code_units = 0;
+            // decode_prev() operates on pointers to const code units; the
+            // view may hold pointers to non-const code units.
+            const code_unit_type_t<encoding_type> *current{
+                this->current_view.last};
+            decode_status ds = encoding_type::decode_prev(
+                this->state(),
+                first,
+                current,
+                tmp_value,
+                decoded_code_units);
+            this->current_view.first = first + (current - first);
+            if (text::error_occurred(ds)) {
+                value.set_error(ds);
+                ok = true;
+                break;
+            }
+            else if (ds == decode_status::no_error) {
+                value.set_character(tmp_value);
+                ok = true;
+                break;
+            }
+            this->current_view.last = this->current_view.first;
+        }
+        this->reset_run(this->current_view.last);
     }
 
     void advance(difference_type n)
@@ -451,6 +617,7 @@ public:
         } else if (n > 0) {
             this->current_view.last +=
                 ((n-1) * encoding_type::max_code_units);
+            this->reset_run(this->current_view.last);
             next();
         }
     }
@@ -481,6 +648,76 @@ public:
     }
 
 private:
+    void decode_next()
+        requires TextForwardDecoder<encoding_type, iterator_type>()
+    {
+        ok = false;
+        this->current_view.first = this->current_view.last;
+        iterator_type tmp_iterator{this->current_view.first};
+        auto end(text_detail::adl_end(*this->underlying_view()));
+        while (tmp_iterator != end) {
+            value_type tmp_value;
+            int decoded_code_units = 0;
+            decode_status ds = decode_character(
+                tmp_iterator,
+                end,
+                tmp_value,
+                decoded_code_units);
+            this->current_view.last = tmp_iterator;
+            if (text::error_occurred(ds)) {
+                value.set_error(ds);
+                ok = true;
+                break;
+            }
+            else if (ds == decode_status::no_error) {
+                value.set_character(tmp_value);
+                ok = true;
+                break;
+            }
+            this->current_view.first = this->current_view.last;
+        }
+    }
+
+    template<typename CUIT, typename CUST>
+    decode_status decode_character(
+        CUIT &in_next,
+        CUST in_end,
+        value_type &c,
+        int &decoded_code_units)
+    {
+        return encoding_type::decode(
+            this->state(), in_next, in_end, c, decoded_code_units);
+    }
+
+    // When the assume valid error policy is in effect, code unit sequences
+    // are decoded without validity checks.  In debug builds, they are first
+    // decoded with decode() to confirm that they are well-formed.
+    template<typename CUIT, typename CUST>
+    requires UncheckedDecoder<encoding_type, CUIT, CUST>()
+          && ranges::DerivedFrom<error_policy, text_assume_valid_error_policy>
+    decode_status decode_character(
+        CUIT &in_next,
+        CUST in_end,
+        value_type &c,
+        int &decoded_code_units)
+    {
+#if !defined(NDEBUG)
+        state_type check_state{this->state()};
+        CUIT check_next{in_next};
+        value_type check_c;
+        int check_decoded_code_units = 0;
+        decode_status check_ds = encoding_type::decode(
+            check_state, check_next, in_end, check_c,
+            check_decoded_code_units);
+        assert(! text::error_occurred(check_ds)
+               && "ill-formed code unit sequence with "
+                  "text_assume_valid_error_policy");
+        (void)check_ds;
+#endif
+        return encoding_type::decode_unchecked(
+            this->state(), in_next, in_end, c, decoded_code_units);
+    }
+
     static const value_type& dereference(
         const character_or_error<encoding_type> &coe)
     {
@@ -521,6 +758,7 @@ template<
 requires TextForwardDecoder<
              ET,
              text_detail::itext_current_iterator_type_t<
+                 ET,
                  ranges::iterator_t<std::add_const_t<VT>>>>()
 using itext_iterator =
     ranges::basic_iterator<text_detail::itext_cursor<ET, VT, TEP>>;
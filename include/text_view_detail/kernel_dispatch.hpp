@@ -0,0 +1,132 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_KERNEL_DISPATCH_HPP // {
+#define TEXT_VIEW_KERNEL_DISPATCH_HPP
+
+
+#include <atomic>
+#include <initializer_list>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+/*
+ * simd_level
+ * The instruction set extensions that vectorized implementations of bulk
+ * encoding, decoding, and transcoding operations require, in increasing
+ * order.  Each implementation requires the extensions of a single level.
+ */
+enum class simd_level : int {
+    scalar,
+    sse2,
+    ssse3,
+    sse4_2,
+    avx2,
+    avx512bw
+};
+
+// Limits the implementations selected for subsequent bulk operations to those
+// that require at most the specified level; simd_level::scalar forces the
+// scalar implementations.  The initial limit is read from the
+// TEXT_VIEW_SIMD_LEVEL environment variable when it names a level (for
+// example, "scalar" or "sse4_2"); otherwise, no limit is imposed.  Intended
+// for testing and benchmarking; bulk operations that are in progress in other
+// threads may complete with the implementations selected previously.
+void set_simd_level_limit(simd_level level) noexcept;
+
+// Returns the current limit.
+simd_level get_simd_level_limit() noexcept;
+
+// Returns the highest level that is supported by the processor and the
+// operating system and that does not exceed the current limit.
+simd_level get_simd_level() noexcept;
+
+
+namespace text_detail {
+
+// Returns true if implementations that require the specified level may be
+// selected; that is, if the level is supported and does not exceed the
+// current limit.
+bool simd_level_enabled(simd_level level) noexcept;
+
+// Returns a value that changes whenever the limit changes.  Used by
+// kernel_dispatcher to detect that a selection must be made again.
+unsigned int simd_dispatch_generation() noexcept;
+
+
+/*
+ * kernel_dispatcher
+ * A table of the implementations of a bulk operation, listed in order of
+ * preference with the level each requires.  The first enabled implementation
+ * is selected on first use and again after the limit changes; the scalar
+ * implementation, listed last, is always enabled.  Dispatchers are constant
+ * initialized so that they may be used during the initialization of other
+ * objects with static storage duration.
+ */
+template<typename F>
+class kernel_dispatcher {
+public:
+    struct candidate {
+        simd_level level;
+        F function;
+    };
+
+    constexpr kernel_dispatcher(
+        std::initializer_list<candidate> candidates) noexcept
+    {
+        for (const candidate &c : candidates) {
+            if (candidate_count < max_candidates) {
+                this->candidates[candidate_count++] = c;
+            }
+        }
+    }
+
+    F get() noexcept {
+        unsigned int current_generation = simd_dispatch_generation();
+        if (generation.load(std::memory_order_acquire) != current_generation) {
+            select(current_generation);
+        }
+        return function.load(std::memory_order_relaxed);
+    }
+
+    template<typename... Args>
+    auto operator()(Args... args) noexcept {
+        return get()(args...);
+    }
+
+private:
+    void select(unsigned int current_generation) noexcept {
+        F selected = candidates[candidate_count - 1].function;
+        for (int i = 0; i < candidate_count; ++i) {
+            if (simd_level_enabled(candidates[i].level)) {
+                selected = candidates[i].function;
+                break;
+            }
+        }
+        function.store(selected, std::memory_order_relaxed);
+        generation.store(current_generation, std::memory_order_release);
+    }
+
+    static constexpr int max_candidates = 6;
+    candidate candidates[max_candidates] = {};
+    int candidate_count = 0;
+    std::atomic<F> function{nullptr};
+    std::atomic<unsigned int> generation{0};
+};
+
+} // namespace text_detail
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_KERNEL_DISPATCH_HPP
@@ -0,0 +1,146 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_MAPPED_FILE_HPP // {
+#define TEXT_VIEW_MAPPED_FILE_HPP
+
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <text_view_detail/basic_view.hpp>
+#include <text_view_detail/concepts.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+/*
+ * mapped_file_advice
+ * The pattern in which the contents of a mapped file are expected to be
+ * accessed, which the operating system may use to schedule reading ahead.
+ */
+enum class mapped_file_advice {
+    normal,
+    sequential,
+    random
+};
+
+
+namespace text_detail {
+
+/*
+ * The address and size in bytes of a read-only mapping of a file.  Empty
+ * files are not mapped; their region has a null address.
+ */
+struct mapped_region {
+    const void *data;
+    std::size_t size;
+};
+
+// Maps the file with the specified path read-only into memory.  Throws
+// std::system_error if the file cannot be opened or mapped, or if mapping
+// files is not supported on the platform.
+mapped_region map_file(const char *path, mapped_file_advice advice);
+
+// Unmaps a region returned by map_file().
+void unmap_file(const mapped_region &region) noexcept;
+
+} // namespace text_detail
+
+
+/*
+ * basic_mapped_file
+ * A read-only memory mapping of a file, viewed as a contiguous sequence of
+ * code units of type CUT in native byte order.  Bytes at the end of the file
+ * that do not complete a code unit are excluded.  The mapping is released
+ * when the object is destroyed; objects may be moved, but not copied.
+ *
+ * The iterators of the range are pointers, so a text view constructed from
+ * it with make_text_view() benefits from the optimizations available for
+ * contiguous code unit sequences.  Such a text view, like its iterators,
+ * refers to the mapping and must not outlive it.
+ */
+template<CodeUnit CUT>
+class basic_mapped_file {
+public:
+    using iterator = const CUT*;
+
+    // The default constructor produces an object that maps no file and that
+    // is an empty range.
+    basic_mapped_file() = default;
+
+    explicit basic_mapped_file(
+        const char *path,
+        mapped_file_advice advice = mapped_file_advice::sequential)
+    :
+        region(text_detail::map_file(path, advice))
+    {}
+
+    explicit basic_mapped_file(
+        const std::string &path,
+        mapped_file_advice advice = mapped_file_advice::sequential)
+    :
+        basic_mapped_file{path.c_str(), advice}
+    {}
+
+    basic_mapped_file(basic_mapped_file &&other) noexcept
+    :
+        region(std::exchange(other.region, text_detail::mapped_region{}))
+    {}
+
+    basic_mapped_file& operator=(basic_mapped_file &&other) noexcept {
+        if (this != &other) {
+            text_detail::unmap_file(region);
+            region = std::exchange(other.region, text_detail::mapped_region{});
+        }
+        return *this;
+    }
+
+    ~basic_mapped_file() {
+        text_detail::unmap_file(region);
+    }
+
+    const CUT* data() const noexcept {
+        return static_cast<const CUT*>(region.data);
+    }
+
+    // Returns the number of code units in the file.
+    std::size_t size() const noexcept {
+        return region.size / sizeof(CUT);
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    const CUT* begin() const noexcept {
+        return data();
+    }
+
+    const CUT* end() const noexcept {
+        return data() + size();
+    }
+
+    // Returns a view of the code units of the file that refers to the
+    // mapping.
+    text_detail::basic_view<const CUT*> view() const noexcept {
+        return { begin(), end() };
+    }
+
+private:
+    text_detail::mapped_region region{nullptr, 0};
+};
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_MAPPED_FILE_HPP
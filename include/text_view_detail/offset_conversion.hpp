@@ -0,0 +1,162 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_OFFSET_CONVERSION_HPP // {
+#define TEXT_VIEW_OFFSET_CONVERSION_HPP
+
+
+#include <cstddef>
+#include <experimental/ranges/iterator>
+#include <text_view_detail/concepts.hpp>
+#include <text_view_detail/text_index.hpp>
+#include <text_view_detail/text_offset.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+namespace text_detail {
+
+/*
+ * Converts offsets by walking the code unit sequence of a text view.  Each
+ * walk resumes from the position reached for the previous offset when the
+ * offset is not smaller than it; otherwise, it restarts from the beginning
+ * of the view or, when an index is available, from the nearest checkpoint.
+ */
+struct text_offset_converter {
+    template<TextView TVT>
+    static void convert(
+        const TVT &tv,
+        text_offset_unit from,
+        text_offset_unit to,
+        const std::ptrdiff_t *in_first,
+        const std::ptrdiff_t *in_last,
+        std::ptrdiff_t *out_first)
+    {
+        text_offset_walker<TVT> w{tv};
+        for (; in_first != in_last; ++in_first, ++out_first) {
+            std::ptrdiff_t target = *in_first;
+            if (target < w.offset(from)) {
+                w = text_offset_walker<TVT>{tv};
+            }
+            w.advance_to(from, target);
+            *out_first = w.offset(to);
+        }
+    }
+
+    template<TextView TVT>
+    static void convert(
+        const basic_text_index<TVT> &idx,
+        text_offset_unit from,
+        text_offset_unit to,
+        const std::ptrdiff_t *in_first,
+        const std::ptrdiff_t *in_last,
+        std::ptrdiff_t *out_first)
+    {
+        text_offset_walker<TVT> w{idx.walker_at(0)};
+        for (; in_first != in_last; ++in_first, ++out_first) {
+            std::ptrdiff_t target = *in_first;
+            auto i = idx.checkpoint_for(from, target);
+            if (target < w.offset(from) ||
+                w.offset(from) < idx.walker_at(i).offset(from))
+            {
+                w = idx.walker_at(i);
+            }
+            w.advance_to(from, target);
+            *out_first = w.offset(to);
+        }
+    }
+};
+
+} // namespace text_detail
+
+
+/*
+ * convert_offsets
+ * Converts the offsets of positions within a text view in the range
+ * [in_first, in_last) from one text_offset_unit to another, writing the
+ * results to the range that starts at out_first; the ranges may be the same.
+ * An offset that falls within the code units of a character is converted as
+ * the offset of the start of that character; an offset beyond the end of
+ * the view is converted as the offset of its end.  Offsets sorted in
+ * non-decreasing order are converted in a single pass over the view; an
+ * offset smaller than the one before it restarts the pass.  Runs of code
+ * units that each encode a character, such as ASCII in UTF-8, are passed
+ * over without being decoded, with vectorized implementations when supported
+ * by the processor.  UTF-16 offsets assume that the code points of the
+ * view's character set are Unicode code points.
+ */
+template<TextView TVT>
+requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+void convert_offsets(
+    const TVT &tv,
+    text_offset_unit from,
+    text_offset_unit to,
+    const std::ptrdiff_t *in_first,
+    const std::ptrdiff_t *in_last,
+    std::ptrdiff_t *out_first)
+{
+    text_detail::text_offset_converter::convert(
+        tv, from, to, in_first, in_last, out_first);
+}
+
+// Overload for indexed text views.  Each conversion starts from the nearest
+// checkpoint at or before the offset, unless continuing from the previous
+// offset is no more costly, and so decodes at most interval characters
+// regardless of the order of the offsets.
+template<TextView TVT>
+void convert_offsets(
+    const basic_text_index<TVT> &idx,
+    text_offset_unit from,
+    text_offset_unit to,
+    const std::ptrdiff_t *in_first,
+    const std::ptrdiff_t *in_last,
+    std::ptrdiff_t *out_first)
+{
+    text_detail::text_offset_converter::convert(
+        idx, from, to, in_first, in_last, out_first);
+}
+
+
+/*
+ * convert_offset
+ * Converts the offset of a single position within a text view, or an indexed
+ * text view, from one text_offset_unit to another as convert_offsets() does.
+ */
+template<TextView TVT>
+requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+std::ptrdiff_t convert_offset(
+    const TVT &tv,
+    text_offset_unit from,
+    text_offset_unit to,
+    std::ptrdiff_t offset)
+{
+    std::ptrdiff_t result;
+    convert_offsets(tv, from, to, &offset, &offset + 1, &result);
+    return result;
+}
+
+template<TextView TVT>
+std::ptrdiff_t convert_offset(
+    const basic_text_index<TVT> &idx,
+    text_offset_unit from,
+    text_offset_unit to,
+    std::ptrdiff_t offset)
+{
+    std::ptrdiff_t result;
+    convert_offsets(idx, from, to, &offset, &offset + 1, &result);
+    return result;
+}
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_OFFSET_CONVERSION_HPP
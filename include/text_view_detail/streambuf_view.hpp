@@ -0,0 +1,471 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_STREAMBUF_VIEW_HPP // {
+#define TEXT_VIEW_STREAMBUF_VIEW_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <streambuf>
+#include <type_traits>
+#include <vector>
+#include <experimental/ranges/concepts>
+#include <experimental/ranges/iterator>
+#include <text_view_detail/adl_customization.hpp>
+#include <text_view_detail/basic_view.hpp>
+#include <text_view_detail/bulk_result.hpp>
+#include <text_view_detail/code_point_count.hpp>
+#include <text_view_detail/concepts.hpp>
+#include <text_view_detail/error_status.hpp>
+#include <text_view_detail/validated_text_view.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+namespace text_detail {
+
+/*
+ * The buffer shared by the copies of a basic_streambuf_view and by its
+ * iterators.  Code units are read from the stream buffer a chunk at a time
+ * with sgetn(), as the bytes of their object representation, and are
+ * consumed from the front of the buffer.  Bytes that do not complete a code
+ * unit at the end of the stream are discarded.
+ */
+template<CodeUnit CUT>
+class streambuf_chunk_buffer {
+public:
+    streambuf_chunk_buffer(
+        std::streambuf *sb,
+        std::size_t chunk_size)
+    :
+        sb{sb},
+        units(std::max<std::size_t>(chunk_size, 1))
+    {}
+
+    const CUT* begin() const noexcept {
+        return units.data() + first;
+    }
+    const CUT* end() const noexcept {
+        return units.data() + size_bytes / sizeof(CUT);
+    }
+
+    void consume(std::size_t n) noexcept {
+        first += n;
+    }
+
+    // Reads from the stream buffer until at least n code units that have not
+    // been consumed are buffered or the stream is exhausted.  Returns whether
+    // n code units are buffered.
+    bool fill(std::size_t n) {
+        if (std::size_t(end() - begin()) >= n) {
+            return true;
+        }
+        if (exhausted) {
+            return false;
+        }
+        char *bytes = reinterpret_cast<char*>(units.data());
+        std::size_t consumed_bytes = first * sizeof(CUT);
+        std::memmove(bytes, bytes + consumed_bytes,
+                     size_bytes - consumed_bytes);
+        size_bytes -= consumed_bytes;
+        first = 0;
+        if (units.size() < n) {
+            units.resize(n);
+            bytes = reinterpret_cast<char*>(units.data());
+        }
+        while (std::size_t(end() - begin()) < n) {
+            std::streamsize read = sb->sgetn(
+                bytes + size_bytes,
+                units.size() * sizeof(CUT) - size_bytes);
+            if (read <= 0) {
+                exhausted = true;
+                return false;
+            }
+            size_bytes += read;
+        }
+        return true;
+    }
+
+private:
+    std::streambuf *sb;
+    std::vector<CUT> units;
+    // The index of the first code unit that has not been consumed.
+    std::size_t first = 0;
+    // The number of bytes read into the buffer, including those of consumed
+    // code units.
+    std::size_t size_bytes = 0;
+    bool exhausted = false;
+};
+
+/*
+ * Cursor for the iterators of a basic_streambuf_view.  All iterators of a
+ * view share its buffer and so its position; advancing one advances all of
+ * them.  The mixin provides access to the code units buffered at the current
+ * position so that they may be processed in bulk.
+ */
+template<CodeUnit CUT>
+class streambuf_cursor {
+public:
+    using single_pass = std::true_type;
+    using difference_type = std::ptrdiff_t;
+
+    class mixin
+        : protected ranges::basic_mixin<streambuf_cursor>
+    {
+        using base_type = ranges::basic_mixin<streambuf_cursor>;
+    public:
+        mixin() = default;
+
+        using base_type::base_type;
+
+        // Returns the code units that are buffered at the current position.
+        basic_view<const CUT*> chunk() const noexcept {
+            return { this->get().buffer->begin(), this->get().buffer->end() };
+        }
+
+        // Buffers at least n code units at the current position, unless the
+        // stream is exhausted first.  Returns whether n code units are
+        // buffered.
+        bool fill(std::size_t n) const {
+            return this->get().buffer->fill(n);
+        }
+
+        // Advances past n buffered code units.
+        void consume(std::size_t n) const noexcept {
+            this->get().buffer->consume(n);
+        }
+    };
+
+    streambuf_cursor() = default;
+
+    streambuf_cursor(streambuf_chunk_buffer<CUT> *buffer) noexcept
+        : buffer{buffer} {}
+
+    CUT read() const {
+        buffer->fill(1);
+        return *buffer->begin();
+    }
+
+    void next() {
+        buffer->fill(1);
+        buffer->consume(1);
+    }
+
+private:
+    streambuf_chunk_buffer<CUT> *buffer = nullptr;
+};
+
+template<CodeUnit CUT>
+class streambuf_sentinel {
+    using iterator = ranges::basic_iterator<streambuf_cursor<CUT>>;
+
+public:
+    friend bool operator==(
+        const iterator &i,
+        const streambuf_sentinel &)
+    {
+        return streambuf_sentinel::at_end(i);
+    }
+    friend bool operator!=(
+        const iterator &i,
+        const streambuf_sentinel &s)
+    {
+        return !(i == s);
+    }
+    friend bool operator==(
+        const streambuf_sentinel &s,
+        const iterator &i)
+    {
+        return i == s;
+    }
+    friend bool operator!=(
+        const streambuf_sentinel &s,
+        const iterator &i)
+    {
+        return !(i == s);
+    }
+    friend bool operator==(
+        const streambuf_sentinel &,
+        const streambuf_sentinel &)
+    {
+        return true;
+    }
+    friend bool operator!=(
+        const streambuf_sentinel &,
+        const streambuf_sentinel &)
+    {
+        return false;
+    }
+
+private:
+    static bool at_end(const iterator &i) {
+        return ! i.fill(1);
+    }
+};
+
+} // namespace text_detail
+
+
+/*
+ * basic_streambuf_view
+ * An input view of the code units read from a std::streambuf.  Code units are
+ * read with sgetn() a chunk at a time into a buffer, as the bytes of their
+ * object representation (and so in native byte order for code unit types
+ * wider than char), and are then read by iterators without any further calls
+ * to the stream buffer.  The buffer is shared by copies of the view and its
+ * iterators; they therefore share a single position within the stream.  The
+ * stream buffer must outlive the view, and iterators are invalidated when
+ * the last copy of the view is destroyed.
+ *
+ * The chunk(), fill(), and consume() members of the view and of its
+ * iterators provide access to the code units buffered at the current
+ * position as a contiguous sequence so that they may be decoded in bulk.
+ */
+template<CodeUnit CUT>
+class basic_streambuf_view : public ranges::view_base
+{
+public:
+    using iterator =
+        ranges::basic_iterator<text_detail::streambuf_cursor<CUT>>;
+    using sentinel = text_detail::streambuf_sentinel<CUT>;
+
+    static constexpr std::size_t default_chunk_size = 65536;
+
+    // The default constructor produces a view with no stream buffer.  An
+    // object produced with this constructor may only be assigned to or
+    // destroyed.
+    basic_streambuf_view() = default;
+
+    explicit basic_streambuf_view(
+        std::streambuf *sb,
+        std::size_t chunk_size = default_chunk_size)
+    :
+        buffer{std::make_shared<text_detail::streambuf_chunk_buffer<CUT>>(
+                   sb, chunk_size)}
+    {}
+
+    iterator begin() const noexcept {
+        return iterator{buffer.get()};
+    }
+
+    sentinel end() const noexcept {
+        return {};
+    }
+
+    // Returns the code units that are buffered at the current position.
+    text_detail::basic_view<const CUT*> chunk() const noexcept {
+        return { buffer->begin(), buffer->end() };
+    }
+
+    // Buffers at least n code units at the current position, unless the
+    // stream is exhausted first.  Returns whether n code units are buffered.
+    bool fill(std::size_t n) const {
+        return buffer->fill(n);
+    }
+
+    // Advances past n buffered code units.
+    void consume(std::size_t n) const noexcept {
+        buffer->consume(n);
+    }
+
+private:
+    std::shared_ptr<text_detail::streambuf_chunk_buffer<CUT>> buffer;
+};
+
+
+/*
+ * make_streambuf_view
+ * Constructs a basic_streambuf_view for an explicitly specified code unit
+ * type that reads from a stream buffer in chunks of chunk_size code units.
+ */
+template<CodeUnit CUT>
+basic_streambuf_view<CUT> make_streambuf_view(
+    std::streambuf *sb,
+    std::size_t chunk_size = basic_streambuf_view<CUT>::default_chunk_size)
+{
+    return basic_streambuf_view<CUT>{sb, chunk_size};
+}
+
+
+namespace text_detail {
+
+/*
+ * Chunked code unit iterator concept.  Satisfied by the input iterators of
+ * views, such as basic_streambuf_view, that buffer the code units at their
+ * current position in contiguous chunks.
+ */
+template<typename I>
+concept bool ChunkedCodeUnitIterator() {
+    return ranges::InputIterator<I>
+        && requires (const I i, std::size_t n) {
+               { adl_begin(i.chunk()) } -> const ranges::value_type_t<I>*;
+               { adl_end(i.chunk()) } -> const ranges::value_type_t<I>*;
+               { i.fill(n) } -> bool;
+               i.consume(n);
+           };
+}
+
+// Decodes the longest well-formed prefix of a contiguous code unit sequence
+// with the decode_n() member of the encoding, if it has one, and reports its
+// length and the number of code points in it.  For encodings without
+// decode_n(), the prefix is empty and every code unit sequence is decoded
+// with the decode() member of the encoding.
+template<TextEncoding ET>
+struct well_formed_prefix_decoder {
+    static decode_n_result decode(
+        const code_unit_type_t<ET> *,
+        const code_unit_type_t<ET> *)
+    noexcept
+    {
+        return { 0, 0, decode_status::no_error };
+    }
+};
+
+template<TextEncoding ET>
+requires ContiguousBulkDecoder<
+             ET, basic_view<const code_unit_type_t<ET>*>>()
+struct well_formed_prefix_decoder<ET> {
+    static decode_n_result decode(
+        const code_unit_type_t<ET> *in_first,
+        const code_unit_type_t<ET> *in_last)
+    noexcept
+    {
+        using code_point_type =
+            code_point_type_t<character_set_type_t<character_type_t<ET>>>;
+        constexpr int buffer_size = 256;
+        code_point_type buffer[buffer_size];
+        decode_n_result result{0, 0, decode_status::no_error};
+        while (in_first != in_last) {
+            decode_n_result r = ET::decode_n(
+                in_first, in_last, buffer, buffer + buffer_size);
+            in_first += r.code_units;
+            result.code_units += r.code_units;
+            result.code_points += r.code_points;
+            if (r.status != decode_status::no_error) {
+                result.status = r.status;
+                break;
+            }
+        }
+        return result;
+    }
+};
+
+/*
+ * Counts the characters produced by iterating the code units of a chunked
+ * code unit iterator, consuming them.  Each buffered chunk is decoded in bulk
+ * where the encoding permits, and with its decode() member otherwise.  An
+ * ill-formed code unit sequence that reaches the end of the buffered code
+ * units may continue in code units that have yet to be read.  If it is
+ * shorter than a well-formed one, it is decoded again once more code units
+ * are buffered.  Otherwise, more code units can only extend it; encodings
+ * such as UTF-8 skip runs of code units that cannot begin a character as a
+ * single ill-formed sequence, and decoding from the last code unit of such a
+ * run continues it.  The sequence is then counted and all but its last code
+ * unit consumed, and the ill-formed sequence decoded from that code unit is
+ * not counted again.  The buffer therefore holds no more than the larger of
+ * the chunk size and 2 * max_code_units code units, regardless of the length
+ * of the run.
+ */
+template<TextEncoding ET, ChunkedCodeUnitIterator CUIT>
+std::ptrdiff_t code_point_count_by_chunk(
+    typename ET::state_type state,
+    const CUIT &i)
+{
+    using code_unit_type = code_unit_type_t<ET>;
+    std::ptrdiff_t count = 0;
+    std::size_t required = ET::max_code_units;
+    // Whether the code unit at the front of the buffer continues an
+    // ill-formed code unit sequence that has already been counted.
+    bool in_error_run = false;
+    for (;;) {
+        bool exhausted = ! i.fill(required);
+        auto chunk = i.chunk();
+        const code_unit_type *first = adl_begin(chunk);
+        const code_unit_type *next = first;
+        const code_unit_type *last = adl_end(chunk);
+        required = ET::max_code_units;
+        while (next != last) {
+            if (! in_error_run) {
+                decode_n_result r =
+                    well_formed_prefix_decoder<ET>::decode(next, last);
+                count += r.code_points;
+                next += r.code_units;
+                if (next == last) {
+                    break;
+                }
+            }
+            typename ET::state_type next_state{state};
+            const code_unit_type *character_next = next;
+            character_type_t<ET> c;
+            int decoded_code_units = 0;
+            decode_status ds = ET::decode(
+                next_state, character_next, last, c, decoded_code_units);
+            bool continues_error_run =
+                in_error_run && text::error_occurred(ds);
+            in_error_run = false;
+            if (! exhausted && character_next == last &&
+                text::error_occurred(ds))
+            {
+                if (last - next < ET::max_code_units) {
+                    required = (last - next) + ET::max_code_units;
+                    in_error_run = continues_error_run;
+                    break;
+                }
+                if (! continues_error_run) {
+                    ++count;
+                }
+                state = next_state;
+                next = last - 1;
+                required = 1 + ET::max_code_units;
+                in_error_run = true;
+                break;
+            }
+            state = next_state;
+            next = character_next;
+            if (ds != decode_status::no_character && ! continues_error_run) {
+                ++count;
+            }
+        }
+        i.consume(next - first);
+        if (exhausted && next == last) {
+            break;
+        }
+    }
+    return count;
+}
+
+} // namespace text_detail
+
+
+/*
+ * code_point_count
+ * Overload for views of chunked code unit iterators, such as those of
+ * basic_streambuf_view.  The code units are consumed.
+ */
+template<TextView TVT>
+requires text_detail::ChunkedCodeUnitIterator<
+             typename TVT::code_unit_iterator>()
+ranges::difference_type_t<ranges::iterator_t<const TVT>>
+code_point_count(const TVT &tv)
+{
+    return text_detail::code_point_count_by_chunk<encoding_type_t<TVT>>(
+        tv.initial_state(),
+        text_detail::adl_begin(tv.base()));
+}
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_STREAMBUF_VIEW_HPP
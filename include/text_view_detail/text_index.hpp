@@ -0,0 +1,376 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_TEXT_INDEX_HPP // {
+#define TEXT_VIEW_TEXT_INDEX_HPP
+
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+#include <experimental/ranges/concepts>
+#include <experimental/ranges/iterator>
+#include <text_view_detail/adl_customization.hpp>
+#include <text_view_detail/concepts.hpp>
+#include <text_view_detail/subobject.hpp>
+#include <text_view_detail/text_offset.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+template<TextView TVT>
+requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+class basic_text_index;
+
+
+namespace text_detail {
+
+struct text_offset_converter;
+
+/*
+ * The code unit position and encoding state at which decoding of the
+ * character with a given ordinal starts, and the offset of that position in
+ * code units and in UTF-16 code units.  The state is stored as an empty base
+ * for stateless encodings.
+ */
+template<TextView TVT>
+struct text_index_checkpoint
+    : private subobject<typename TVT::state_type>
+{
+    using base_type = subobject<typename TVT::state_type>;
+
+    explicit text_index_checkpoint(
+        const text_offset_walker<TVT> &w)
+    :
+        base_type{w.state()},
+        position(w.position()),
+        code_units{w.offset(text_offset_unit::code_unit)},
+        utf16_code_units{w.offset(text_offset_unit::utf16_code_unit)}
+    {}
+
+    const typename TVT::state_type& state() const noexcept {
+        return base_type::get();
+    }
+
+    typename TVT::code_unit_iterator position;
+    std::ptrdiff_t code_units;
+    std::ptrdiff_t utf16_code_units;
+};
+
+/*
+ * Cursor for iterators over a basic_text_index.  A text iterator of the
+ * indexed view is paired with the ordinal of the character it references so
+ * that distances are computed by subtraction.  Iterators are advanced by
+ * decoding forward from the nearest checkpoint at or before the target
+ * unless stepping from the current position is no more costly.
+ */
+template<TextView TVT>
+class text_index_cursor {
+    using index_type = basic_text_index<TVT>;
+    using text_iterator = ranges::iterator_t<TVT>;
+    friend index_type;
+
+public:
+    using difference_type = ranges::difference_type_t<text_iterator>;
+
+    class mixin
+        : protected ranges::basic_mixin<text_index_cursor>
+    {
+        using base_type = ranges::basic_mixin<text_index_cursor>;
+    public:
+        using state_type = typename TVT::state_type;
+
+        mixin() = default;
+
+        using base_type::base_type;
+
+        const state_type& state() const noexcept {
+            return this->get().current.state();
+        }
+
+        decltype(auto) base() const noexcept {
+            return this->get().current.base();
+        }
+
+        decltype(auto) base_range() const noexcept {
+            return this->get().current.base_range();
+        }
+
+        bool error_occurred() const noexcept {
+            return this->get().current.error_occurred();
+        }
+
+        decode_status get_error() const noexcept {
+            return this->get().current.get_error();
+        }
+
+        bool is_ok() const noexcept {
+            return this->get().current.is_ok();
+        }
+
+        // Returns the number of characters that precede the referenced
+        // character in the indexed view.
+        difference_type ordinal() const noexcept {
+            return this->get().ordinal;
+        }
+    };
+
+    text_index_cursor() = default;
+
+    text_index_cursor(
+        const index_type *index,
+        text_iterator current,
+        difference_type ordinal)
+    :
+        index{index},
+        current(std::move(current)),
+        ordinal{ordinal}
+    {}
+
+    decltype(auto) read() const {
+        return *current;
+    }
+
+    void next() {
+        ++current;
+        ++ordinal;
+    }
+
+    // Characters are only decoded forward from a checkpoint, even when the
+    // text iterator is bidirectional, since decoding an ill-formed code unit
+    // sequence in reverse may produce a different number of errors and the
+    // ordinal would no longer identify the character.
+    void prev() {
+        advance(-1);
+    }
+
+    // Stepping forward from the current position costs n decode operations;
+    // seeking costs (ordinal + n) % interval of them plus the construction
+    // of a text iterator.
+    void advance(difference_type n) {
+        difference_type target = ordinal + n;
+        assert(target >= 0 && target <= index->size());
+        if (n >= 0 && n <= target % index->interval()) {
+            while (n-- > 0) {
+                next();
+            }
+        } else {
+            *this = index->seek(target);
+        }
+    }
+
+    difference_type distance_to(const text_index_cursor &other) const {
+        return other.ordinal - ordinal;
+    }
+
+    bool equal(const text_index_cursor &other) const {
+        return ordinal == other.ordinal;
+    }
+
+private:
+    const index_type *index = nullptr;
+    text_iterator current;
+    difference_type ordinal = 0;
+};
+
+} // namespace text_detail
+
+
+/*
+ * basic_text_index
+ * An index over the characters of a forward text view that records the code
+ * unit position and encoding state at which every interval'th character is
+ * decoded; these are the checkpoints.  Iterators over the index are random
+ * access iterators: advancing one, in either direction, seeks to the nearest
+ * checkpoint and decodes at most interval - 1 characters from there, and
+ * computing the distance between two takes constant time.  When the code unit
+ * iterators of the view are random access iterators, locate() maps a code
+ * unit position to the character that contains it in
+ * O(log(size() / interval) + interval) time.
+ *
+ * size() / interval + 1 checkpoints are stored, each holding a code unit
+ * iterator, an encoding state (which occupies no storage for stateless
+ * encodings), and the offset of the checkpoint in code units and in UTF-16
+ * code units for use by convert_offsets().  The index holds a copy of the
+ * text view and its iterators refer to the index; they are invalidated when
+ * the index is destroyed, moved from, or assigned to.
+ */
+template<TextView TVT>
+requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+class basic_text_index {
+    friend class text_detail::text_index_cursor<TVT>;
+    friend struct text_detail::text_offset_converter;
+    using cursor_type = text_detail::text_index_cursor<TVT>;
+    using checkpoint_type = text_detail::text_index_checkpoint<TVT>;
+
+public:
+    using text_view_type = TVT;
+    using state_type = typename TVT::state_type;
+    using code_unit_iterator = typename TVT::code_unit_iterator;
+    using iterator = ranges::basic_iterator<cursor_type>;
+    using difference_type = typename cursor_type::difference_type;
+
+    static constexpr difference_type default_interval = 64;
+
+    // The default constructor produces an index of a text view with a
+    // singular range.  An object produced with this constructor may only be
+    // assigned to or destroyed.
+    basic_text_index() = default;
+
+    // Decodes the text view once to record a checkpoint before the first
+    // character and after every interval'th character.
+    explicit basic_text_index(
+        TVT tv,
+        difference_type interval = default_interval)
+    :
+        tv(std::move(tv)),
+        checkpoint_interval{interval}
+    {
+        assert(interval > 0);
+        text_detail::text_offset_walker<TVT> w{this->tv};
+        checkpoints.emplace_back(w);
+        for (;;) {
+            difference_type next =
+                w.offset(text_offset_unit::code_point) + checkpoint_interval;
+            w.advance_to(text_offset_unit::code_point, next);
+            if (w.offset(text_offset_unit::code_point) == next) {
+                checkpoints.emplace_back(w);
+            }
+            if (w.at_end()) {
+                break;
+            }
+        }
+        count = w.offset(text_offset_unit::code_point);
+    }
+
+    const TVT& base() const noexcept {
+        return tv;
+    }
+
+    difference_type interval() const noexcept {
+        return checkpoint_interval;
+    }
+
+    // Returns the number of characters in the view.
+    difference_type size() const noexcept {
+        return count;
+    }
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+    iterator begin() const {
+        return iterator{seek(0)};
+    }
+
+    iterator end() const {
+        return iterator{seek(count)};
+    }
+
+    // Returns an iterator to the first character that is not decoded from
+    // code units that precede the code unit referenced by cu, or end() if
+    // there is none.  cu must reference a code unit of the view or be its
+    // end iterator.
+    iterator locate(code_unit_iterator cu) const
+        requires ranges::RandomAccessIterator<code_unit_iterator>
+    {
+        auto cp = std::upper_bound(
+            checkpoints.begin(), checkpoints.end(), cu,
+            [](const code_unit_iterator &cu, const checkpoint_type &cp) {
+                return cu < cp.position;
+            });
+        assert(cp != checkpoints.begin());
+        cursor_type c{seek_checkpoint(cp - checkpoints.begin() - 1)};
+        while (c.ordinal != count && ! (cu < c.current.base_range().end())) {
+            c.next();
+        }
+        return iterator{c};
+    }
+
+private:
+    cursor_type seek_checkpoint(difference_type i) const {
+        const checkpoint_type &cp = checkpoints[i];
+        return { this,
+                 ranges::iterator_t<TVT>{
+                     cp.state(), &tv.base(), cp.position},
+                 i * checkpoint_interval };
+    }
+
+    // Returns a walker positioned at the i'th checkpoint.
+    text_detail::text_offset_walker<TVT> walker_at(difference_type i) const {
+        const checkpoint_type &cp = checkpoints[i];
+        return { cp.state(),
+                 cp.position,
+                 text_detail::adl_end(tv.base()),
+                 cp.code_units,
+                 i * checkpoint_interval,
+                 cp.utf16_code_units };
+    }
+
+    // Returns the index of the last checkpoint with an offset in the
+    // specified unit that does not exceed the specified offset.
+    difference_type checkpoint_for(
+        text_offset_unit unit,
+        std::ptrdiff_t offset) const
+    {
+        if (unit == text_offset_unit::code_point) {
+            return std::min<difference_type>(
+                std::max<std::ptrdiff_t>(offset, 0) / checkpoint_interval,
+                checkpoints.size() - 1);
+        }
+        auto cp = std::upper_bound(
+            checkpoints.begin(), checkpoints.end(), offset,
+            [unit](std::ptrdiff_t offset, const checkpoint_type &cp) {
+                return offset < (unit == text_offset_unit::code_unit
+                                 ? cp.code_units
+                                 : cp.utf16_code_units);
+            });
+        return cp == checkpoints.begin() ? 0 : cp - checkpoints.begin() - 1;
+    }
+
+    cursor_type seek(difference_type n) const {
+        assert(n >= 0 && n <= count);
+        cursor_type c{seek_checkpoint(n / checkpoint_interval)};
+        while (c.ordinal != n) {
+            c.next();
+        }
+        return c;
+    }
+
+    TVT tv;
+    difference_type checkpoint_interval = default_interval;
+    difference_type count = 0;
+    std::vector<checkpoint_type> checkpoints;
+};
+
+
+/*
+ * make_text_index
+ * Builds an index over the characters of a forward text view with a
+ * checkpoint every interval characters.
+ */
+template<TextView TVT>
+requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+basic_text_index<TVT> make_text_index(
+    TVT tv,
+    typename basic_text_index<TVT>::difference_type interval =
+        basic_text_index<TVT>::default_interval)
+{
+    return basic_text_index<TVT>{std::move(tv), interval};
+}
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_TEXT_INDEX_HPP
@@ -0,0 +1,208 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_TEXT_OFFSET_HPP // {
+#define TEXT_VIEW_TEXT_OFFSET_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <experimental/ranges/iterator>
+#include <text_view_detail/adl_customization.hpp>
+#include <text_view_detail/concepts.hpp>
+#include <text_view_detail/error_status.hpp>
+#include <text_view_detail/itext_iterator.hpp>
+#include <text_view_detail/subobject.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+/*
+ * text_offset_unit
+ * The units in which a position within a text view is measured: the code
+ * units of the view's encoding, the characters of the view (as counted when
+ * iterating it, so that each ill-formed code unit sequence is one
+ * character), or the UTF-16 code units that encoding those characters in
+ * UTF-16 produces (each ill-formed code unit sequence is encoded as the
+ * substitution character).
+ */
+enum class text_offset_unit {
+    code_unit,
+    code_point,
+    utf16_code_unit
+};
+
+
+namespace text_detail {
+
+/*
+ * Decodes the code unit sequence of a text view forward while maintaining
+ * the offset of the current position in each text_offset_unit.  The decode()
+ * member of the encoding is called directly, without the bookkeeping
+ * performed by the view's iterator.
+ */
+template<TextView TVT>
+requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+class text_offset_walker
+    : private subobject<typename TVT::state_type>
+{
+    using base_type = subobject<typename TVT::state_type>;
+    using encoding_type = encoding_type_t<TVT>;
+    using view_type = typename TVT::view_type;
+
+public:
+    using state_type = typename TVT::state_type;
+    using code_unit_iterator = typename TVT::code_unit_iterator;
+    using code_unit_sentinel = typename TVT::code_unit_sentinel;
+
+    text_offset_walker() = default;
+
+    // Overload to start at the beginning of a text view.
+    explicit text_offset_walker(
+        const TVT &tv)
+    :
+        base_type{tv.initial_state()},
+        current(adl_begin(tv.base())),
+        last(adl_end(tv.base()))
+    {}
+
+    // Overload to resume at a position of a text view with known offsets.
+    text_offset_walker(
+        state_type state,
+        code_unit_iterator current,
+        code_unit_sentinel last,
+        std::ptrdiff_t code_units,
+        std::ptrdiff_t code_points,
+        std::ptrdiff_t utf16_code_units)
+    :
+        base_type{std::move(state)},
+        current(std::move(current)),
+        last(std::move(last)),
+        code_units{code_units},
+        code_points{code_points},
+        utf16_code_units{utf16_code_units}
+    {}
+
+    const state_type& state() const noexcept {
+        return base_type::get();
+    }
+
+    const code_unit_iterator& position() const noexcept {
+        return current;
+    }
+
+    bool at_end() const {
+        return current == last;
+    }
+
+    std::ptrdiff_t offset(text_offset_unit unit) const noexcept {
+        switch (unit) {
+        case text_offset_unit::code_unit:
+            return code_units;
+        case text_offset_unit::code_point:
+            return code_points;
+        case text_offset_unit::utf16_code_unit:
+            return utf16_code_units;
+        }
+        return 0;
+    }
+
+    // Advances past each character, and each code unit sequence that only
+    // encodes a state transition, that ends at or before the target offset
+    // in the specified unit.  A target that falls within the code units of a
+    // character leaves the position at the start of that character.
+    void advance_to(text_offset_unit unit, std::ptrdiff_t target) {
+        for (;;) {
+            skip_run(unit, target);
+            if (at_end() || ! step(unit, target)) {
+                break;
+            }
+        }
+    }
+
+private:
+    // Decodes the next character and advances past it if it ends at or
+    // before the target offset.  Returns whether the position advanced.
+    bool step(text_offset_unit unit, std::ptrdiff_t target) {
+        using code_point_type = code_point_type_t<
+            character_set_type_t<character_type_t<encoding_type>>>;
+        state_type next_state{state()};
+        code_unit_iterator next{current};
+        character_type_t<encoding_type> c;
+        int decoded_code_units = 0;
+        decode_status ds = encoding_type::decode(
+            next_state, next, last, c, decoded_code_units);
+        std::ptrdiff_t cu_delta = 0;
+        for (code_unit_iterator it{current}; it != next; ++it) {
+            ++cu_delta;
+        }
+        std::ptrdiff_t cp_delta = 0;
+        std::ptrdiff_t u16_delta = 0;
+        if (ds != decode_status::no_character) {
+            cp_delta = 1;
+            u16_delta = ds == decode_status::no_error &&
+                        code_point_type(c.get_code_point()) >= 0x10000
+                        ? 2 : 1;
+        }
+        std::ptrdiff_t delta =
+            unit == text_offset_unit::code_unit ? cu_delta :
+            unit == text_offset_unit::code_point ? cp_delta :
+            u16_delta;
+        if (offset(unit) + delta > target) {
+            return false;
+        }
+        base_type::get() = std::move(next_state);
+        current = std::move(next);
+        code_units += cu_delta;
+        code_points += cp_delta;
+        utf16_code_units += u16_delta;
+        return true;
+    }
+
+    void skip_run(text_offset_unit, std::ptrdiff_t) noexcept {}
+
+    // Each code unit of a run of single code unit sequences encodes a
+    // character that is also encoded by a single UTF-16 code unit, so runs
+    // advance each offset by their length.  Runs are located by the
+    // (possibly vectorized) single_code_unit_run_end() member of the encoding
+    // without being decoded.
+    void skip_run(text_offset_unit unit, std::ptrdiff_t target) noexcept
+        requires SingleCodeUnitRunDecoder<encoding_type, view_type>()
+    {
+        std::ptrdiff_t n = std::min<std::ptrdiff_t>(
+            target - offset(unit), last - current);
+        if (n <= 0) {
+            return;
+        }
+        std::ptrdiff_t run =
+            encoding_type::single_code_unit_run_end(current, current + n) -
+            current;
+        current += run;
+        code_units += run;
+        code_points += run;
+        utf16_code_units += run;
+    }
+
+    code_unit_iterator current{};
+    code_unit_sentinel last{};
+    std::ptrdiff_t code_units = 0;
+    std::ptrdiff_t code_points = 0;
+    std::ptrdiff_t utf16_code_units = 0;
+};
+
+} // namespace text_detail
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_TEXT_OFFSET_HPP
@@ -0,0 +1,653 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_TRANSCODE_HPP // {
+#define TEXT_VIEW_TRANSCODE_HPP
+
+
+#include <algorithm>
+#include <text_view_detail/bulk_result.hpp>
+#include <text_view_detail/codecs/codec_util.hpp>
+#include <text_view_detail/codecs/transcode_kernels.hpp>
+#include <text_view_detail/codecs/utf16_kernels.hpp>
+#include <text_view_detail/codecs/utf8_kernels.hpp>
+#include <text_view_detail/concepts.hpp>
+#include <text_view_detail/encodings/unicode_encodings.hpp>
+#include <text_view_detail/error_status.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+namespace text_detail {
+
+// Converts the result of decoding to UTF-32 code points with a decode_n()
+// member or kernel to the corresponding transcode_result.
+inline transcode_result from_decode_n_result(
+    const decode_n_result &r) noexcept
+{
+    return { r.code_units,
+             r.code_points,
+             r.status,
+             encode_status::no_error };
+}
+
+// Converts the result of encoding UTF-32 code units with an encode_n()
+// member or kernel to the corresponding transcode_result.  UTF-32 code units
+// that are not valid code points are rejected by encode_n() and
+// encoded_length() as invalid characters; they are reported as the invalid
+// code unit sequences that utf32_encoding::decode() diagnoses.
+inline transcode_result from_utf32_encode_n_result(
+    const encode_n_result &r) noexcept
+{
+    return { r.code_points,
+             r.code_units,
+             error_occurred(r.status)
+                 ? decode_status::invalid_code_unit_sequence
+                 : decode_status::no_error,
+             encode_status::no_error };
+}
+
+/*
+ * transcoder
+ * Transcodes contiguous code unit sequences from one encoding to another.  The
+ * primary template decodes each character with the decode() member of the
+ * source encoding and encodes it with the encode() member of the target
+ * encoding.  Specializations provide dedicated implementations for pairs of
+ * encodings that can be transcoded without per-character operations.
+ * transcoded_length() measures the code units that transcode() would write
+ * to an output of unlimited size without writing them.
+ */
+template<TextEncoding FromET, TextEncoding ToET>
+struct transcoder {
+    using from_state_type = typename FromET::state_type;
+    using to_state_type = typename ToET::state_type;
+    using from_code_unit_type = code_unit_type_t<FromET>;
+    using to_code_unit_type = code_unit_type_t<ToET>;
+
+    static transcode_result transcode(
+        from_state_type &from_state,
+        to_state_type &to_state,
+        const from_code_unit_type *in_first,
+        const from_code_unit_type *in_last,
+        to_code_unit_type *out_first,
+        to_code_unit_type *out_last)
+    {
+        const from_code_unit_type *in_next = in_first;
+        to_code_unit_type *out_next = out_first;
+        while (in_next != in_last) {
+            // The states are restored if the character cannot be written so
+            // that transcoding can be resumed from in_prev.
+            const from_code_unit_type *in_prev = in_next;
+            from_state_type prev_from_state = from_state;
+            to_state_type prev_to_state = to_state;
+
+            character_type_t<FromET> c;
+            int decoded_code_units = 0;
+            decode_status ds = FromET::decode(
+                from_state, in_next, in_last, c, decoded_code_units);
+            if (error_occurred(ds)) {
+                from_state = prev_from_state;
+                return { in_prev - in_first,
+                         out_next - out_first,
+                         ds,
+                         encode_status::no_error };
+            }
+            if (ds != decode_status::no_error) {
+                continue;
+            }
+
+            // Code units are encoded to a temporary buffer so that none are
+            // written unless all of them fit.  Room is allowed for a state
+            // transition, such as a BOM, to be encoded with the character.
+            to_code_unit_type buffer[2 * ToET::max_code_units];
+            to_code_unit_type *buffer_next = buffer;
+            int encoded_code_units = 0;
+            encode_status es = ToET::encode(
+                to_state, buffer_next, c, encoded_code_units);
+            if (error_occurred(es) ||
+                out_last - out_next < buffer_next - buffer)
+            {
+                from_state = prev_from_state;
+                to_state = prev_to_state;
+                return { in_prev - in_first,
+                         out_next - out_first,
+                         decode_status::no_error,
+                         es };
+            }
+            out_next = std::copy(buffer, buffer_next, out_next);
+        }
+        return { in_next - in_first,
+                 out_next - out_first,
+                 decode_status::no_error,
+                 encode_status::no_error };
+    }
+
+    static transcode_result transcoded_length(
+        from_state_type &from_state,
+        to_state_type &to_state,
+        const from_code_unit_type *in_first,
+        const from_code_unit_type *in_last)
+    {
+        const from_code_unit_type *in_next = in_first;
+        std::ptrdiff_t length = 0;
+        while (in_next != in_last) {
+            const from_code_unit_type *in_prev = in_next;
+            from_state_type prev_from_state = from_state;
+
+            character_type_t<FromET> c;
+            int decoded_code_units = 0;
+            decode_status ds = FromET::decode(
+                from_state, in_next, in_last, c, decoded_code_units);
+            if (error_occurred(ds)) {
+                from_state = prev_from_state;
+                return { in_prev - in_first, length, ds,
+                         encode_status::no_error };
+            }
+            if (ds != decode_status::no_error) {
+                continue;
+            }
+
+            to_code_unit_type buffer[2 * ToET::max_code_units];
+            to_code_unit_type *buffer_next = buffer;
+            to_state_type prev_to_state = to_state;
+            int encoded_code_units = 0;
+            encode_status es = ToET::encode(
+                to_state, buffer_next, c, encoded_code_units);
+            if (error_occurred(es)) {
+                from_state = prev_from_state;
+                to_state = prev_to_state;
+                return { in_prev - in_first, length,
+                         decode_status::no_error, es };
+            }
+            length += buffer_next - buffer;
+        }
+        return { in_next - in_first,
+                 length,
+                 decode_status::no_error,
+                 encode_status::no_error };
+    }
+};
+
+template<>
+struct transcoder<utf8_encoding, utf16_encoding> {
+    static transcode_result transcode(
+        utf8_encoding::state_type &,
+        utf16_encoding::state_type &,
+        const char *in_first,
+        const char *in_last,
+        char16_t *out_first,
+        char16_t *out_last) noexcept
+    {
+        return utf8_to_utf16(
+            reinterpret_cast<const unsigned char*>(in_first),
+            reinterpret_cast<const unsigned char*>(in_last),
+            out_first,
+            out_last);
+    }
+
+    static transcode_result transcoded_length(
+        utf8_encoding::state_type &,
+        utf16_encoding::state_type &,
+        const char *in_first,
+        const char *in_last) noexcept
+    {
+        return utf8_to_utf16_length(
+            reinterpret_cast<const unsigned char*>(in_first),
+            reinterpret_cast<const unsigned char*>(in_last));
+    }
+};
+
+template<>
+struct transcoder<utf16_encoding, utf8_encoding> {
+    static transcode_result transcode(
+        utf16_encoding::state_type &,
+        utf8_encoding::state_type &,
+        const char16_t *in_first,
+        const char16_t *in_last,
+        char *out_first,
+        char *out_last) noexcept
+    {
+        return utf16_to_utf8(
+            in_first,
+            in_last,
+            reinterpret_cast<unsigned char*>(out_first),
+            reinterpret_cast<unsigned char*>(out_last));
+    }
+
+    static transcode_result transcoded_length(
+        utf16_encoding::state_type &,
+        utf8_encoding::state_type &,
+        const char16_t *in_first,
+        const char16_t *in_last) noexcept
+    {
+        return utf16_to_utf8_length(in_first, in_last);
+    }
+};
+
+template<>
+struct transcoder<utf8_encoding, utf32_encoding> {
+    static transcode_result transcode(
+        utf8_encoding::state_type &,
+        utf32_encoding::state_type &,
+        const char *in_first,
+        const char *in_last,
+        char32_t *out_first,
+        char32_t *out_last) noexcept
+    {
+        return from_decode_n_result(utf8_encoding::decode_n(
+            in_first, in_last, out_first, out_last));
+    }
+
+    static transcode_result transcoded_length(
+        utf8_encoding::state_type &,
+        utf32_encoding::state_type &,
+        const char *in_first,
+        const char *in_last) noexcept
+    {
+        return from_decode_n_result(utf8_count_code_points(
+            reinterpret_cast<const unsigned char*>(in_first),
+            reinterpret_cast<const unsigned char*>(in_last)));
+    }
+};
+
+template<>
+struct transcoder<utf32_encoding, utf8_encoding> {
+    static transcode_result transcode(
+        utf32_encoding::state_type &,
+        utf8_encoding::state_type &,
+        const char32_t *in_first,
+        const char32_t *in_last,
+        char *out_first,
+        char *out_last) noexcept
+    {
+        return from_utf32_encode_n_result(utf8_encoding::encode_n(
+            in_first, in_last, out_first, out_last));
+    }
+
+    static transcode_result transcoded_length(
+        utf32_encoding::state_type &,
+        utf8_encoding::state_type &,
+        const char32_t *in_first,
+        const char32_t *in_last) noexcept
+    {
+        return from_utf32_encode_n_result(utf8_encoding::encoded_length(
+            in_first, in_last));
+    }
+};
+
+template<>
+struct transcoder<latin1_encoding, utf8_encoding> {
+    static transcode_result transcode(
+        latin1_encoding::state_type &,
+        utf8_encoding::state_type &,
+        const char *in_first,
+        const char *in_last,
+        char *out_first,
+        char *out_last) noexcept
+    {
+        return latin1_to_utf8(
+            reinterpret_cast<const unsigned char*>(in_first),
+            reinterpret_cast<const unsigned char*>(in_last),
+            reinterpret_cast<unsigned char*>(out_first),
+            reinterpret_cast<unsigned char*>(out_last));
+    }
+
+    static transcode_result transcoded_length(
+        latin1_encoding::state_type &,
+        utf8_encoding::state_type &,
+        const char *in_first,
+        const char *in_last) noexcept
+    {
+        return latin1_to_utf8_length(
+            reinterpret_cast<const unsigned char*>(in_first),
+            reinterpret_cast<const unsigned char*>(in_last));
+    }
+};
+
+template<>
+struct transcoder<utf8_encoding, latin1_encoding> {
+    static transcode_result transcode(
+        utf8_encoding::state_type &,
+        latin1_encoding::state_type &,
+        const char *in_first,
+        const char *in_last,
+        char *out_first,
+        char *out_last) noexcept
+    {
+        return utf8_to_latin1(
+            reinterpret_cast<const unsigned char*>(in_first),
+            reinterpret_cast<const unsigned char*>(in_last),
+            reinterpret_cast<unsigned char*>(out_first),
+            reinterpret_cast<unsigned char*>(out_last));
+    }
+
+    static transcode_result transcoded_length(
+        utf8_encoding::state_type &,
+        latin1_encoding::state_type &,
+        const char *in_first,
+        const char *in_last) noexcept
+    {
+        return utf8_to_latin1_length(
+            reinterpret_cast<const unsigned char*>(in_first),
+            reinterpret_cast<const unsigned char*>(in_last));
+    }
+};
+
+// UTF-16 and UTF-32 are transcoded with the bulk operations of the UTF-16
+// encodings.  Blocks of code units or code points that contain no surrogate
+// pairs are widened or narrowed by vectorized implementations selected at
+// run-time; surrogate pairs are handled one at a time.
+template<>
+struct transcoder<utf16_encoding, utf32_encoding> {
+    static transcode_result transcode(
+        utf16_encoding::state_type &,
+        utf32_encoding::state_type &,
+        const char16_t *in_first,
+        const char16_t *in_last,
+        char32_t *out_first,
+        char32_t *out_last) noexcept
+    {
+        return from_decode_n_result(utf16_encoding::decode_n(
+            in_first, in_last, out_first, out_last));
+    }
+
+    static transcode_result transcoded_length(
+        utf16_encoding::state_type &,
+        utf32_encoding::state_type &,
+        const char16_t *in_first,
+        const char16_t *in_last) noexcept
+    {
+        return from_decode_n_result(utf16_count_code_points(
+            in_first, in_last));
+    }
+};
+
+template<>
+struct transcoder<utf32_encoding, utf16_encoding> {
+    static transcode_result transcode(
+        utf32_encoding::state_type &,
+        utf16_encoding::state_type &,
+        const char32_t *in_first,
+        const char32_t *in_last,
+        char16_t *out_first,
+        char16_t *out_last) noexcept
+    {
+        return from_utf32_encode_n_result(utf16_encoding::encode_n(
+            in_first, in_last, out_first, out_last));
+    }
+
+    static transcode_result transcoded_length(
+        utf32_encoding::state_type &,
+        utf16_encoding::state_type &,
+        const char32_t *in_first,
+        const char32_t *in_last) noexcept
+    {
+        return from_utf32_encode_n_result(utf16_encoding::encoded_length(
+            in_first, in_last));
+    }
+};
+
+// Transcodes UTF-16BE or UTF-16LE to UTF-32.  The transcoded length is
+// measured by decoding to a temporary buffer a block at a time.
+template<TextEncoding FromET>
+struct utf16_byte_order_to_utf32_transcoder {
+    static transcode_result transcode(
+        typename FromET::state_type &,
+        utf32_encoding::state_type &,
+        const char *in_first,
+        const char *in_last,
+        char32_t *out_first,
+        char32_t *out_last) noexcept
+    {
+        return from_decode_n_result(FromET::decode_n(
+            in_first, in_last, out_first, out_last));
+    }
+
+    static transcode_result transcoded_length(
+        typename FromET::state_type &,
+        utf32_encoding::state_type &,
+        const char *in_first,
+        const char *in_last) noexcept
+    {
+        return from_decode_n_result(decoded_length_by_decode_n<FromET>(
+            in_first, in_last));
+    }
+};
+
+// Transcodes UTF-32 to UTF-16BE or UTF-16LE.  The encode_n() members of those
+// encodings accept code points above U+10FFFF, so dedicated kernels that
+// reject them as utf32_encoding::decode() does are used instead.
+template<TextEncoding ToET,
+         encode_n_result (*encode_n)(const char32_t*, const char32_t*,
+                                     unsigned char*, unsigned char*)>
+struct utf32_to_utf16_byte_order_transcoder {
+    static transcode_result transcode(
+        utf32_encoding::state_type &,
+        typename ToET::state_type &,
+        const char32_t *in_first,
+        const char32_t *in_last,
+        char *out_first,
+        char *out_last) noexcept
+    {
+        return from_utf32_encode_n_result(encode_n(
+            in_first,
+            in_last,
+            reinterpret_cast<unsigned char*>(out_first),
+            reinterpret_cast<unsigned char*>(out_last)));
+    }
+
+    static transcode_result transcoded_length(
+        utf32_encoding::state_type &,
+        typename ToET::state_type &,
+        const char32_t *in_first,
+        const char32_t *in_last) noexcept
+    {
+        encode_n_result r = utf16_encoded_length_strict(in_first, in_last);
+        r.code_units *= 2;
+        return from_utf32_encode_n_result(r);
+    }
+};
+
+template<>
+struct transcoder<utf16be_encoding, utf32_encoding>
+    : utf16_byte_order_to_utf32_transcoder<utf16be_encoding> {};
+
+template<>
+struct transcoder<utf16le_encoding, utf32_encoding>
+    : utf16_byte_order_to_utf32_transcoder<utf16le_encoding> {};
+
+template<>
+struct transcoder<utf32_encoding, utf16be_encoding>
+    : utf32_to_utf16_byte_order_transcoder<
+          utf16be_encoding, utf16be_encode_n_strict> {};
+
+template<>
+struct transcoder<utf32_encoding, utf16le_encoding>
+    : utf32_to_utf16_byte_order_transcoder<
+          utf16le_encoding, utf16le_encode_n_strict> {};
+
+// Transcodes between UTF-16 in any byte order and UTF-32BE or UTF-32LE by
+// decoding a block of code points at a time with the decode_n() member of
+// FromET into a temporary buffer and encoding them with the encode_n()
+// member of ToET, both of which are vectorized.  Errors are reported as the
+// decode() and encode() members of the encodings report them.  When not all
+// of the decoded code points are encoded, their code units are located by
+// decoding again into a buffer of the size of the encoded prefix.
+template<TextEncoding FromET, TextEncoding ToET>
+struct code_point_block_transcoder {
+    using from_code_unit_type = code_unit_type_t<FromET>;
+    using to_code_unit_type = code_unit_type_t<ToET>;
+    static constexpr int buffer_size = 256;
+
+    static transcode_result transcode(
+        typename FromET::state_type &,
+        typename ToET::state_type &,
+        const from_code_unit_type *in_first,
+        const from_code_unit_type *in_last,
+        to_code_unit_type *out_first,
+        to_code_unit_type *out_last) noexcept
+    {
+        char32_t buffer[buffer_size];
+        const from_code_unit_type *in_next = in_first;
+        to_code_unit_type *out_next = out_first;
+        for (;;) {
+            decode_n_result d = FromET::decode_n(
+                in_next, in_last, buffer, buffer + buffer_size);
+            encode_n_result e = ToET::encode_n(
+                buffer, buffer + d.code_points, out_next, out_last);
+            out_next += e.code_units;
+            if (e.code_points != d.code_points) {
+                in_next += FromET::decode_n(
+                    in_next, in_last, buffer, buffer + e.code_points)
+                        .code_units;
+                return { in_next - in_first,
+                         out_next - out_first,
+                         decode_status::no_error,
+                         e.status };
+            }
+            in_next += d.code_units;
+            if (d.status != decode_status::no_error || in_next == in_last) {
+                return { in_next - in_first,
+                         out_next - out_first,
+                         d.status,
+                         encode_status::no_error };
+            }
+        }
+    }
+
+    static transcode_result transcoded_length(
+        typename FromET::state_type &,
+        typename ToET::state_type &,
+        const from_code_unit_type *in_first,
+        const from_code_unit_type *in_last) noexcept
+    {
+        char32_t buffer[buffer_size];
+        const from_code_unit_type *in_next = in_first;
+        std::ptrdiff_t length = 0;
+        for (;;) {
+            decode_n_result d = FromET::decode_n(
+                in_next, in_last, buffer, buffer + buffer_size);
+            encode_n_result e = ToET::encoded_length(
+                buffer, buffer + d.code_points);
+            length += e.code_units;
+            if (e.code_points != d.code_points) {
+                in_next += FromET::decode_n(
+                    in_next, in_last, buffer, buffer + e.code_points)
+                        .code_units;
+                return { in_next - in_first, length,
+                         decode_status::no_error, e.status };
+            }
+            in_next += d.code_units;
+            if (d.status != decode_status::no_error || in_next == in_last) {
+                return { in_next - in_first, length,
+                         d.status, encode_status::no_error };
+            }
+        }
+    }
+};
+
+template<>
+struct transcoder<utf16_encoding, utf32be_encoding>
+    : code_point_block_transcoder<utf16_encoding, utf32be_encoding> {};
+
+template<>
+struct transcoder<utf16_encoding, utf32le_encoding>
+    : code_point_block_transcoder<utf16_encoding, utf32le_encoding> {};
+
+template<>
+struct transcoder<utf16be_encoding, utf32be_encoding>
+    : code_point_block_transcoder<utf16be_encoding, utf32be_encoding> {};
+
+template<>
+struct transcoder<utf16be_encoding, utf32le_encoding>
+    : code_point_block_transcoder<utf16be_encoding, utf32le_encoding> {};
+
+template<>
+struct transcoder<utf16le_encoding, utf32be_encoding>
+    : code_point_block_transcoder<utf16le_encoding, utf32be_encoding> {};
+
+template<>
+struct transcoder<utf16le_encoding, utf32le_encoding>
+    : code_point_block_transcoder<utf16le_encoding, utf32le_encoding> {};
+
+template<>
+struct transcoder<utf32be_encoding, utf16_encoding>
+    : code_point_block_transcoder<utf32be_encoding, utf16_encoding> {};
+
+template<>
+struct transcoder<utf32be_encoding, utf16be_encoding>
+    : code_point_block_transcoder<utf32be_encoding, utf16be_encoding> {};
+
+template<>
+struct transcoder<utf32be_encoding, utf16le_encoding>
+    : code_point_block_transcoder<utf32be_encoding, utf16le_encoding> {};
+
+template<>
+struct transcoder<utf32le_encoding, utf16_encoding>
+    : code_point_block_transcoder<utf32le_encoding, utf16_encoding> {};
+
+template<>
+struct transcoder<utf32le_encoding, utf16be_encoding>
+    : code_point_block_transcoder<utf32le_encoding, utf16be_encoding> {};
+
+template<>
+struct transcoder<utf32le_encoding, utf16le_encoding>
+    : code_point_block_transcoder<utf32le_encoding, utf16le_encoding> {};
+
+} // namespace text_detail
+
+
+/*
+ * transcode
+ * Transcodes the contiguous code unit sequence [in_first, in_last) encoded
+ * by FromET to the code unit buffer [out_first, out_last) using the encoding
+ * ToET.  Transcoding stops when the input is exhausted, when the output has
+ * insufficient space for the code units of the next character, or when an
+ * error is encountered.  As for decode_n(), a code unit sequence that cannot
+ * be transcoded is reported at its offset rather than skipped.
+ */
+// Overload that transcodes from and to explicitly specified encoding states.
+// The states are updated to reflect the code units consumed and written so
+// that transcoding may be resumed with subsequent calls.
+template<TextEncoding FromET, TextEncoding ToET>
+requires ranges::Same<character_type_t<FromET>, character_type_t<ToET>>
+transcode_result transcode(
+    typename FromET::state_type &from_state,
+    typename ToET::state_type &to_state,
+    const code_unit_type_t<FromET> *in_first,
+    const code_unit_type_t<FromET> *in_last,
+    code_unit_type_t<ToET> *out_first,
+    code_unit_type_t<ToET> *out_last)
+{
+    return text_detail::transcoder<FromET, ToET>::transcode(
+        from_state, to_state, in_first, in_last, out_first, out_last);
+}
+
+// Overload that transcodes from and to the initial encoding states.
+template<TextEncoding FromET, TextEncoding ToET>
+requires ranges::Same<character_type_t<FromET>, character_type_t<ToET>>
+transcode_result transcode(
+    const code_unit_type_t<FromET> *in_first,
+    const code_unit_type_t<FromET> *in_last,
+    code_unit_type_t<ToET> *out_first,
+    code_unit_type_t<ToET> *out_last)
+{
+    auto from_state = FromET::initial_state();
+    auto to_state = ToET::initial_state();
+    return text::transcode<FromET, ToET>(
+        from_state, to_state, in_first, in_last, out_first, out_last);
+}
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_TRANSCODE_HPP
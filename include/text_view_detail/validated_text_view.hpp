@@ -0,0 +1,348 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_VALIDATED_TEXT_VIEW_HPP // {
+#define TEXT_VIEW_VALIDATED_TEXT_VIEW_HPP
+
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <experimental/ranges/concepts>
+#include <experimental/ranges/iterator>
+#include <text_view_detail/adl_customization.hpp>
+#include <text_view_detail/bulk_result.hpp>
+#include <text_view_detail/code_point_count.hpp>
+#include <text_view_detail/concepts.hpp>
+#include <text_view_detail/encodings/fixed_width_encoding.hpp>
+#include <text_view_detail/error_policy.hpp>
+#include <text_view_detail/error_status.hpp>
+#include <text_view_detail/exceptions.hpp>
+#include <text_view_detail/itext_iterator.hpp>
+#include <text_view_detail/text_view.hpp>
+#include <text_view_detail/trivial_encoding_state.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+namespace text_detail {
+
+/*
+ * Contiguous bulk decoder concept.  Satisfied by stateless encodings that
+ * provide a decode_n() member for decoding contiguous code unit sequences,
+ * when used with views that hold pointers to such sequences.
+ */
+template<typename ET, typename VT>
+concept bool ContiguousBulkDecoder() {
+    return ContiguousCodeUnitView<ET, VT>()
+        && ranges::Same<typename ET::state_type, trivial_encoding_state>
+        && requires (const code_unit_type_t<ET> *p,
+                     code_point_type_t<
+                         character_set_type_t<character_type_t<ET>>> *o)
+           {
+               { ET::decode_n(p, p, o, o) } noexcept -> decode_n_result;
+           };
+}
+
+struct text_validator;
+
+} // namespace text_detail
+
+
+/*
+ * basic_validated_text_view
+ * A text view over a code unit sequence that was found to be well-formed by
+ * make_validated_text_view().  Iterators decode with the assume valid error
+ * policy, and so without validity checks where the encoding permits.  Facts
+ * gathered while validating are retained so that the number of characters,
+ * whether the text is limited to ASCII or to the Basic Multilingual Plane,
+ * and whether each character is encoded by a single code unit, are available
+ * without iterating the view again.
+ */
+template<TextEncoding ET, ranges::View VT>
+class basic_validated_text_view
+    : public basic_text_view<ET, VT, text_assume_valid_error_policy>
+{
+    using base_type = basic_text_view<ET, VT, text_assume_valid_error_policy>;
+    friend struct text_detail::text_validator;
+
+public:
+    using code_point_type =
+        code_point_type_t<character_set_type_t<character_type_t<ET>>>;
+    using difference_type =
+        ranges::difference_type_t<typename base_type::iterator>;
+
+    // The default constructor produces a validated text view with a singular
+    // range.  An object produced with this constructor may only be assigned
+    // to or destroyed.
+    basic_validated_text_view() = default;
+
+    // Returns the number of characters in the view.
+    difference_type size() const noexcept {
+        return count;
+    }
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+    // Returns the largest code point in the view, or 0 if it is empty.
+    code_point_type max_code_point() const noexcept {
+        return max_cp;
+    }
+
+    // Returns true if each code point in the view is below U+0080.
+    bool is_ascii() const noexcept {
+        return max_cp < 0x80;
+    }
+
+    // Returns true if each code point in the view is below U+10000.
+    bool is_bmp() const noexcept {
+        return max_cp < 0x10000;
+    }
+
+    // Returns true if each character in the view is encoded by a single code
+    // unit, and no code unit sequence encodes only a state transition.
+    bool is_fixed_width() const noexcept {
+        return count == code_units;
+    }
+
+private:
+    basic_validated_text_view(
+        base_type tv,
+        difference_type count,
+        difference_type code_units,
+        code_point_type max_cp)
+    :
+        base_type{std::move(tv)},
+        count{count},
+        code_units{code_units},
+        max_cp{max_cp}
+    {}
+
+    difference_type count = 0;
+    difference_type code_units = 0;
+    code_point_type max_cp = 0;
+};
+
+
+namespace text_detail {
+
+/*
+ * Validates the code unit sequence of a text view, throwing text_decode_error
+ * if it is ill-formed, and constructs a validated text view that holds the
+ * facts gathered along the way.
+ */
+struct text_validator {
+    template<TextView TVT>
+    using validated_type = basic_validated_text_view<
+        encoding_type_t<TVT>, typename TVT::view_type>;
+
+    // Overload for views of contiguous code units with a stateless encoding
+    // that provides decode_n().
+    template<TextView TVT>
+    requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+          && ContiguousBulkDecoder<
+                 encoding_type_t<TVT>, typename TVT::view_type>()
+    static validated_type<TVT> validate(const TVT &tv) {
+        using ET = encoding_type_t<TVT>;
+        return validate_by_block(tv, [](
+            const code_unit_type_t<ET> *in_first,
+            const code_unit_type_t<ET> *in_last,
+            typename validated_type<TVT>::code_point_type *out_first,
+            typename validated_type<TVT>::code_point_type *out_last)
+        noexcept
+        {
+            return ET::decode_n(in_first, in_last, out_first, out_last);
+        });
+    }
+
+    // Overload for views of contiguous code units with a stateful encoding
+    // that provides decode_n(), such as the BOM encodings.  The state is
+    // carried from one block to the next, so the byte order mark is resolved
+    // once and the remaining blocks are decoded by the codec for the resolved
+    // byte order.
+    template<TextView TVT>
+    requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+          && StatefulContiguousBulkDecoder<
+                 encoding_type_t<TVT>, typename TVT::view_type>()
+    static validated_type<TVT> validate(const TVT &tv) {
+        using ET = encoding_type_t<TVT>;
+        typename ET::state_type state{tv.initial_state()};
+        return validate_by_block(tv, [&state](
+            const code_unit_type_t<ET> *in_first,
+            const code_unit_type_t<ET> *in_last,
+            typename validated_type<TVT>::code_point_type *out_first,
+            typename validated_type<TVT>::code_point_type *out_last)
+        noexcept
+        {
+            return ET::decode_n(
+                state, in_first, in_last, out_first, out_last);
+        });
+    }
+
+    // Overload for views of forward code unit iterators.  The decode() member
+    // of the encoding is called directly, without the bookkeeping performed
+    // by the view's iterator.
+    template<TextView TVT>
+    requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+    static validated_type<TVT> validate(const TVT &tv) {
+        using ET = encoding_type_t<TVT>;
+        using code_point_type =
+            typename validated_type<TVT>::code_point_type;
+        typename ET::state_type state{tv.initial_state()};
+        auto in_next = adl_begin(tv.base());
+        auto in_last = adl_end(tv.base());
+        typename validated_type<TVT>::difference_type count = 0;
+        typename validated_type<TVT>::difference_type code_units = 0;
+        code_point_type max_cp = 0;
+        while (in_next != in_last) {
+            character_type_t<ET> c;
+            int decoded_code_units = 0;
+            decode_status ds = ET::decode(
+                state, in_next, in_last, c, decoded_code_units);
+            if (text::error_occurred(ds)) {
+                throw text_decode_error{ds};
+            }
+            code_units += decoded_code_units;
+            if (ds == decode_status::no_error) {
+                max_cp = std::max(max_cp, code_point_type(c.get_code_point()));
+                ++count;
+            }
+        }
+        return make(tv, count, code_units, max_cp);
+    }
+
+    // Validates the contiguous code units of a view by decoding them a block
+    // at a time with decode_block, which has the signature of a stateless
+    // decode_n() member.  The code points of each block are scanned for the
+    // largest.
+    template<TextView TVT, typename DecodeBlock>
+    static validated_type<TVT> validate_by_block(
+        const TVT &tv,
+        DecodeBlock decode_block)
+    {
+        using ET = encoding_type_t<TVT>;
+        using code_point_type =
+            typename validated_type<TVT>::code_point_type;
+        constexpr int buffer_size = 256;
+        code_point_type buffer[buffer_size];
+        const code_unit_type_t<ET> *in_first = adl_begin(tv.base());
+        const code_unit_type_t<ET> *in_next = in_first;
+        const code_unit_type_t<ET> *in_last = adl_end(tv.base());
+        typename validated_type<TVT>::difference_type count = 0;
+        code_point_type max_cp = 0;
+        while (in_next != in_last) {
+            decode_n_result r = decode_block(
+                in_next, in_last, buffer, buffer + buffer_size);
+            for (std::ptrdiff_t i = 0; i != r.code_points; ++i) {
+                max_cp = std::max(max_cp, buffer[i]);
+            }
+            in_next += r.code_units;
+            count += r.code_points;
+            if (r.status != decode_status::no_error) {
+                throw text_decode_error{r.status};
+            }
+        }
+        return make(tv, count, in_last - in_first, max_cp);
+    }
+
+    template<TextView TVT>
+    static validated_type<TVT> make(
+        const TVT &tv,
+        typename validated_type<TVT>::difference_type count,
+        typename validated_type<TVT>::difference_type code_units,
+        typename validated_type<TVT>::code_point_type max_cp)
+    {
+        using base_type = basic_text_view<
+            encoding_type_t<TVT>,
+            typename TVT::view_type,
+            text_assume_valid_error_policy>;
+        return { base_type{tv.initial_state(), tv.base()},
+                 count, code_units, max_cp };
+    }
+};
+
+} // namespace text_detail
+
+
+/*
+ * make_validated_text_view
+ * Validates the code unit sequence of a text view in a single pass and
+ * returns a basic_validated_text_view over the same code units, with the same
+ * initial encoding state.  A text_decode_error exception is thrown if the
+ * code unit sequence is ill-formed, regardless of the error policy of the
+ * view.
+ */
+template<TextView TVT>
+requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+basic_validated_text_view<encoding_type_t<TVT>, typename TVT::view_type>
+make_validated_text_view(const TVT &tv)
+{
+    return text_detail::text_validator::validate(tv);
+}
+
+
+/*
+ * make_fixed_width_text_view
+ * Returns a text view of the fixed width encoding for the encoding of a
+ * validated text view over the same code units.  Iterators of the returned
+ * view are random access iterators when the code unit iterators of the view
+ * are; advancing them and computing the distance between them take constant
+ * time.  A text_decode_error exception is thrown if a character of the view
+ * is encoded by more than one code unit.
+ */
+template<TextEncoding ET, ranges::View VT>
+requires std::is_empty<typename ET::state_type>::value
+basic_text_view<fixed_width_encoding<ET>, VT, text_assume_valid_error_policy>
+make_fixed_width_text_view(const basic_validated_text_view<ET, VT> &tv)
+{
+    if (! tv.is_fixed_width()) {
+        throw text_decode_error{decode_status::invalid_code_unit_sequence};
+    }
+    return basic_text_view<
+        fixed_width_encoding<ET>, VT, text_assume_valid_error_policy>{
+        tv.base()};
+}
+
+// Overload for text views that have not been validated.  The view is
+// validated first.
+template<TextView TVT>
+requires ranges::ForwardIterator<typename TVT::code_unit_iterator>
+      && std::is_empty<typename encoding_type_t<TVT>::state_type>::value
+basic_text_view<
+    fixed_width_encoding<encoding_type_t<TVT>>,
+    typename TVT::view_type,
+    text_assume_valid_error_policy>
+make_fixed_width_text_view(const TVT &tv)
+{
+    return make_fixed_width_text_view(make_validated_text_view(tv));
+}
+
+
+/*
+ * code_point_count
+ * Overload for validated text views; the count recorded during validation is
+ * returned.
+ */
+template<TextEncoding ET, ranges::View VT>
+ranges::difference_type_t<
+    ranges::iterator_t<const basic_validated_text_view<ET, VT>>>
+code_point_count(const basic_validated_text_view<ET, VT> &tv) noexcept
+{
+    return tv.size();
+}
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
+
+
+#endif // } TEXT_VIEW_VALIDATED_TEXT_VIEW_HPP
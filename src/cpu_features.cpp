@@ -0,0 +1,76 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#include <text_view_detail/cpu_features.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+namespace {
+
+#if defined(__x86_64__) || defined(__i386__)
+// Returns the contents of the XCR0 register that indicates which register
+// states the operating system saves and restores on context switches.
+unsigned long long read_xcr0() noexcept {
+    unsigned int eax, edx;
+    __asm__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+}
+#endif
+
+cpu_features probe_cpu_features() noexcept {
+    cpu_features features{};
+
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (! __get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return features;
+    }
+    features.sse2 = edx & bit_SSE2;
+    features.ssse3 = ecx & bit_SSSE3;
+    features.sse4_2 = (ecx & bit_SSE4_1) && (ecx & bit_SSE4_2);
+
+    // AVX state must be enabled by the operating system before AVX2 or
+    // AVX-512 instructions may be used.
+    if (! (ecx & bit_OSXSAVE)) {
+        return features;
+    }
+    unsigned long long xcr0 = read_xcr0();
+    bool os_avx = (xcr0 & 0x06) == 0x06;
+    bool os_avx512 = (xcr0 & 0xE6) == 0xE6;
+
+    if (! __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return features;
+    }
+    features.avx2 = os_avx && (ebx & bit_AVX2);
+    features.avx512bw =
+        os_avx512 && (ebx & bit_AVX512F) && (ebx & bit_AVX512BW);
+#endif
+
+    return features;
+}
+
+} // unnamed namespace
+
+
+const cpu_features& get_cpu_features() noexcept {
+    static const cpu_features features = probe_cpu_features();
+    return features;
+}
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
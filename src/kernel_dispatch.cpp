@@ -0,0 +1,103 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <text_view_detail/cpu_features.hpp>
+#include <text_view_detail/kernel_dispatch.hpp>
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+
+
+namespace {
+
+// Returns the level named by the TEXT_VIEW_SIMD_LEVEL environment variable,
+// or the highest level if it is not set or does not name a level.
+simd_level initial_simd_level_limit() noexcept {
+    static const struct {
+        const char *name;
+        simd_level level;
+    } levels[] = {
+        { "scalar", simd_level::scalar },
+        { "sse2", simd_level::sse2 },
+        { "ssse3", simd_level::ssse3 },
+        { "sse4_2", simd_level::sse4_2 },
+        { "avx2", simd_level::avx2 },
+        { "avx512bw", simd_level::avx512bw },
+    };
+    const char *value = std::getenv("TEXT_VIEW_SIMD_LEVEL");
+    if (value) {
+        for (const auto &l : levels) {
+            if (std::strcmp(value, l.name) == 0) {
+                return l.level;
+            }
+        }
+    }
+    return simd_level::avx512bw;
+}
+
+std::atomic<simd_level>& simd_level_limit() noexcept {
+    static std::atomic<simd_level> limit{initial_simd_level_limit()};
+    return limit;
+}
+
+std::atomic<unsigned int> dispatch_generation{1};
+
+bool simd_level_supported(simd_level level) noexcept {
+    const text_detail::cpu_features &features =
+        text_detail::get_cpu_features();
+    switch (level) {
+        case simd_level::scalar:   return true;
+        case simd_level::sse2:     return features.sse2;
+        case simd_level::ssse3:    return features.ssse3;
+        case simd_level::sse4_2:   return features.sse4_2;
+        case simd_level::avx2:     return features.avx2;
+        case simd_level::avx512bw: return features.avx512bw;
+    }
+    return false;
+}
+
+} // unnamed namespace
+
+
+void set_simd_level_limit(simd_level level) noexcept {
+    simd_level_limit().store(level);
+    ++dispatch_generation;
+}
+
+simd_level get_simd_level_limit() noexcept {
+    return simd_level_limit().load();
+}
+
+simd_level get_simd_level() noexcept {
+    int level = static_cast<int>(get_simd_level_limit());
+    while (! simd_level_supported(static_cast<simd_level>(level))) {
+        --level;
+    }
+    return static_cast<simd_level>(level);
+}
+
+
+namespace text_detail {
+
+bool simd_level_enabled(simd_level level) noexcept {
+    return level <= get_simd_level_limit() && simd_level_supported(level);
+}
+
+unsigned int simd_dispatch_generation() noexcept {
+    return dispatch_generation.load(std::memory_order_acquire);
+}
+
+} // namespace text_detail
+
+
+} // inline namespace text
+} // namespace experimental
+} // namespace std
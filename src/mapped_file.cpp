@@ -0,0 +1,103 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#include <cerrno>
+#include <system_error>
+#include <text_view_detail/mapped_file.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+#if defined(__unix__) || defined(__APPLE__)
+
+namespace {
+
+[[noreturn]] void throw_errno(const char *what) {
+    throw std::system_error{errno, std::generic_category(), what};
+}
+
+int to_madvise_advice(mapped_file_advice advice) noexcept {
+    switch (advice) {
+    case mapped_file_advice::sequential:
+        return MADV_SEQUENTIAL;
+    case mapped_file_advice::random:
+        return MADV_RANDOM;
+    case mapped_file_advice::normal:
+        break;
+    }
+    return MADV_NORMAL;
+}
+
+// Closes a file descriptor when destroyed; the mapping of a file remains
+// valid after its descriptor is closed.
+struct file_descriptor {
+    ~file_descriptor() {
+        if (fd != -1) {
+            ::close(fd);
+        }
+    }
+
+    int fd;
+};
+
+} // unnamed namespace
+
+mapped_region map_file(const char *path, mapped_file_advice advice) {
+    file_descriptor file{::open(path, O_RDONLY | O_CLOEXEC)};
+    if (file.fd == -1) {
+        throw_errno("open");
+    }
+    struct stat st;
+    if (::fstat(file.fd, &st) == -1) {
+        throw_errno("fstat");
+    }
+    std::size_t size = st.st_size;
+    if (size == 0) {
+        return { nullptr, 0 };
+    }
+    void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+    if (data == MAP_FAILED) {
+        throw_errno("mmap");
+    }
+    // The advice only affects performance, so failure to apply it is
+    // ignored.
+    ::madvise(data, size, to_madvise_advice(advice));
+    return { data, size };
+}
+
+void unmap_file(const mapped_region &region) noexcept {
+    if (region.data) {
+        ::munmap(const_cast<void*>(region.data), region.size);
+    }
+}
+
+#else
+
+mapped_region map_file(const char *, mapped_file_advice) {
+    throw std::system_error{
+        std::make_error_code(std::errc::function_not_supported), "mmap"};
+}
+
+void unmap_file(const mapped_region &) noexcept {}
+
+#endif
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
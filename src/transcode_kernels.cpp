@@ -0,0 +1,1070 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#include <algorithm>
+#include <cstddef>
+#include <text_view_detail/character_set_info.hpp>
+#include <text_view_detail/character.hpp>
+#include <text_view_detail/charsets/unicode_charsets.hpp>
+#include <text_view_detail/codecs/transcode_kernels.hpp>
+#include <text_view_detail/codecs/utf16_kernels.hpp>
+#include <text_view_detail/codecs/utf8_codec.hpp>
+#include <text_view_detail/codecs/utf8_kernels.hpp>
+#include <text_view_detail/kernel_dispatch.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+namespace {
+
+using scalar_utf8_codec =
+    utf8_codec<character<unicode_character_set>, unsigned char>;
+
+// Transcodes at most max_code_points code points from UTF-8 to UTF-16.  Code
+// points are decoded a block at a time with decode_n() and then encoded; the
+// number decoded is limited so that their code units are known to fit in the
+// output.
+transcode_result utf8_to_utf16_scalar_n(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char16_t *out_first,
+    char16_t *out_last,
+    std::ptrdiff_t max_code_points) noexcept
+{
+    constexpr std::ptrdiff_t buffer_size = 256;
+    char32_t buffer[buffer_size];
+    const unsigned char *in_next = in_first;
+    char16_t *out_next = out_first;
+    while (in_next != in_last && max_code_points > 0) {
+        // Each code point is encoded as at most two code units.  If there is
+        // only room for one, a single code point is decoded and discarded if
+        // it requires two.
+        std::ptrdiff_t out_space = out_last - out_next;
+        std::ptrdiff_t limit = std::min(
+            { buffer_size, max_code_points, out_space / 2 });
+        if (limit == 0) {
+            if (out_space == 0) {
+                break;
+            }
+            limit = 1;
+        }
+        decode_n_result r = scalar_utf8_codec::decode_n(
+            in_next, in_last, buffer, buffer + limit);
+        for (std::ptrdiff_t i = 0; i < r.code_points; ++i) {
+            char32_t cp = buffer[i];
+            if (cp <= 0xFFFF) {
+                *out_next++ = char16_t(cp);
+            } else if (out_last - out_next >= 2) {
+                *out_next++ = char16_t(0xD800 + ((cp - 0x10000) >> 10));
+                *out_next++ = char16_t(0xDC00 + ((cp - 0x10000) & 0x03FF));
+            } else {
+                return { in_next - in_first,
+                         out_next - out_first,
+                         decode_status::no_error,
+                         encode_status::no_error };
+            }
+        }
+        in_next += r.code_units;
+        max_code_points -= r.code_points;
+        if (r.status != decode_status::no_error) {
+            return { in_next - in_first,
+                     out_next - out_first,
+                     r.status,
+                     encode_status::no_error };
+        }
+    }
+    return { in_next - in_first,
+             out_next - out_first,
+             decode_status::no_error,
+             encode_status::no_error };
+}
+
+// Transcodes at most max_code_points code points from UTF-16 to UTF-8.  The
+// checks correspond to those performed by utf16_codec::decode().
+transcode_result utf16_to_utf8_scalar_n(
+    const char16_t *in_first,
+    const char16_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last,
+    std::ptrdiff_t max_code_points) noexcept
+{
+    const char16_t *in_next = in_first;
+    unsigned char *out_next = out_first;
+    decode_status ds = decode_status::no_error;
+    for (; in_next != in_last && max_code_points > 0; --max_code_points) {
+        char32_t cu1 = *in_next;
+        std::ptrdiff_t out_space = out_last - out_next;
+        if (cu1 <= 0x7F) {
+            if (out_space < 1) {
+                break;
+            }
+            *out_next++ = static_cast<unsigned char>(cu1);
+            in_next += 1;
+        } else if (cu1 <= 0x07FF) {
+            if (out_space < 2) {
+                break;
+            }
+            *out_next++ = static_cast<unsigned char>(0xC0 + (cu1 >> 6));
+            *out_next++ = static_cast<unsigned char>(0x80 + (cu1 & 0x3F));
+            in_next += 1;
+        } else if (cu1 < 0xD800 || cu1 >= 0xE000) {
+            if (out_space < 3) {
+                break;
+            }
+            *out_next++ = static_cast<unsigned char>(0xE0 + (cu1 >> 12));
+            *out_next++ =
+                static_cast<unsigned char>(0x80 + ((cu1 >> 6) & 0x3F));
+            *out_next++ = static_cast<unsigned char>(0x80 + (cu1 & 0x3F));
+            in_next += 1;
+        } else if (cu1 >= 0xDC00) {
+            ds = decode_status::invalid_code_unit_sequence;
+            break;
+        } else {
+            if (in_last - in_next < 2) {
+                ds = decode_status::underflow;
+                break;
+            }
+            char32_t cu2 = in_next[1];
+            if (cu2 < 0xDC00 || cu2 > 0xDFFF) {
+                ds = decode_status::invalid_code_unit_sequence;
+                break;
+            }
+            if (out_space < 4) {
+                break;
+            }
+            char32_t cp = 0x10000 + (((cu1 & 0x3FF) << 10) | (cu2 & 0x3FF));
+            *out_next++ = static_cast<unsigned char>(0xF0 + (cp >> 18));
+            *out_next++ =
+                static_cast<unsigned char>(0x80 + ((cp >> 12) & 0x3F));
+            *out_next++ =
+                static_cast<unsigned char>(0x80 + ((cp >> 6) & 0x3F));
+            *out_next++ = static_cast<unsigned char>(0x80 + (cp & 0x3F));
+            in_next += 2;
+        }
+    }
+    return { in_next - in_first,
+             out_next - out_first,
+             ds,
+             encode_status::no_error };
+}
+
+// Transcodes at most max_code_units code units from Latin-1 to UTF-8.
+transcode_result latin1_to_utf8_scalar_n(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last,
+    std::ptrdiff_t max_code_units) noexcept
+{
+    const unsigned char *in_next = in_first;
+    unsigned char *out_next = out_first;
+    for (; in_next != in_last && max_code_units > 0; --max_code_units) {
+        unsigned char cu = *in_next;
+        if (cu <= 0x7F) {
+            if (out_next == out_last) {
+                break;
+            }
+            *out_next++ = cu;
+        } else {
+            if (out_last - out_next < 2) {
+                break;
+            }
+            *out_next++ = static_cast<unsigned char>(0xC0 + (cu >> 6));
+            *out_next++ = static_cast<unsigned char>(0x80 + (cu & 0x3F));
+        }
+        ++in_next;
+    }
+    return { in_next - in_first,
+             out_next - out_first,
+             decode_status::no_error,
+             encode_status::no_error };
+}
+
+// Transcodes at most max_code_points code points from UTF-8 to Latin-1.  Code
+// points below U+0100 are transcoded directly; any other code unit sequence
+// is decoded with utf8_codec::decode() to determine whether it is ill-formed
+// or encodes a character that Latin-1 cannot encode.
+transcode_result utf8_to_latin1_scalar_n(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last,
+    std::ptrdiff_t max_code_points) noexcept
+{
+    const unsigned char *in_next = in_first;
+    unsigned char *out_next = out_first;
+    for (; in_next != in_last && max_code_points > 0; --max_code_points) {
+        if (out_next == out_last) {
+            break;
+        }
+        unsigned char cu1 = *in_next;
+        if (cu1 <= 0x7F) {
+            *out_next++ = cu1;
+            in_next += 1;
+        } else if ((cu1 & 0xFE) == 0xC2 &&
+                   in_last - in_next >= 2 &&
+                   (in_next[1] & 0xC0) == 0x80)
+        {
+            *out_next++ = static_cast<unsigned char>(
+                ((cu1 & 0x03) << 6) | (in_next[1] & 0x3F));
+            in_next += 2;
+        } else {
+            scalar_utf8_codec::state_type state{};
+            const unsigned char *tmp_next = in_next;
+            character<unicode_character_set> c;
+            int decoded_code_units = 0;
+            decode_status ds = scalar_utf8_codec::decode(
+                state, tmp_next, in_last, c, decoded_code_units);
+            return { in_next - in_first,
+                     out_next - out_first,
+                     error_occurred(ds) ? ds : decode_status::no_error,
+                     error_occurred(ds) ? encode_status::no_error
+                                        : encode_status::invalid_character };
+        }
+    }
+    return { in_next - in_first,
+             out_next - out_first,
+             decode_status::no_error,
+             encode_status::no_error };
+}
+
+// Adds the result of a transcoding step to the running totals in 'result'.
+// Returns true if transcoding should continue; that is, if the step made
+// progress without encountering an error and input remains.
+bool accumulate_step(
+    transcode_result &result,
+    const transcode_result &step,
+    std::ptrdiff_t remaining_input) noexcept
+{
+    result.input_code_units += step.input_code_units;
+    result.output_code_units += step.output_code_units;
+    result.input_status = step.input_status;
+    result.output_status = step.output_status;
+    return step.input_status == decode_status::no_error
+        && step.output_status == encode_status::no_error
+        && step.input_code_units != 0
+        && step.input_code_units != remaining_input;
+}
+
+transcode_result utf8_to_utf16_scalar(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char16_t *out_first,
+    char16_t *out_last) noexcept
+{
+    return utf8_to_utf16_scalar_n(
+        in_first, in_last, out_first, out_last, in_last - in_first);
+}
+
+transcode_result utf16_to_utf8_scalar(
+    const char16_t *in_first,
+    const char16_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return utf16_to_utf8_scalar_n(
+        in_first, in_last, out_first, out_last, in_last - in_first);
+}
+
+transcode_result latin1_to_utf8_scalar(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return latin1_to_utf8_scalar_n(
+        in_first, in_last, out_first, out_last, in_last - in_first);
+}
+
+transcode_result utf8_to_latin1_scalar(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return utf8_to_latin1_scalar_n(
+        in_first, in_last, out_first, out_last, in_last - in_first);
+}
+
+
+// The length measurements first find the longest well-formed prefix of the
+// input with the validating routines of the source encoding and then count
+// the code units that the prefix transcodes to.  The counting routines below
+// assume well-formed input.
+
+// Returns the number of UTF-16 code units that the well-formed UTF-8 code
+// unit sequence [first, last) transcodes to; one for each leading code unit
+// and one more for each leading code unit of a 4 code unit sequence.
+std::ptrdiff_t utf16_length_of_utf8_scalar(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    std::ptrdiff_t length = 0;
+    for (; first != last; ++first) {
+        length += (*first & 0xC0) != 0x80;
+        length += *first >= 0xF0;
+    }
+    return length;
+}
+
+// Returns the number of UTF-8 code units that the well-formed UTF-16 code
+// unit sequence [first, last) transcodes to.  Each code unit of a surrogate
+// pair counts for two of the four UTF-8 code units of the pair.
+std::ptrdiff_t utf8_length_of_utf16_scalar(
+    const char16_t *first,
+    const char16_t *last) noexcept
+{
+    std::ptrdiff_t length = 0;
+    for (; first != last; ++first) {
+        char16_t cu = *first;
+        length += 1;
+        length += cu >= 0x80;
+        length += cu >= 0x800 && (cu < 0xD800 || cu >= 0xE000);
+    }
+    return length;
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// The vectorized transcoders convert blocks of ASCII code units by widening
+// or narrowing them.  When a block contains other code units, a bounded
+// number of code points are transcoded by the scalar implementation before
+// another block is attempted.  This keeps error detection and reporting
+// entirely within the scalar implementation.
+constexpr std::ptrdiff_t scalar_step_code_points = 16;
+
+__attribute__((target("sse2")))
+transcode_result utf8_to_utf16_sse2(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char16_t *out_first,
+    char16_t *out_last) noexcept
+{
+    transcode_result result{
+        0, 0, decode_status::no_error, encode_status::no_error };
+    for (;;) {
+        const unsigned char *in_next = in_first + result.input_code_units;
+        char16_t *out_next = out_first + result.output_code_units;
+        const __m128i zero = _mm_setzero_si128();
+        while (in_last - in_next >= 16 && out_last - out_next >= 16) {
+            __m128i input =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(in_next));
+            if (_mm_movemask_epi8(input) != 0) {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out_next),
+                             _mm_unpacklo_epi8(input, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out_next + 8),
+                             _mm_unpackhi_epi8(input, zero));
+            in_next += 16;
+            out_next += 16;
+        }
+        result.input_code_units = in_next - in_first;
+        result.output_code_units = out_next - out_first;
+        transcode_result step = utf8_to_utf16_scalar_n(
+            in_next, in_last, out_next, out_last, scalar_step_code_points);
+        if (! accumulate_step(result, step, in_last - in_next)) {
+            return result;
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+transcode_result utf8_to_utf16_avx2(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char16_t *out_first,
+    char16_t *out_last) noexcept
+{
+    transcode_result result{
+        0, 0, decode_status::no_error, encode_status::no_error };
+    for (;;) {
+        const unsigned char *in_next = in_first + result.input_code_units;
+        char16_t *out_next = out_first + result.output_code_units;
+        while (in_last - in_next >= 32 && out_last - out_next >= 32) {
+            __m256i input = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(in_next));
+            if (_mm256_movemask_epi8(input) != 0) {
+                break;
+            }
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i*>(out_next),
+                _mm256_cvtepu8_epi16(_mm256_castsi256_si128(input)));
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i*>(out_next + 16),
+                _mm256_cvtepu8_epi16(_mm256_extracti128_si256(input, 1)));
+            in_next += 32;
+            out_next += 32;
+        }
+        result.input_code_units = in_next - in_first;
+        result.output_code_units = out_next - out_first;
+        transcode_result step = utf8_to_utf16_scalar_n(
+            in_next, in_last, out_next, out_last, scalar_step_code_points);
+        if (! accumulate_step(result, step, in_last - in_next)) {
+            return result;
+        }
+    }
+}
+
+__attribute__((target("sse2")))
+transcode_result utf16_to_utf8_sse2(
+    const char16_t *in_first,
+    const char16_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    transcode_result result{
+        0, 0, decode_status::no_error, encode_status::no_error };
+    for (;;) {
+        const char16_t *in_next = in_first + result.input_code_units;
+        unsigned char *out_next = out_first + result.output_code_units;
+        const __m128i non_ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+        while (in_last - in_next >= 16 && out_last - out_next >= 16) {
+            __m128i input1 =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(in_next));
+            __m128i input2 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(in_next + 8));
+            __m128i high_bits = _mm_and_si128(
+                _mm_or_si128(input1, input2), non_ascii);
+            if (_mm_movemask_epi8(
+                    _mm_cmpeq_epi16(high_bits, _mm_setzero_si128())) != 0xFFFF)
+            {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out_next),
+                             _mm_packus_epi16(input1, input2));
+            in_next += 16;
+            out_next += 16;
+        }
+        result.input_code_units = in_next - in_first;
+        result.output_code_units = out_next - out_first;
+        transcode_result step = utf16_to_utf8_scalar_n(
+            in_next, in_last, out_next, out_last, scalar_step_code_points);
+        if (! accumulate_step(result, step, in_last - in_next)) {
+            return result;
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+transcode_result utf16_to_utf8_avx2(
+    const char16_t *in_first,
+    const char16_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    transcode_result result{
+        0, 0, decode_status::no_error, encode_status::no_error };
+    for (;;) {
+        const char16_t *in_next = in_first + result.input_code_units;
+        unsigned char *out_next = out_first + result.output_code_units;
+        const __m256i non_ascii =
+            _mm256_set1_epi16(static_cast<short>(0xFF80));
+        while (in_last - in_next >= 32 && out_last - out_next >= 32) {
+            __m256i input1 = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(in_next));
+            __m256i input2 = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(in_next + 16));
+            __m256i high_bits = _mm256_and_si256(
+                _mm256_or_si256(input1, input2), non_ascii);
+            if (! _mm256_testz_si256(high_bits, high_bits)) {
+                break;
+            }
+            // Packing operates within 128-bit lanes; the permutation restores
+            // the order of the code units.
+            __m256i packed = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(input1, input2), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out_next), packed);
+            in_next += 32;
+            out_next += 32;
+        }
+        result.input_code_units = in_next - in_first;
+        result.output_code_units = out_next - out_first;
+        transcode_result step = utf16_to_utf8_scalar_n(
+            in_next, in_last, out_next, out_last, scalar_step_code_points);
+        if (! accumulate_step(result, step, in_last - in_next)) {
+            return result;
+        }
+    }
+}
+
+__attribute__((target("sse2")))
+std::ptrdiff_t utf16_length_of_utf8_sse2(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    // Leading code units are those that, as signed values, are greater than
+    // the largest trailing code unit (0xBF); leading code units of 4 code
+    // unit sequences are those that are unchanged by an unsigned maximum with
+    // 0xF0.  Byte counters are subtracted from for each match and flushed
+    // before they can overflow.
+    const __m128i max_trailing = _mm_set1_epi8(static_cast<char>(0xBF));
+    const __m128i min_four = _mm_set1_epi8(static_cast<char>(0xF0));
+    const __m128i zero = _mm_setzero_si128();
+    std::ptrdiff_t length = 0;
+    while (last - first >= 16) {
+        __m128i counts = zero;
+        for (int i = 0; i < 127 && last - first >= 16; ++i, first += 16) {
+            __m128i input =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            counts = _mm_sub_epi8(counts, _mm_cmpgt_epi8(input, max_trailing));
+            counts = _mm_sub_epi8(
+                counts,
+                _mm_cmpeq_epi8(_mm_max_epu8(input, min_four), input));
+        }
+        __m128i sums = _mm_sad_epu8(counts, zero);
+        length += _mm_cvtsi128_si32(sums) +
+                  _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    }
+    return length + utf16_length_of_utf8_scalar(first, last);
+}
+
+__attribute__((target("avx2")))
+std::ptrdiff_t utf16_length_of_utf8_avx2(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    const __m256i max_trailing = _mm256_set1_epi8(static_cast<char>(0xBF));
+    const __m256i min_four = _mm256_set1_epi8(static_cast<char>(0xF0));
+    const __m256i zero = _mm256_setzero_si256();
+    std::ptrdiff_t length = 0;
+    while (last - first >= 32) {
+        __m256i counts = zero;
+        for (int i = 0; i < 127 && last - first >= 32; ++i, first += 32) {
+            __m256i input =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            counts = _mm256_sub_epi8(
+                counts, _mm256_cmpgt_epi8(input, max_trailing));
+            counts = _mm256_sub_epi8(
+                counts,
+                _mm256_cmpeq_epi8(_mm256_max_epu8(input, min_four), input));
+        }
+        __m256i sums = _mm256_sad_epu8(counts, zero);
+        __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums),
+                                     _mm256_extracti128_si256(sums, 1));
+        length += _mm_cvtsi128_si32(half) +
+                  _mm_cvtsi128_si32(_mm_srli_si128(half, 8));
+    }
+    return length + utf16_length_of_utf8_scalar(first, last);
+}
+
+__attribute__((target("sse2")))
+std::ptrdiff_t utf8_length_of_utf16_sse2(
+    const char16_t *first,
+    const char16_t *last) noexcept
+{
+    // Code units are compared as signed values after their sign bits are
+    // flipped.  Each code unit counts for one code unit, one more if it is
+    // at least 0x80, and one more if it is at least 0x800 and not a
+    // surrogate.  16-bit counters are flushed before they can overflow.
+    const __m128i sign = _mm_set1_epi16(static_cast<short>(0x8000));
+    const __m128i max_one = _mm_set1_epi16(static_cast<short>(0x807F));
+    const __m128i max_two = _mm_set1_epi16(static_cast<short>(0x87FF));
+    const __m128i surrogate_mask = _mm_set1_epi16(static_cast<short>(0xF800));
+    const __m128i surrogate = _mm_set1_epi16(static_cast<short>(0xD800));
+    const __m128i ones = _mm_set1_epi16(1);
+    std::ptrdiff_t length = 0;
+    while (last - first >= 8) {
+        __m128i counts = _mm_setzero_si128();
+        for (int i = 0; i < 16383 && last - first >= 8; ++i, first += 8) {
+            __m128i input =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            __m128i flipped = _mm_xor_si128(input, sign);
+            __m128i is_surrogate = _mm_cmpeq_epi16(
+                _mm_and_si128(input, surrogate_mask), surrogate);
+            counts = _mm_sub_epi16(counts, _mm_cmpgt_epi16(flipped, max_one));
+            counts = _mm_sub_epi16(
+                counts,
+                _mm_andnot_si128(
+                    is_surrogate, _mm_cmpgt_epi16(flipped, max_two)));
+            length += 8;
+        }
+        __m128i sums = _mm_madd_epi16(counts, ones);
+        sums = _mm_add_epi32(sums, _mm_srli_si128(sums, 8));
+        sums = _mm_add_epi32(sums, _mm_srli_si128(sums, 4));
+        length += _mm_cvtsi128_si32(sums);
+    }
+    return length + utf8_length_of_utf16_scalar(first, last);
+}
+
+__attribute__((target("avx2")))
+std::ptrdiff_t utf8_length_of_utf16_avx2(
+    const char16_t *first,
+    const char16_t *last) noexcept
+{
+    const __m256i sign = _mm256_set1_epi16(static_cast<short>(0x8000));
+    const __m256i max_one = _mm256_set1_epi16(static_cast<short>(0x807F));
+    const __m256i max_two = _mm256_set1_epi16(static_cast<short>(0x87FF));
+    const __m256i surrogate_mask =
+        _mm256_set1_epi16(static_cast<short>(0xF800));
+    const __m256i surrogate = _mm256_set1_epi16(static_cast<short>(0xD800));
+    const __m256i ones = _mm256_set1_epi16(1);
+    std::ptrdiff_t length = 0;
+    while (last - first >= 16) {
+        __m256i counts = _mm256_setzero_si256();
+        for (int i = 0; i < 16383 && last - first >= 16; ++i, first += 16) {
+            __m256i input =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            __m256i flipped = _mm256_xor_si256(input, sign);
+            __m256i is_surrogate = _mm256_cmpeq_epi16(
+                _mm256_and_si256(input, surrogate_mask), surrogate);
+            counts = _mm256_sub_epi16(
+                counts, _mm256_cmpgt_epi16(flipped, max_one));
+            counts = _mm256_sub_epi16(
+                counts,
+                _mm256_andnot_si256(
+                    is_surrogate, _mm256_cmpgt_epi16(flipped, max_two)));
+            length += 16;
+        }
+        __m256i sums = _mm256_madd_epi16(counts, ones);
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sums),
+                                     _mm256_extracti128_si256(sums, 1));
+        half = _mm_add_epi32(half, _mm_srli_si128(half, 8));
+        half = _mm_add_epi32(half, _mm_srli_si128(half, 4));
+        length += _mm_cvtsi128_si32(half);
+    }
+    return length + utf8_length_of_utf16_scalar(first, last);
+}
+
+// The Latin-1 transcoders convert blocks of ASCII code units by copying
+// them.  The SSSE3 implementations also convert blocks that contain other
+// code points below U+0100 with byte shuffles: each non-ASCII Latin-1 code
+// unit is expanded to the two UTF-8 code units of its 16-bit lane, and each
+// two code unit UTF-8 sequence is combined into its lead code unit before
+// the continuation code units are squeezed out.  The shuffle controls are
+// selected from tables indexed by 8-bit masks of the lanes to keep.
+
+// Shuffle controls that gather the low byte of each of eight 16-bit lanes and
+// also the high byte of each lane whose bit is set in the index.
+struct latin1_expand_table {
+    unsigned char shuffle[256][16];
+    unsigned char length[256];
+};
+
+constexpr latin1_expand_table make_latin1_expand_table() noexcept {
+    latin1_expand_table table{};
+    for (int mask = 0; mask < 256; ++mask) {
+        int n = 0;
+        for (int i = 0; i < 8; ++i) {
+            table.shuffle[mask][n++] = static_cast<unsigned char>(2 * i);
+            if (mask & (1 << i)) {
+                table.shuffle[mask][n++] =
+                    static_cast<unsigned char>(2 * i + 1);
+            }
+        }
+        table.length[mask] = static_cast<unsigned char>(n);
+        for (; n < 16; ++n) {
+            table.shuffle[mask][n] = 0x80;
+        }
+    }
+    return table;
+}
+
+constexpr latin1_expand_table latin1_expand = make_latin1_expand_table();
+
+// Shuffle controls that gather the bytes of an 8-byte block whose bits are set
+// in the index.
+struct latin1_compress_table {
+    unsigned char shuffle[256][8];
+    unsigned char length[256];
+};
+
+constexpr latin1_compress_table make_latin1_compress_table() noexcept {
+    latin1_compress_table table{};
+    for (int mask = 0; mask < 256; ++mask) {
+        int n = 0;
+        for (int i = 0; i < 8; ++i) {
+            if (mask & (1 << i)) {
+                table.shuffle[mask][n++] = static_cast<unsigned char>(i);
+            }
+        }
+        table.length[mask] = static_cast<unsigned char>(n);
+        for (; n < 8; ++n) {
+            table.shuffle[mask][n] = 0x80;
+        }
+    }
+    return table;
+}
+
+constexpr latin1_compress_table latin1_compress =
+    make_latin1_compress_table();
+
+__attribute__((target("sse2")))
+transcode_result latin1_to_utf8_sse2(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    transcode_result result{
+        0, 0, decode_status::no_error, encode_status::no_error };
+    for (;;) {
+        const unsigned char *in_next = in_first + result.input_code_units;
+        unsigned char *out_next = out_first + result.output_code_units;
+        while (in_last - in_next >= 16 && out_last - out_next >= 16) {
+            __m128i input =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(in_next));
+            if (_mm_movemask_epi8(input) != 0) {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out_next), input);
+            in_next += 16;
+            out_next += 16;
+        }
+        result.input_code_units = in_next - in_first;
+        result.output_code_units = out_next - out_first;
+        transcode_result step = latin1_to_utf8_scalar_n(
+            in_next, in_last, out_next, out_last, scalar_step_code_points);
+        if (! accumulate_step(result, step, in_last - in_next)) {
+            return result;
+        }
+    }
+}
+
+__attribute__((target("ssse3")))
+transcode_result latin1_to_utf8_ssse3(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ascii_limit = _mm_set1_epi16(0x80);
+    const __m128i lead_bits = _mm_set1_epi16(0xC0);
+    const __m128i trail_bits = _mm_set1_epi16(static_cast<short>(0x8000));
+    const __m128i low_six = _mm_set1_epi16(0x3F);
+    const unsigned char *in_next = in_first;
+    unsigned char *out_next = out_first;
+    while (in_last - in_next >= 16 && out_last - out_next >= 32) {
+        __m128i input =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in_next));
+        int non_ascii = _mm_movemask_epi8(input);
+        if (non_ascii == 0) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out_next), input);
+            in_next += 16;
+            out_next += 16;
+            continue;
+        }
+        for (int half = 0; half < 2; ++half) {
+            __m128i cus = half == 0 ? _mm_unpacklo_epi8(input, zero)
+                                    : _mm_unpackhi_epi8(input, zero);
+            // The low byte of each lane holds the ASCII code unit or the
+            // lead code unit; the high byte holds the continuation code unit.
+            __m128i encoded = _mm_or_si128(
+                _mm_or_si128(_mm_srli_epi16(cus, 6), lead_bits),
+                _mm_or_si128(
+                    _mm_slli_epi16(_mm_and_si128(cus, low_six), 8),
+                    trail_bits));
+            __m128i is_ascii = _mm_cmplt_epi16(cus, ascii_limit);
+            encoded = _mm_or_si128(_mm_and_si128(is_ascii, cus),
+                                   _mm_andnot_si128(is_ascii, encoded));
+            int mask = (non_ascii >> (8 * half)) & 0xFF;
+            __m128i shuffle = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(
+                    latin1_expand.shuffle[mask]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out_next),
+                             _mm_shuffle_epi8(encoded, shuffle));
+            out_next += latin1_expand.length[mask];
+        }
+        in_next += 16;
+    }
+    transcode_result tail = latin1_to_utf8_scalar(
+        in_next, in_last, out_next, out_last);
+    return { in_next - in_first + tail.input_code_units,
+             out_next - out_first + tail.output_code_units,
+             decode_status::no_error,
+             encode_status::no_error };
+}
+
+__attribute__((target("sse2")))
+transcode_result utf8_to_latin1_sse2(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    transcode_result result{
+        0, 0, decode_status::no_error, encode_status::no_error };
+    for (;;) {
+        const unsigned char *in_next = in_first + result.input_code_units;
+        unsigned char *out_next = out_first + result.output_code_units;
+        while (in_last - in_next >= 16 && out_last - out_next >= 16) {
+            __m128i input =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(in_next));
+            if (_mm_movemask_epi8(input) != 0) {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out_next), input);
+            in_next += 16;
+            out_next += 16;
+        }
+        result.input_code_units = in_next - in_first;
+        result.output_code_units = out_next - out_first;
+        transcode_result step = utf8_to_latin1_scalar_n(
+            in_next, in_last, out_next, out_last, scalar_step_code_points);
+        if (! accumulate_step(result, step, in_last - in_next)) {
+            return result;
+        }
+    }
+}
+
+__attribute__((target("ssse3")))
+transcode_result utf8_to_latin1_ssse3(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    const __m128i lead_mask = _mm_set1_epi8(static_cast<char>(0xFE));
+    const __m128i lead_bits = _mm_set1_epi8(static_cast<char>(0xC2));
+    const __m128i trail_mask = _mm_set1_epi8(static_cast<char>(0xC0));
+    const __m128i trail_bits = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m128i low_two = _mm_set1_epi8(0x03);
+    const __m128i low_six = _mm_set1_epi8(0x3F);
+    const __m128i eight = _mm_set1_epi8(8);
+    transcode_result result{
+        0, 0, decode_status::no_error, encode_status::no_error };
+    for (;;) {
+        const unsigned char *in_next = in_first + result.input_code_units;
+        unsigned char *out_next = out_first + result.output_code_units;
+        while (in_last - in_next >= 16 && out_last - out_next >= 16) {
+            __m128i input =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(in_next));
+            int non_ascii = _mm_movemask_epi8(input);
+            if (non_ascii == 0) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out_next), input);
+                in_next += 16;
+                out_next += 16;
+                continue;
+            }
+            // Every non-ASCII code unit must belong to a two code unit
+            // sequence that starts with 0xC2 or 0xC3 within the block; a
+            // lead code unit that ends the block is left for the next one.
+            __m128i is_lead = _mm_cmpeq_epi8(
+                _mm_and_si128(input, lead_mask), lead_bits);
+            int leads = _mm_movemask_epi8(is_lead);
+            int trails = _mm_movemask_epi8(_mm_cmpeq_epi8(
+                _mm_and_si128(input, trail_mask), trail_bits));
+            if ((leads | trails) != non_ascii ||
+                trails != ((leads << 1) & 0xFFFF))
+            {
+                break;
+            }
+            // Shifting 16-bit lanes by six moves the low two bits of each
+            // byte to its high two bits without crossing into the next byte.
+            __m128i combined = _mm_or_si128(
+                _mm_slli_epi16(_mm_and_si128(input, low_two), 6),
+                _mm_and_si128(_mm_srli_si128(input, 1), low_six));
+            __m128i values = _mm_or_si128(
+                _mm_and_si128(is_lead, combined),
+                _mm_andnot_si128(is_lead, input));
+            int keep = ~trails & 0xFFFF;
+            std::ptrdiff_t consumed = 16;
+            if (leads & 0x8000) {
+                keep &= 0x7FFF;
+                consumed = 15;
+            }
+            int keep_low = keep & 0xFF;
+            int keep_high = keep >> 8;
+            __m128i low = _mm_shuffle_epi8(
+                values,
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(
+                    latin1_compress.shuffle[keep_low])));
+            __m128i high = _mm_shuffle_epi8(
+                values,
+                _mm_add_epi8(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(
+                        latin1_compress.shuffle[keep_high])),
+                    eight));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out_next), low);
+            out_next += latin1_compress.length[keep_low];
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out_next), high);
+            out_next += latin1_compress.length[keep_high];
+            in_next += consumed;
+        }
+        result.input_code_units = in_next - in_first;
+        result.output_code_units = out_next - out_first;
+        transcode_result step = utf8_to_latin1_scalar_n(
+            in_next, in_last, out_next, out_last, scalar_step_code_points);
+        if (! accumulate_step(result, step, in_last - in_next)) {
+            return result;
+        }
+    }
+}
+
+#endif // x86
+
+
+using utf8_to_utf16_function =
+    transcode_result (*)(const unsigned char*, const unsigned char*,
+                         char16_t*, char16_t*);
+using utf16_to_utf8_function =
+    transcode_result (*)(const char16_t*, const char16_t*,
+                         unsigned char*, unsigned char*);
+
+kernel_dispatcher<utf8_to_utf16_function> utf8_to_utf16_kernels{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx2, utf8_to_utf16_avx2 },
+    { simd_level::sse2, utf8_to_utf16_sse2 },
+#endif
+    { simd_level::scalar, utf8_to_utf16_scalar }};
+
+kernel_dispatcher<utf16_to_utf8_function> utf16_to_utf8_kernels{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx2, utf16_to_utf8_avx2 },
+    { simd_level::sse2, utf16_to_utf8_sse2 },
+#endif
+    { simd_level::scalar, utf16_to_utf8_scalar }};
+
+using utf16_length_of_utf8_function =
+    std::ptrdiff_t (*)(const unsigned char*, const unsigned char*);
+using utf8_length_of_utf16_function =
+    std::ptrdiff_t (*)(const char16_t*, const char16_t*);
+
+kernel_dispatcher<utf16_length_of_utf8_function> utf16_length_of_utf8_kernels{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx2, utf16_length_of_utf8_avx2 },
+    { simd_level::sse2, utf16_length_of_utf8_sse2 },
+#endif
+    { simd_level::scalar, utf16_length_of_utf8_scalar }};
+
+kernel_dispatcher<utf8_length_of_utf16_function> utf8_length_of_utf16_kernels{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx2, utf8_length_of_utf16_avx2 },
+    { simd_level::sse2, utf8_length_of_utf16_sse2 },
+#endif
+    { simd_level::scalar, utf8_length_of_utf16_scalar }};
+
+using latin1_transcode_function =
+    transcode_result (*)(const unsigned char*, const unsigned char*,
+                         unsigned char*, unsigned char*);
+
+kernel_dispatcher<latin1_transcode_function> latin1_to_utf8_kernels{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::ssse3, latin1_to_utf8_ssse3 },
+    { simd_level::sse2, latin1_to_utf8_sse2 },
+#endif
+    { simd_level::scalar, latin1_to_utf8_scalar }};
+
+kernel_dispatcher<latin1_transcode_function> utf8_to_latin1_kernels{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::ssse3, utf8_to_latin1_ssse3 },
+    { simd_level::sse2, utf8_to_latin1_sse2 },
+#endif
+    { simd_level::scalar, utf8_to_latin1_scalar }};
+
+} // unnamed namespace
+
+
+transcode_result utf8_to_utf16(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char16_t *out_first,
+    char16_t *out_last) noexcept
+{
+    return utf8_to_utf16_kernels(in_first, in_last, out_first, out_last);
+}
+
+transcode_result utf16_to_utf8(
+    const char16_t *in_first,
+    const char16_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return utf16_to_utf8_kernels(in_first, in_last, out_first, out_last);
+}
+
+transcode_result utf8_to_utf16_length(
+    const unsigned char *in_first,
+    const unsigned char *in_last) noexcept
+{
+    validate_result r = utf8_validate(in_first, in_last);
+    return { r.code_units,
+             utf16_length_of_utf8_kernels(in_first, in_first + r.code_units),
+             r.status,
+             encode_status::no_error };
+}
+
+transcode_result utf16_to_utf8_length(
+    const char16_t *in_first,
+    const char16_t *in_last) noexcept
+{
+    decode_n_result r = utf16_count_code_points(in_first, in_last);
+    return { r.code_units,
+             utf8_length_of_utf16_kernels(in_first, in_first + r.code_units),
+             r.status,
+             encode_status::no_error };
+}
+
+transcode_result latin1_to_utf8(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return latin1_to_utf8_kernels(in_first, in_last, out_first, out_last);
+}
+
+transcode_result utf8_to_latin1(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return utf8_to_latin1_kernels(in_first, in_last, out_first, out_last);
+}
+
+transcode_result latin1_to_utf8_length(
+    const unsigned char *in_first,
+    const unsigned char *in_last) noexcept
+{
+    std::ptrdiff_t length = in_last - in_first;
+    for (const unsigned char *p = in_first; p != in_last; ++p) {
+        length += *p >= 0x80;
+    }
+    return { in_last - in_first,
+             length,
+             decode_status::no_error,
+             encode_status::no_error };
+}
+
+transcode_result utf8_to_latin1_length(
+    const unsigned char *in_first,
+    const unsigned char *in_last) noexcept
+{
+    // Within a well-formed prefix, the code points above U+00FF are those
+    // with a lead code unit of 0xC4 or more; the code points before the first
+    // of them are counted.
+    decode_n_result r = utf8_count_code_points(in_first, in_last);
+    const unsigned char *prefix_last = in_first + r.code_units;
+    const unsigned char *wide = std::find_if(
+        in_first, prefix_last, [](unsigned char cu) { return cu >= 0xC4; });
+    if (wide != prefix_last) {
+        return { wide - in_first,
+                 utf8_count_code_points(in_first, wide).code_points,
+                 decode_status::no_error,
+                 encode_status::invalid_character };
+    }
+    return { r.code_units,
+             r.code_points,
+             r.status,
+             encode_status::no_error };
+}
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
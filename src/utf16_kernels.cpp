@@ -0,0 +1,974 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <text_view_detail/codecs/utf16_kernels.hpp>
+#include <text_view_detail/kernel_dispatch.hpp>
+#include <text_view_detail/error_status.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+namespace {
+
+decode_n_result utf16_count_code_points_scalar(
+    const char16_t *first,
+    const char16_t *last) noexcept
+{
+    const char16_t *next = first;
+    std::ptrdiff_t count = 0;
+    decode_status ds = decode_status::no_error;
+    while (next != last) {
+        char16_t cu = *next;
+        if (cu < 0xD800 || cu >= 0xE000) {
+            ++next;
+            ++count;
+            continue;
+        }
+        if (cu >= 0xDC00) {
+            ds = decode_status::invalid_code_unit_sequence;
+            break;
+        }
+        if (last - next < 2) {
+            ds = decode_status::underflow;
+            break;
+        }
+        if (next[1] < 0xDC00 || next[1] >= 0xE000) {
+            ds = decode_status::invalid_code_unit_sequence;
+            break;
+        }
+        next += 2;
+        ++count;
+    }
+    return { next - first, count, ds };
+}
+
+// Counts the code points of [resume, last) with the scalar implementation
+// after a vectorized implementation counted 'count' code points in
+// [first, resume).
+decode_n_result utf16_count_code_points_scalar_from(
+    const char16_t *first,
+    const char16_t *resume,
+    const char16_t *last,
+    std::ptrdiff_t count) noexcept
+{
+    decode_n_result result = utf16_count_code_points_scalar(resume, last);
+    result.code_units += resume - first;
+    result.code_points += count;
+    return result;
+}
+
+
+// Surrogate code units are located by a vectorized scan; code units between
+// surrogates are single code unit sequences that need no further checks.
+// Surrogates are paired by the scalar code below, after which the scan
+// resumes.  Each implementation of the scan is paired with an implementation
+// that also widens the code units it passes over to code points.  Encoding
+// works the same way: code points that encode as single code units are
+// narrowed by a vectorized implementation and the others are encoded by
+// scalar code.
+//
+// Code units are read from, and written to, byte sequences so that the same
+// implementations serve native, big-endian, and little-endian code units;
+// 'swap' is true when the byte order of the code units differs from that of
+// the host.  Byte sequences are always of even length.
+constexpr bool host_is_big_endian =
+    __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+
+using utf16_find_surrogate_function =
+    const unsigned char* (*)(const unsigned char*, const unsigned char*);
+using utf16_widen_function =
+    const unsigned char* (*)(const unsigned char*, const unsigned char*,
+                             char32_t*);
+using utf16_narrow_function =
+    const char32_t* (*)(const char32_t*, const char32_t*, unsigned char*);
+
+bool is_surrogate(char16_t cu) noexcept {
+    return (cu & 0xF800) == 0xD800;
+}
+
+template<bool swap>
+char16_t load_utf16(const unsigned char *p) noexcept {
+    char16_t cu;
+    std::memcpy(&cu, p, sizeof(cu));
+    return swap ? char16_t((cu << 8) | (cu >> 8)) : cu;
+}
+
+template<bool swap>
+void store_utf16(unsigned char *p, char16_t cu) noexcept {
+    if (swap) {
+        cu = char16_t((cu << 8) | (cu >> 8));
+    }
+    std::memcpy(p, &cu, sizeof(cu));
+}
+
+template<bool swap>
+const unsigned char* utf16_find_surrogate_scalar(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    while (first != last && ! is_surrogate(load_utf16<swap>(first))) {
+        first += 2;
+    }
+    return first;
+}
+
+// Widens the code units of [first, last) that precede the first surrogate
+// code unit to code points written to 'out'.  Returns the end of the code
+// units widened.
+template<bool swap>
+const unsigned char* utf16_widen_scalar(
+    const unsigned char *first,
+    const unsigned char *last,
+    char32_t *out) noexcept
+{
+    while (first != last) {
+        char16_t cu = load_utf16<swap>(first);
+        if (is_surrogate(cu)) {
+            break;
+        }
+        *out++ = cu;
+        first += 2;
+    }
+    return first;
+}
+
+// Narrows the code points of [first, last) that precede the first code point
+// that is a surrogate code point or that is above U+FFFF to code units
+// written to 'out'.  Returns the end of the code points narrowed.
+template<bool swap>
+const char32_t* utf16_narrow_scalar(
+    const char32_t *first,
+    const char32_t *last,
+    unsigned char *out) noexcept
+{
+    while (first != last && *first <= 0xFFFF && ! is_surrogate(*first)) {
+        store_utf16<swap>(out, char16_t(*first++));
+        out += 2;
+    }
+    return first;
+}
+
+// Checks the run of surrogate code units that starts at 'next', advancing
+// 'next' past each well-formed surrogate pair.  The checks correspond to
+// those performed by utf16_codec::decode().
+template<bool swap>
+decode_status utf16_pair_surrogates(
+    const unsigned char *&next,
+    const unsigned char *last) noexcept
+{
+    while (next != last && is_surrogate(load_utf16<swap>(next))) {
+        if (load_utf16<swap>(next) >= 0xDC00) {
+            return decode_status::invalid_code_unit_sequence;
+        }
+        if (last - next < 4) {
+            return decode_status::underflow;
+        }
+        if ((load_utf16<swap>(next + 2) & 0xFC00) != 0xDC00) {
+            return decode_status::invalid_code_unit_sequence;
+        }
+        next += 4;
+    }
+    return decode_status::no_error;
+}
+
+// The following functions report offsets and lengths in bytes.
+
+template<bool swap, utf16_find_surrogate_function find_surrogate>
+validate_result utf16_validate_with(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    const unsigned char *next = first;
+    for (;;) {
+        next = find_surrogate(next, last);
+        decode_status ds = utf16_pair_surrogates<swap>(next, last);
+        if (ds != decode_status::no_error || next == last) {
+            return { next - first, ds };
+        }
+    }
+}
+
+template<bool swap, utf16_widen_function widen>
+decode_n_result utf16_decode_n_with(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept
+{
+    const unsigned char *in_next = in_first;
+    char32_t *out_next = out_first;
+    decode_status ds = decode_status::no_error;
+    while (in_next != in_last && out_next != out_last) {
+        std::ptrdiff_t n = std::min((in_last - in_next) / 2,
+                                    out_last - out_next);
+        const unsigned char *run_end = widen(in_next, in_next + 2 * n,
+                                             out_next);
+        out_next += (run_end - in_next) / 2;
+        in_next = run_end;
+        if (in_next == in_last || out_next == out_last) {
+            break;
+        }
+
+        char16_t cu1 = load_utf16<swap>(in_next);
+        if (cu1 >= 0xDC00) {
+            ds = decode_status::invalid_code_unit_sequence;
+            break;
+        }
+        if (in_last - in_next < 4) {
+            ds = decode_status::underflow;
+            break;
+        }
+        char16_t cu2 = load_utf16<swap>(in_next + 2);
+        if ((cu2 & 0xFC00) != 0xDC00) {
+            ds = decode_status::invalid_code_unit_sequence;
+            break;
+        }
+        *out_next++ = 0x10000 + (((cu1 & 0x3FF) << 10) | (cu2 & 0x3FF));
+        in_next += 4;
+    }
+    return { in_next - in_first, out_next - out_first, ds };
+}
+
+// The checks and the encoding of code points above U+FFFF correspond to
+// utf16_codec::encode() and to the encode() members of the big-endian and
+// little-endian codecs.  Code points above max_code_point are rejected;
+// utf16_codec rejects those above U+10FFFF while the big-endian and
+// little-endian codecs encode them as the low bits of a surrogate pair.
+template<bool swap, utf16_narrow_function narrow, char32_t max_code_point>
+encode_n_result utf16_encode_n_with(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    const char32_t *in_next = in_first;
+    unsigned char *out_next = out_first;
+    encode_status es = encode_status::no_error;
+    while (in_next != in_last) {
+        std::ptrdiff_t n = std::min(in_last - in_next,
+                                    (out_last - out_next) / 2);
+        const char32_t *run_end = narrow(in_next, in_next + n, out_next);
+        out_next += 2 * (run_end - in_next);
+        in_next = run_end;
+        if (in_next == in_last) {
+            break;
+        }
+
+        char32_t cp = *in_next;
+        if ((cp >= 0xD800 && cp <= 0xDFFF) || cp > max_code_point) {
+            es = encode_status::invalid_character;
+            break;
+        }
+        if (cp <= 0xFFFF) {
+            // The output lacks space for the code point.
+            break;
+        }
+        if (out_last - out_next < 4) {
+            break;
+        }
+        store_utf16<swap>(
+            out_next, char16_t(0xD800 + (((cp - 0x10000) >> 10) & 0x03FF)));
+        store_utf16<swap>(
+            out_next + 2, char16_t(0xDC00 + ((cp - 0x10000) & 0x03FF)));
+        out_next += 4;
+        ++in_next;
+    }
+    return { in_next - in_first, out_next - out_first, es };
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// The vectorized scans test 8, 16, or 32 code units at a time for surrogate
+// code units by comparing their high five bits to those of 0xD800, after
+// reversing the bytes of each code unit if necessary.  The vectorized
+// narrowing tests code points for surrogates and for values above U+FFFF by
+// comparing their bits above the low eleven to those of 0xD800 and 0xFFFF.
+// The scalar implementations finish a block that requires scalar handling
+// and the code units or code points that remain after the last full block.
+
+template<bool swap>
+__attribute__((target("sse2")))
+__m128i swap_utf16_sse2(__m128i x) noexcept {
+    return swap ? _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8))
+                : x;
+}
+
+template<bool swap>
+__attribute__((target("avx2")))
+__m256i swap_utf16_avx2(__m256i x) noexcept {
+    if (! swap) {
+        return x;
+    }
+    return _mm256_shuffle_epi8(x, _mm256_setr_epi8(
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+}
+
+template<bool swap>
+__attribute__((target("avx512f,avx512bw")))
+__m512i swap_utf16_avx512(__m512i x) noexcept {
+    if (! swap) {
+        return x;
+    }
+    return _mm512_shuffle_epi8(x, _mm512_set4_epi32(
+        0x0E0F0C0D, 0x0A0B0809, 0x06070405, 0x02030001));
+}
+
+template<bool swap>
+__attribute__((target("sse2")))
+const unsigned char* utf16_find_surrogate_sse2(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    const __m128i high_bits = _mm_set1_epi16(static_cast<short>(0xF800));
+    const __m128i surrogate = _mm_set1_epi16(static_cast<short>(0xD800));
+    for (; last - first >= 16; first += 16) {
+        __m128i input = swap_utf16_sse2<swap>(_mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(first)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(
+                _mm_and_si128(input, high_bits), surrogate)) != 0)
+        {
+            break;
+        }
+    }
+    return utf16_find_surrogate_scalar<swap>(first, last);
+}
+
+template<bool swap>
+__attribute__((target("sse2")))
+const unsigned char* utf16_widen_sse2(
+    const unsigned char *first,
+    const unsigned char *last,
+    char32_t *out) noexcept
+{
+    const __m128i high_bits = _mm_set1_epi16(static_cast<short>(0xF800));
+    const __m128i surrogate = _mm_set1_epi16(static_cast<short>(0xD800));
+    const __m128i zero = _mm_setzero_si128();
+    for (; last - first >= 16; first += 16, out += 8) {
+        __m128i input = swap_utf16_sse2<swap>(_mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(first)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(
+                _mm_and_si128(input, high_bits), surrogate)) != 0)
+        {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                         _mm_unpacklo_epi16(input, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4),
+                         _mm_unpackhi_epi16(input, zero));
+    }
+    return utf16_widen_scalar<swap>(first, last, out);
+}
+
+template<bool swap>
+__attribute__((target("sse2")))
+const char32_t* utf16_narrow_sse2(
+    const char32_t *first,
+    const char32_t *last,
+    unsigned char *out) noexcept
+{
+    const __m128i beyond_bmp = _mm_set1_epi32(0xFFFF >> 11);
+    const __m128i surrogate = _mm_set1_epi32(0xD800 >> 11);
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+    for (; last - first >= 8; first += 8, out += 16) {
+        __m128i input1 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(first));
+        __m128i input2 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(first + 4));
+        __m128i high1 = _mm_srli_epi32(input1, 11);
+        __m128i high2 = _mm_srli_epi32(input2, 11);
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpgt_epi32(high1, beyond_bmp),
+                         _mm_cmpeq_epi32(high1, surrogate)),
+            _mm_or_si128(_mm_cmpgt_epi32(high2, beyond_bmp),
+                         _mm_cmpeq_epi32(high2, surrogate)));
+        if (_mm_movemask_epi8(special) != 0) {
+            break;
+        }
+        // SSE2 lacks an unsigned saturating pack; the code points are biased
+        // into the range of the signed one.
+        __m128i output = _mm_xor_si128(
+            _mm_packs_epi32(_mm_sub_epi32(input1, bias32),
+                            _mm_sub_epi32(input2, bias32)),
+            bias16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                         swap_utf16_sse2<swap>(output));
+    }
+    return utf16_narrow_scalar<swap>(first, last, out);
+}
+
+template<bool swap>
+__attribute__((target("avx2")))
+const unsigned char* utf16_find_surrogate_avx2(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    const __m256i high_bits = _mm256_set1_epi16(static_cast<short>(0xF800));
+    const __m256i surrogate = _mm256_set1_epi16(static_cast<short>(0xD800));
+    for (; last - first >= 32; first += 32) {
+        __m256i input = swap_utf16_avx2<swap>(_mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(first)));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(
+                _mm256_and_si256(input, high_bits), surrogate)) != 0)
+        {
+            break;
+        }
+    }
+    return utf16_find_surrogate_scalar<swap>(first, last);
+}
+
+template<bool swap>
+__attribute__((target("avx2")))
+const unsigned char* utf16_widen_avx2(
+    const unsigned char *first,
+    const unsigned char *last,
+    char32_t *out) noexcept
+{
+    const __m256i high_bits = _mm256_set1_epi16(static_cast<short>(0xF800));
+    const __m256i surrogate = _mm256_set1_epi16(static_cast<short>(0xD800));
+    for (; last - first >= 32; first += 32, out += 16) {
+        __m256i input = swap_utf16_avx2<swap>(_mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(first)));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(
+                _mm256_and_si256(input, high_bits), surrogate)) != 0)
+        {
+            break;
+        }
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(out),
+            _mm256_cvtepu16_epi32(_mm256_castsi256_si128(input)));
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(out + 8),
+            _mm256_cvtepu16_epi32(_mm256_extracti128_si256(input, 1)));
+    }
+    return utf16_widen_scalar<swap>(first, last, out);
+}
+
+template<bool swap>
+__attribute__((target("avx2")))
+const char32_t* utf16_narrow_avx2(
+    const char32_t *first,
+    const char32_t *last,
+    unsigned char *out) noexcept
+{
+    const __m256i beyond_bmp = _mm256_set1_epi32(0xFFFF >> 11);
+    const __m256i surrogate = _mm256_set1_epi32(0xD800 >> 11);
+    for (; last - first >= 16; first += 16, out += 32) {
+        __m256i input1 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(first));
+        __m256i input2 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(first + 8));
+        __m256i high1 = _mm256_srli_epi32(input1, 11);
+        __m256i high2 = _mm256_srli_epi32(input2, 11);
+        __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpgt_epi32(high1, beyond_bmp),
+                            _mm256_cmpeq_epi32(high1, surrogate)),
+            _mm256_or_si256(_mm256_cmpgt_epi32(high2, beyond_bmp),
+                            _mm256_cmpeq_epi32(high2, surrogate)));
+        if (_mm256_movemask_epi8(special) != 0) {
+            break;
+        }
+        // The pack operates within 128-bit lanes; the permutation restores
+        // the order of the code units.
+        __m256i output = _mm256_permute4x64_epi64(
+            _mm256_packus_epi32(input1, input2), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+                            swap_utf16_avx2<swap>(output));
+    }
+    return utf16_narrow_scalar<swap>(first, last, out);
+}
+
+template<bool swap>
+__attribute__((target("avx512f,avx512bw")))
+const unsigned char* utf16_find_surrogate_avx512(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    const __m512i high_bits = _mm512_set1_epi16(static_cast<short>(0xF800));
+    const __m512i surrogate = _mm512_set1_epi16(static_cast<short>(0xD800));
+    for (; last - first >= 64; first += 64) {
+        __m512i input = swap_utf16_avx512<swap>(_mm512_loadu_si512(first));
+        if (_mm512_cmpeq_epi16_mask(
+                _mm512_and_si512(input, high_bits), surrogate) != 0)
+        {
+            break;
+        }
+    }
+    return utf16_find_surrogate_scalar<swap>(first, last);
+}
+
+template<bool swap>
+__attribute__((target("avx512f,avx512bw")))
+const unsigned char* utf16_widen_avx512(
+    const unsigned char *first,
+    const unsigned char *last,
+    char32_t *out) noexcept
+{
+    const __m512i high_bits = _mm512_set1_epi16(static_cast<short>(0xF800));
+    const __m512i surrogate = _mm512_set1_epi16(static_cast<short>(0xD800));
+    for (; last - first >= 64; first += 64, out += 32) {
+        __m512i input = swap_utf16_avx512<swap>(_mm512_loadu_si512(first));
+        if (_mm512_cmpeq_epi16_mask(
+                _mm512_and_si512(input, high_bits), surrogate) != 0)
+        {
+            break;
+        }
+        // The zero-masking forms of the intrinsics are used to avoid
+        // operands with undefined contents.
+        _mm512_storeu_si512(
+            out,
+            _mm512_maskz_cvtepu16_epi32(
+                0xFFFF, _mm512_maskz_extracti64x4_epi64(0xF, input, 0)));
+        _mm512_storeu_si512(
+            out + 16,
+            _mm512_maskz_cvtepu16_epi32(
+                0xFFFF, _mm512_maskz_extracti64x4_epi64(0xF, input, 1)));
+    }
+    return utf16_widen_scalar<swap>(first, last, out);
+}
+
+template<bool swap>
+__attribute__((target("avx512f,avx512bw")))
+const char32_t* utf16_narrow_avx512(
+    const char32_t *first,
+    const char32_t *last,
+    unsigned char *out) noexcept
+{
+    const __m512i beyond_bmp = _mm512_set1_epi32(0xFFFF >> 11);
+    const __m512i surrogate = _mm512_set1_epi32(0xD800 >> 11);
+    for (; last - first >= 32; first += 32, out += 64) {
+        __m512i input1 = _mm512_loadu_si512(first);
+        __m512i input2 = _mm512_loadu_si512(first + 16);
+        // The zero-masking forms of the intrinsics are used here and below to
+        // avoid operands with undefined contents.
+        __m512i high1 = _mm512_maskz_srli_epi32(0xFFFF, input1, 11);
+        __m512i high2 = _mm512_maskz_srli_epi32(0xFFFF, input2, 11);
+        if ((_mm512_cmpgt_epi32_mask(high1, beyond_bmp) |
+             _mm512_cmpeq_epi32_mask(high1, surrogate) |
+             _mm512_cmpgt_epi32_mask(high2, beyond_bmp) |
+             _mm512_cmpeq_epi32_mask(high2, surrogate)) != 0)
+        {
+            break;
+        }
+        __m512i output = _mm512_maskz_inserti64x4(
+            0xFF, _mm512_setzero_si512(),
+            _mm512_maskz_cvtepi32_epi16(0xFFFF, input1), 0);
+        output = _mm512_maskz_inserti64x4(
+            0xFF, output, _mm512_maskz_cvtepi32_epi16(0xFFFF, input2), 1);
+        _mm512_storeu_si512(out, swap_utf16_avx512<swap>(output));
+    }
+    return utf16_narrow_scalar<swap>(first, last, out);
+}
+
+// The vectorized implementations compute masks of the leading and trailing
+// surrogate code units of a block.  The block is well-formed if every
+// trailing surrogate immediately follows a leading surrogate and every leading
+// surrogate is immediately followed by a trailing surrogate; that is, if the
+// leading surrogate mask shifted by one code unit, with the leading surrogate
+// that may end the previous block shifted in, equals the trailing surrogate
+// mask.  A leading surrogate that ends a block is checked with the next one.
+// Each code unit other than a trailing surrogate begins one code point.
+// Blocks that are not well-formed are left to the scalar implementation so
+// that the error is located exactly.
+
+__attribute__((target("sse2")))
+decode_n_result utf16_count_code_points_sse2(
+    const char16_t *first,
+    const char16_t *last) noexcept
+{
+    const __m128i surrogate_bits = _mm_set1_epi16(
+        static_cast<short>(0xFC00));
+    const __m128i leading = _mm_set1_epi16(static_cast<short>(0xD800));
+    const __m128i trailing = _mm_set1_epi16(static_cast<short>(0xDC00));
+    const char16_t *next = first;
+    std::ptrdiff_t count = 0;
+    unsigned carry = 0;
+    for (; last - next >= 8; next += 8) {
+        __m128i input = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(next));
+        __m128i bits = _mm_and_si128(input, surrogate_bits);
+        // Each code unit contributes two bits to the masks.
+        unsigned lead_mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi16(bits, leading)));
+        unsigned trail_mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi16(bits, trailing)));
+        if ((((lead_mask << 2) | carry) & 0xFFFF) != trail_mask) {
+            break;
+        }
+        carry = lead_mask >> 14;
+        count += 8 - __builtin_popcount(trail_mask) / 2;
+    }
+    // A leading surrogate that ends the last block counted is rechecked.
+    if (carry) {
+        --next;
+        --count;
+    }
+    return utf16_count_code_points_scalar_from(first, next, last, count);
+}
+
+__attribute__((target("avx2")))
+decode_n_result utf16_count_code_points_avx2(
+    const char16_t *first,
+    const char16_t *last) noexcept
+{
+    const __m256i surrogate_bits = _mm256_set1_epi16(
+        static_cast<short>(0xFC00));
+    const __m256i leading = _mm256_set1_epi16(static_cast<short>(0xD800));
+    const __m256i trailing = _mm256_set1_epi16(static_cast<short>(0xDC00));
+    const char16_t *next = first;
+    std::ptrdiff_t count = 0;
+    std::uint32_t carry = 0;
+    for (; last - next >= 16; next += 16) {
+        __m256i input = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(next));
+        __m256i bits = _mm256_and_si256(input, surrogate_bits);
+        // Each code unit contributes two bits to the masks.
+        std::uint32_t lead_mask = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi16(bits, leading)));
+        std::uint32_t trail_mask = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi16(bits, trailing)));
+        if (((lead_mask << 2) | carry) != trail_mask) {
+            break;
+        }
+        carry = lead_mask >> 30;
+        count += 16 - __builtin_popcount(trail_mask) / 2;
+    }
+    // A leading surrogate that ends the last block counted is rechecked.
+    if (carry) {
+        --next;
+        --count;
+    }
+    return utf16_count_code_points_scalar_from(first, next, last, count);
+}
+
+#endif // x86
+
+
+using utf16_count_code_points_function =
+    decode_n_result (*)(const char16_t*, const char16_t*);
+
+kernel_dispatcher<utf16_count_code_points_function>
+    utf16_count_code_points_kernels{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx2, utf16_count_code_points_avx2 },
+    { simd_level::sse2, utf16_count_code_points_sse2 },
+#endif
+    { simd_level::scalar, utf16_count_code_points_scalar }};
+
+// Tables of the implementations of each operation for a byte order.
+template<bool swap>
+struct utf16_kernels {
+    using validate_function =
+        validate_result (*)(const unsigned char*, const unsigned char*);
+    using decode_n_function =
+        decode_n_result (*)(const unsigned char*, const unsigned char*,
+                            char32_t*, char32_t*);
+    using encode_n_function =
+        encode_n_result (*)(const char32_t*, const char32_t*,
+                            unsigned char*, unsigned char*);
+
+    static kernel_dispatcher<utf16_find_surrogate_function> find_surrogate;
+    static kernel_dispatcher<validate_function> validate;
+    static kernel_dispatcher<decode_n_function> decode_n;
+    static kernel_dispatcher<encode_n_function> encode_n;
+    static kernel_dispatcher<encode_n_function> encode_n_strict;
+};
+
+template<bool swap>
+kernel_dispatcher<utf16_find_surrogate_function>
+    utf16_kernels<swap>::find_surrogate{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx512bw, utf16_find_surrogate_avx512<swap> },
+    { simd_level::avx2, utf16_find_surrogate_avx2<swap> },
+    { simd_level::sse2, utf16_find_surrogate_sse2<swap> },
+#endif
+    { simd_level::scalar, utf16_find_surrogate_scalar<swap> }};
+
+template<bool swap>
+kernel_dispatcher<typename utf16_kernels<swap>::validate_function>
+    utf16_kernels<swap>::validate{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx512bw,
+      utf16_validate_with<swap, utf16_find_surrogate_avx512<swap>> },
+    { simd_level::avx2,
+      utf16_validate_with<swap, utf16_find_surrogate_avx2<swap>> },
+    { simd_level::sse2,
+      utf16_validate_with<swap, utf16_find_surrogate_sse2<swap>> },
+#endif
+    { simd_level::scalar,
+      utf16_validate_with<swap, utf16_find_surrogate_scalar<swap>> }};
+
+template<bool swap>
+kernel_dispatcher<typename utf16_kernels<swap>::decode_n_function>
+    utf16_kernels<swap>::decode_n{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx512bw,
+      utf16_decode_n_with<swap, utf16_widen_avx512<swap>> },
+    { simd_level::avx2, utf16_decode_n_with<swap, utf16_widen_avx2<swap>> },
+    { simd_level::sse2, utf16_decode_n_with<swap, utf16_widen_sse2<swap>> },
+#endif
+    { simd_level::scalar,
+      utf16_decode_n_with<swap, utf16_widen_scalar<swap>> }};
+
+template<bool swap>
+kernel_dispatcher<typename utf16_kernels<swap>::encode_n_function>
+    utf16_kernels<swap>::encode_n{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx512bw,
+      utf16_encode_n_with<swap, utf16_narrow_avx512<swap>, 0xFFFFFFFF> },
+    { simd_level::avx2,
+      utf16_encode_n_with<swap, utf16_narrow_avx2<swap>, 0xFFFFFFFF> },
+    { simd_level::sse2,
+      utf16_encode_n_with<swap, utf16_narrow_sse2<swap>, 0xFFFFFFFF> },
+#endif
+    { simd_level::scalar,
+      utf16_encode_n_with<swap, utf16_narrow_scalar<swap>, 0xFFFFFFFF> }};
+
+template<bool swap>
+kernel_dispatcher<typename utf16_kernels<swap>::encode_n_function>
+    utf16_kernels<swap>::encode_n_strict{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx512bw,
+      utf16_encode_n_with<swap, utf16_narrow_avx512<swap>, 0x10FFFF> },
+    { simd_level::avx2,
+      utf16_encode_n_with<swap, utf16_narrow_avx2<swap>, 0x10FFFF> },
+    { simd_level::sse2,
+      utf16_encode_n_with<swap, utf16_narrow_sse2<swap>, 0x10FFFF> },
+#endif
+    { simd_level::scalar,
+      utf16_encode_n_with<swap, utf16_narrow_scalar<swap>, 0x10FFFF> }};
+
+template struct utf16_kernels<false>;
+template struct utf16_kernels<true>;
+
+using utf16be_kernels = utf16_kernels<! host_is_big_endian>;
+using utf16le_kernels = utf16_kernels<host_is_big_endian>;
+
+// Validates a byte sequence of either length.  A trailing odd byte is an
+// incomplete code unit.
+template<typename Kernels>
+validate_result utf16_validate_bytes(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    const unsigned char *even_last = first + ((last - first) & ~1);
+    validate_result r = Kernels::validate(first, even_last);
+    if (r.status == decode_status::no_error && even_last != last) {
+        r.status = decode_status::underflow;
+    }
+    return r;
+}
+
+// Decodes a byte sequence of either length.  A trailing odd byte is an
+// incomplete code unit.
+template<typename Kernels>
+decode_n_result utf16_decode_n_bytes(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept
+{
+    const unsigned char *even_last = in_first + ((in_last - in_first) & ~1);
+    decode_n_result r = Kernels::decode_n(
+        in_first, even_last, out_first, out_last);
+    if (r.status == decode_status::no_error &&
+        in_first + r.code_units == even_last &&
+        even_last != in_last &&
+        out_first + r.code_points != out_last)
+    {
+        r.status = decode_status::underflow;
+    }
+    return r;
+}
+
+
+// Measures code point sequences for utf16_encode_n_with().
+template<char32_t max_code_point>
+encode_n_result utf16_encoded_length_with(
+    const char32_t *first,
+    const char32_t *last) noexcept
+{
+    const char32_t *next = first;
+    std::ptrdiff_t length = 0;
+    encode_status es = encode_status::no_error;
+    for (; next != last; ++next) {
+        if ((*next >= 0xD800 && *next <= 0xDFFF) || *next > max_code_point) {
+            es = encode_status::invalid_character;
+            break;
+        }
+        length += *next <= 0xFFFF ? 1 : 2;
+    }
+    return { next - first, length, es };
+}
+
+
+} // unnamed namespace
+
+
+decode_n_result utf16_count_code_points(
+    const char16_t *first,
+    const char16_t *last) noexcept
+{
+    return utf16_count_code_points_kernels(first, last);
+}
+
+const char16_t* utf16_find_surrogate(
+    const char16_t *first,
+    const char16_t *last) noexcept
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char*>(first);
+    return first + (utf16_kernels<false>::find_surrogate(
+                        bytes,
+                        reinterpret_cast<const unsigned char*>(last))
+                    - bytes) / 2;
+}
+
+validate_result utf16_validate(
+    const char16_t *first,
+    const char16_t *last) noexcept
+{
+    validate_result r = utf16_kernels<false>::validate(
+        reinterpret_cast<const unsigned char*>(first),
+        reinterpret_cast<const unsigned char*>(last));
+    r.code_units /= 2;
+    return r;
+}
+
+decode_n_result utf16_decode_n(
+    const char16_t *in_first,
+    const char16_t *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept
+{
+    decode_n_result r = utf16_kernels<false>::decode_n(
+        reinterpret_cast<const unsigned char*>(in_first),
+        reinterpret_cast<const unsigned char*>(in_last),
+        out_first,
+        out_last);
+    r.code_units /= 2;
+    return r;
+}
+
+encode_n_result utf16_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    char16_t *out_first,
+    char16_t *out_last) noexcept
+{
+    encode_n_result r = utf16_kernels<false>::encode_n_strict(
+        in_first,
+        in_last,
+        reinterpret_cast<unsigned char*>(out_first),
+        reinterpret_cast<unsigned char*>(out_last));
+    r.code_units /= 2;
+    return r;
+}
+
+validate_result utf16be_validate(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    return utf16_validate_bytes<utf16be_kernels>(first, last);
+}
+
+validate_result utf16le_validate(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    return utf16_validate_bytes<utf16le_kernels>(first, last);
+}
+
+decode_n_result utf16be_decode_n(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept
+{
+    return utf16_decode_n_bytes<utf16be_kernels>(
+        in_first, in_last, out_first, out_last);
+}
+
+decode_n_result utf16le_decode_n(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept
+{
+    return utf16_decode_n_bytes<utf16le_kernels>(
+        in_first, in_last, out_first, out_last);
+}
+
+encode_n_result utf16be_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return utf16be_kernels::encode_n(in_first, in_last, out_first, out_last);
+}
+
+encode_n_result utf16le_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return utf16le_kernels::encode_n(in_first, in_last, out_first, out_last);
+}
+
+encode_n_result utf16be_encode_n_strict(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return utf16be_kernels::encode_n_strict(
+        in_first, in_last, out_first, out_last);
+}
+
+encode_n_result utf16le_encode_n_strict(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return utf16le_kernels::encode_n_strict(
+        in_first, in_last, out_first, out_last);
+}
+
+encode_n_result utf16_encoded_length(
+    const char32_t *first,
+    const char32_t *last) noexcept
+{
+    return utf16_encoded_length_with<0xFFFFFFFF>(first, last);
+}
+
+encode_n_result utf16_encoded_length_strict(
+    const char32_t *first,
+    const char32_t *last) noexcept
+{
+    return utf16_encoded_length_with<0x10FFFF>(first, last);
+}
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
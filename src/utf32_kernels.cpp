@@ -0,0 +1,224 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <text_view_detail/codecs/utf32_kernels.hpp>
+#include <text_view_detail/kernel_dispatch.hpp>
+#include <text_view_detail/error_status.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+namespace {
+
+// The UTF-32BE and UTF-32LE codecs accept every 32-bit code unit, so decoding
+// and encoding only copy code units, reversing their bytes when the byte
+// order differs from that of the host.
+constexpr bool host_is_big_endian =
+    __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+
+using utf32_swap_function =
+    void (*)(const unsigned char*, unsigned char*, std::ptrdiff_t);
+
+// Copies 'count' 32-bit code units from 'in' to 'out', reversing the bytes of
+// each.
+void utf32_swap_scalar(
+    const unsigned char *in,
+    unsigned char *out,
+    std::ptrdiff_t count) noexcept
+{
+    for (; count != 0; --count, in += 4, out += 4) {
+        std::uint32_t cu;
+        std::memcpy(&cu, in, sizeof(cu));
+        cu = __builtin_bswap32(cu);
+        std::memcpy(out, &cu, sizeof(cu));
+    }
+}
+
+void utf32_copy(
+    const unsigned char *in,
+    unsigned char *out,
+    std::ptrdiff_t count) noexcept
+{
+    if (count != 0) {
+        std::memcpy(out, in, 4 * count);
+    }
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// The vectorized implementations reverse the bytes of 4, 8, or 16 code units
+// at a time.  SSE2 lacks a byte shuffle; the 16-bit halves of each code unit
+// are exchanged, followed by the bytes of each half.
+
+__attribute__((target("sse2")))
+void utf32_swap_sse2(
+    const unsigned char *in,
+    unsigned char *out,
+    std::ptrdiff_t count) noexcept
+{
+    for (; count >= 4; count -= 4, in += 16, out += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xB1), 0xB1);
+        x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), x);
+    }
+    utf32_swap_scalar(in, out, count);
+}
+
+__attribute__((target("avx2")))
+void utf32_swap_avx2(
+    const unsigned char *in,
+    unsigned char *out,
+    std::ptrdiff_t count) noexcept
+{
+    const __m256i reverse = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    for (; count >= 8; count -= 8, in += 32, out += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+                            _mm256_shuffle_epi8(x, reverse));
+    }
+    utf32_swap_scalar(in, out, count);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void utf32_swap_avx512(
+    const unsigned char *in,
+    unsigned char *out,
+    std::ptrdiff_t count) noexcept
+{
+    const __m512i reverse = _mm512_set4_epi32(
+        0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203);
+    for (; count >= 16; count -= 16, in += 64, out += 64) {
+        __m512i x = _mm512_loadu_si512(in);
+        _mm512_storeu_si512(out, _mm512_shuffle_epi8(x, reverse));
+    }
+    utf32_swap_scalar(in, out, count);
+}
+
+#endif // x86
+
+
+kernel_dispatcher<utf32_swap_function> utf32_swap_kernels{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx512bw, utf32_swap_avx512 },
+    { simd_level::avx2, utf32_swap_avx2 },
+    { simd_level::sse2, utf32_swap_sse2 },
+#endif
+    { simd_level::scalar, utf32_swap_scalar }};
+
+template<bool swap>
+void utf32_copy_code_units(
+    const unsigned char *in,
+    unsigned char *out,
+    std::ptrdiff_t count) noexcept
+{
+    if (swap) {
+        utf32_swap_kernels(in, out, count);
+    } else {
+        utf32_copy(in, out, count);
+    }
+}
+
+// A trailing partial code unit is reported as an underflow if the output has
+// space for the code point it would begin.
+template<bool swap>
+decode_n_result utf32_decode_n(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept
+{
+    std::ptrdiff_t available = (in_last - in_first) / 4;
+    std::ptrdiff_t count = std::min(available, out_last - out_first);
+    utf32_copy_code_units<swap>(
+        in_first, reinterpret_cast<unsigned char*>(out_first), count);
+    decode_status ds = decode_status::no_error;
+    if (count == available &&
+        in_first + 4 * count != in_last &&
+        out_first + count != out_last)
+    {
+        ds = decode_status::underflow;
+    }
+    return { 4 * count, count, ds };
+}
+
+template<bool swap>
+encode_n_result utf32_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    std::ptrdiff_t count = std::min(in_last - in_first,
+                                    (out_last - out_first) / 4);
+    utf32_copy_code_units<swap>(
+        reinterpret_cast<const unsigned char*>(in_first), out_first, count);
+    return { count, 4 * count, encode_status::no_error };
+}
+
+} // unnamed namespace
+
+
+decode_n_result utf32be_decode_n(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept
+{
+    return utf32_decode_n<! host_is_big_endian>(
+        in_first, in_last, out_first, out_last);
+}
+
+decode_n_result utf32le_decode_n(
+    const unsigned char *in_first,
+    const unsigned char *in_last,
+    char32_t *out_first,
+    char32_t *out_last) noexcept
+{
+    return utf32_decode_n<host_is_big_endian>(
+        in_first, in_last, out_first, out_last);
+}
+
+encode_n_result utf32be_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return utf32_encode_n<! host_is_big_endian>(
+        in_first, in_last, out_first, out_last);
+}
+
+encode_n_result utf32le_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return utf32_encode_n<host_is_big_endian>(
+        in_first, in_last, out_first, out_last);
+}
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
@@ -0,0 +1,856 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <text_view_detail/character_set_info.hpp>
+#include <text_view_detail/character.hpp>
+#include <text_view_detail/charsets/unicode_charsets.hpp>
+#include <text_view_detail/codecs/codec_util.hpp>
+#include <text_view_detail/codecs/utf8_codec.hpp>
+#include <text_view_detail/codecs/utf8_kernels.hpp>
+#include <text_view_detail/kernel_dispatch.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+namespace std {
+namespace experimental {
+inline namespace text {
+namespace text_detail {
+
+
+namespace {
+
+using scalar_utf8_codec =
+    utf8_codec<character<unicode_character_set>, unsigned char>;
+
+validate_result utf8_validate_scalar(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    return validate_by_decode_n<scalar_utf8_codec>(first, last);
+}
+
+// Returns the position at which scalar validation may resume when the
+// vectorized implementations stop at 'next'.  Code unit sequences are at most
+// four code units long, so a sequence that is incomplete at 'next' begins
+// within the three code units that precede it.  All code units before the
+// returned position are known to be well-formed.
+const unsigned char* utf8_resume_point(
+    const unsigned char *first,
+    const unsigned char *next) noexcept
+{
+    const unsigned char *resume = next - first < 3 ? first : next - 3;
+    while (resume != next && (*resume & 0xC0) == 0x80) {
+        ++resume;
+    }
+    return resume;
+}
+
+validate_result utf8_validate_scalar_from(
+    const unsigned char *first,
+    const unsigned char *next,
+    const unsigned char *last) noexcept
+{
+    const unsigned char *resume = utf8_resume_point(first, next);
+    validate_result result = utf8_validate_scalar(resume, last);
+    result.code_units += resume - first;
+    return result;
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// The vectorized validators implement the lookup table algorithm described
+// by John Keiser and Daniel Lemire in "Validating UTF-8 In Less Than One
+// Instruction Per Byte".  Each code unit is classified by table lookups
+// indexed by the high and low nibbles of the preceding code unit and the high
+// nibble of the code unit itself; the resulting error bits are combined with
+// a check that the second and third code units following a 3 or 4 code unit
+// leading code unit are continuation code units.  The checks correspond to
+// the rules of Unicode 9.0, table 3-7, that utf8_codec enforces.  The
+// vectorized code only detects that an error occurred within a block of code
+// units; the scalar implementation is used to determine its exact location.
+constexpr std::uint8_t too_short      = 1 << 0;
+constexpr std::uint8_t too_long       = 1 << 1;
+constexpr std::uint8_t overlong_3     = 1 << 2;
+constexpr std::uint8_t too_large      = 1 << 3;
+constexpr std::uint8_t surrogate      = 1 << 4;
+constexpr std::uint8_t overlong_2     = 1 << 5;
+constexpr std::uint8_t too_large_1000 = 1 << 6;
+constexpr std::uint8_t overlong_4     = 1 << 6;
+constexpr std::uint8_t two_conts      = 1 << 7;
+constexpr std::uint8_t carry          = too_short | too_long | two_conts;
+
+// Indexed by the high nibble of the preceding code unit.
+alignas(16) const std::uint8_t utf8_byte_1_high[16] = {
+    // 0_______ ASCII
+    too_long, too_long, too_long, too_long,
+    too_long, too_long, too_long, too_long,
+    // 10______ continuation
+    two_conts, two_conts, two_conts, two_conts,
+    // 1100____ 2 code unit leading code unit
+    too_short | overlong_2,
+    // 1101____ 2 code unit leading code unit
+    too_short,
+    // 1110____ 3 code unit leading code unit
+    too_short | overlong_3 | surrogate,
+    // 1111____ 4 code unit leading code unit
+    too_short | too_large | too_large_1000 | overlong_4
+};
+
+// Indexed by the low nibble of the preceding code unit.
+alignas(16) const std::uint8_t utf8_byte_1_low[16] = {
+    // ____0000
+    carry | overlong_3 | overlong_2 | overlong_4,
+    // ____0001
+    carry | overlong_2,
+    // ____001_
+    carry,
+    carry,
+    // ____0100
+    carry | too_large,
+    // ____0101
+    carry | too_large | too_large_1000,
+    // ____011_
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    // ____1___
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    // ____1101
+    carry | too_large | too_large_1000 | surrogate,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000
+};
+
+// Indexed by the high nibble of the current code unit.
+alignas(16) const std::uint8_t utf8_byte_2_high[16] = {
+    // 0_______ ASCII
+    too_short, too_short, too_short, too_short,
+    too_short, too_short, too_short, too_short,
+    // 1000____
+    too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 |
+        overlong_4,
+    // 1001____
+    too_long | overlong_2 | two_conts | overlong_3 | too_large,
+    // 101_____
+    too_long | overlong_2 | two_conts | surrogate | too_large,
+    too_long | overlong_2 | two_conts | surrogate | too_large,
+    // 11______ leading code unit
+    too_short, too_short, too_short, too_short
+};
+
+// Code units greater than these values at the end of a block begin a code
+// unit sequence that continues in the next block.  Vectors of each width are
+// loaded from the end of the array.
+alignas(64) const std::uint8_t utf8_incomplete_max[64] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+};
+
+
+__attribute__((target("sse4.2")))
+__m128i utf8_check_block_sse42(
+    __m128i input,
+    __m128i prev_input) noexcept
+{
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    __m128i prev1 = _mm_alignr_epi8(input, prev_input, 16 - 1);
+    __m128i prev2 = _mm_alignr_epi8(input, prev_input, 16 - 2);
+    __m128i prev3 = _mm_alignr_epi8(input, prev_input, 16 - 3);
+
+    __m128i byte_1_high = _mm_shuffle_epi8(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(utf8_byte_1_high)),
+        _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble));
+    __m128i byte_1_low = _mm_shuffle_epi8(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(utf8_byte_1_low)),
+        _mm_and_si128(prev1, low_nibble));
+    __m128i byte_2_high = _mm_shuffle_epi8(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(utf8_byte_2_high)),
+        _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble));
+    __m128i special_cases =
+        _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    __m128i is_third = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+    __m128i is_fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80));
+    __m128i must_be_continuation = _mm_and_si128(
+        _mm_or_si128(is_third, is_fourth),
+        _mm_set1_epi8(static_cast<char>(0x80)));
+
+    return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+__attribute__((target("sse4.2")))
+validate_result utf8_validate_sse42(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    const __m128i incomplete_max = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(utf8_incomplete_max + 64 - 16));
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    const unsigned char *next = first;
+    while (last - next >= 16) {
+        __m128i input =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(next));
+        __m128i error;
+        if (_mm_movemask_epi8(input) == 0) {
+            error = prev_incomplete;
+            prev_incomplete = _mm_setzero_si128();
+        } else {
+            error = utf8_check_block_sse42(input, prev_input);
+            prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+        }
+        if (! _mm_testz_si128(error, error)) {
+            break;
+        }
+        prev_input = input;
+        next += 16;
+    }
+    return utf8_validate_scalar_from(first, next, last);
+}
+
+
+__attribute__((target("avx2")))
+__m256i utf8_check_block_avx2(
+    __m256i input,
+    __m256i prev_input) noexcept
+{
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+    __m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+    __m256i prev1 = _mm256_alignr_epi8(input, shifted, 16 - 1);
+    __m256i prev2 = _mm256_alignr_epi8(input, shifted, 16 - 2);
+    __m256i prev3 = _mm256_alignr_epi8(input, shifted, 16 - 3);
+
+    __m256i byte_1_high = _mm256_shuffle_epi8(
+        _mm256_broadcastsi128_si256(_mm_load_si128(
+            reinterpret_cast<const __m128i*>(utf8_byte_1_high))),
+        _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble));
+    __m256i byte_1_low = _mm256_shuffle_epi8(
+        _mm256_broadcastsi128_si256(_mm_load_si128(
+            reinterpret_cast<const __m128i*>(utf8_byte_1_low))),
+        _mm256_and_si256(prev1, low_nibble));
+    __m256i byte_2_high = _mm256_shuffle_epi8(
+        _mm256_broadcastsi128_si256(_mm_load_si128(
+            reinterpret_cast<const __m128i*>(utf8_byte_2_high))),
+        _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble));
+    __m256i special_cases = _mm256_and_si256(
+        _mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+    __m256i is_third =
+        _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80));
+    __m256i is_fourth =
+        _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80));
+    __m256i must_be_continuation = _mm256_and_si256(
+        _mm256_or_si256(is_third, is_fourth),
+        _mm256_set1_epi8(static_cast<char>(0x80)));
+
+    return _mm256_xor_si256(must_be_continuation, special_cases);
+}
+
+__attribute__((target("avx2")))
+validate_result utf8_validate_avx2(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    const __m256i incomplete_max = _mm256_load_si256(
+        reinterpret_cast<const __m256i*>(utf8_incomplete_max + 64 - 32));
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    const unsigned char *next = first;
+    while (last - next >= 32) {
+        __m256i input =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(next));
+        __m256i error;
+        if (_mm256_movemask_epi8(input) == 0) {
+            error = prev_incomplete;
+            prev_incomplete = _mm256_setzero_si256();
+        } else {
+            error = utf8_check_block_avx2(input, prev_input);
+            prev_incomplete = _mm256_subs_epu8(input, incomplete_max);
+        }
+        if (! _mm256_testz_si256(error, error)) {
+            break;
+        }
+        prev_input = input;
+        next += 32;
+    }
+    return utf8_validate_scalar_from(first, next, last);
+}
+
+
+__attribute__((target("avx512f,avx512bw")))
+__m512i utf8_check_block_avx512(
+    __m512i input,
+    __m512i prev_input) noexcept
+{
+    const __m512i low_nibble = _mm512_set1_epi8(0x0F);
+    // Each 128-bit lane of 'shifted' holds the lane that precedes the
+    // corresponding lane of 'input'.  The zero-masking forms of the
+    // intrinsics are used here and below to avoid operands with undefined
+    // contents.
+    __m512i shifted = _mm512_maskz_alignr_epi64(0xFF, input, prev_input, 6);
+    __m512i prev1 = _mm512_alignr_epi8(input, shifted, 16 - 1);
+    __m512i prev2 = _mm512_alignr_epi8(input, shifted, 16 - 2);
+    __m512i prev3 = _mm512_alignr_epi8(input, shifted, 16 - 3);
+
+    __m512i byte_1_high = _mm512_shuffle_epi8(
+        _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_load_si128(
+            reinterpret_cast<const __m128i*>(utf8_byte_1_high))),
+        _mm512_and_si512(_mm512_srli_epi16(prev1, 4), low_nibble));
+    __m512i byte_1_low = _mm512_shuffle_epi8(
+        _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_load_si128(
+            reinterpret_cast<const __m128i*>(utf8_byte_1_low))),
+        _mm512_and_si512(prev1, low_nibble));
+    __m512i byte_2_high = _mm512_shuffle_epi8(
+        _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_load_si128(
+            reinterpret_cast<const __m128i*>(utf8_byte_2_high))),
+        _mm512_and_si512(_mm512_srli_epi16(input, 4), low_nibble));
+    __m512i special_cases = _mm512_and_si512(
+        _mm512_and_si512(byte_1_high, byte_1_low), byte_2_high);
+
+    __m512i is_third =
+        _mm512_subs_epu8(prev2, _mm512_set1_epi8(0xE0 - 0x80));
+    __m512i is_fourth =
+        _mm512_subs_epu8(prev3, _mm512_set1_epi8(0xF0 - 0x80));
+    __m512i must_be_continuation = _mm512_and_si512(
+        _mm512_or_si512(is_third, is_fourth),
+        _mm512_set1_epi8(static_cast<char>(0x80)));
+
+    return _mm512_xor_si512(must_be_continuation, special_cases);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+validate_result utf8_validate_avx512(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    const __m512i incomplete_max = _mm512_load_si512(utf8_incomplete_max);
+    __m512i prev_input = _mm512_setzero_si512();
+    __m512i prev_incomplete = _mm512_setzero_si512();
+    const unsigned char *next = first;
+    while (last - next >= 64) {
+        __m512i input = _mm512_loadu_si512(next);
+        __m512i error;
+        if (_mm512_movepi8_mask(input) == 0) {
+            error = prev_incomplete;
+            prev_incomplete = _mm512_setzero_si512();
+        } else {
+            error = utf8_check_block_avx512(input, prev_input);
+            prev_incomplete = _mm512_subs_epu8(input, incomplete_max);
+        }
+        if (_mm512_test_epi8_mask(error, error) != 0) {
+            break;
+        }
+        prev_input = input;
+        next += 64;
+    }
+    return utf8_validate_scalar_from(first, next, last);
+}
+
+#endif // x86
+
+
+using utf8_validate_function =
+    validate_result (*)(const unsigned char*, const unsigned char*);
+
+kernel_dispatcher<utf8_validate_function> utf8_validate_kernels{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx512bw, utf8_validate_avx512 },
+    { simd_level::avx2, utf8_validate_avx2 },
+    { simd_level::sse4_2, utf8_validate_sse42 },
+#endif
+    { simd_level::scalar, utf8_validate_scalar }};
+
+
+// Counts the code units of a well-formed UTF-8 sequence that are not
+// continuation code units; each begins exactly one code point.
+std::ptrdiff_t utf8_count_leading_scalar(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    std::ptrdiff_t count = 0;
+    for (; first != last; ++first) {
+        count += (*first & 0xC0) != 0x80;
+    }
+    return count;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Continuation code units, [0x80, 0xBF], are exactly the code units that are
+// less than -0x40 when interpreted as signed 8-bit integers.  Comparison
+// results are accumulated in 8-bit lane counters that are summed with a sum
+// of absolute differences before they can overflow.
+__attribute__((target("sse2")))
+std::ptrdiff_t utf8_count_leading_sse2(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    std::ptrdiff_t count = 0;
+    const __m128i limit = _mm_set1_epi8(-0x41);
+    while (last - first >= 16) {
+        std::ptrdiff_t blocks =
+            std::min<std::ptrdiff_t>((last - first) / 16, 255);
+        __m128i counts = _mm_setzero_si128();
+        for (; blocks > 0; --blocks, first += 16) {
+            __m128i input = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(first));
+            counts = _mm_sub_epi8(counts, _mm_cmpgt_epi8(input, limit));
+        }
+        __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+        count += _mm_cvtsi128_si32(sums) +
+                 _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    }
+    return count + utf8_count_leading_scalar(first, last);
+}
+
+__attribute__((target("avx2")))
+std::ptrdiff_t utf8_count_leading_avx2(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    std::ptrdiff_t count = 0;
+    const __m256i limit = _mm256_set1_epi8(-0x41);
+    while (last - first >= 32) {
+        std::ptrdiff_t blocks =
+            std::min<std::ptrdiff_t>((last - first) / 32, 255);
+        __m256i counts = _mm256_setzero_si256();
+        for (; blocks > 0; --blocks, first += 32) {
+            __m256i input = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(first));
+            counts = _mm256_sub_epi8(counts, _mm256_cmpgt_epi8(input, limit));
+        }
+        __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+        __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums),
+                                     _mm256_extracti128_si256(sums, 1));
+        count += _mm_cvtsi128_si32(half) +
+                 _mm_cvtsi128_si32(_mm_srli_si128(half, 8));
+    }
+    return count + utf8_count_leading_scalar(first, last);
+}
+
+#endif // x86
+
+
+using utf8_count_leading_function =
+    std::ptrdiff_t (*)(const unsigned char*, const unsigned char*);
+
+kernel_dispatcher<utf8_count_leading_function> utf8_count_leading_kernels{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx2, utf8_count_leading_avx2 },
+    { simd_level::sse2, utf8_count_leading_sse2 },
+#endif
+    { simd_level::scalar, utf8_count_leading_scalar }};
+
+
+// Returns the number of code units required to encode 'cp', or 0 if 'cp' is
+// a surrogate code point or is outside the Unicode code space and therefore
+// cannot be encoded.
+inline int utf8_encoded_code_units(char32_t cp) noexcept {
+    if (cp <= 0x7F) {
+        return 1;
+    }
+    if (cp <= 0x7FF) {
+        return 2;
+    }
+    if (cp <= 0xFFFF) {
+        return (cp >= 0xD800 && cp <= 0xDFFF) ? 0 : 3;
+    }
+    if (cp <= 0x10FFFF) {
+        return 4;
+    }
+    return 0;
+}
+
+// Encodes 'cp' as the 'n' code units previously determined by
+// utf8_encoded_code_units().
+inline unsigned char* utf8_encode_code_point(
+    char32_t cp,
+    int n,
+    unsigned char *out) noexcept
+{
+    switch (n) {
+    case 1:
+        *out++ = static_cast<unsigned char>(cp);
+        break;
+    case 2:
+        *out++ = static_cast<unsigned char>(0xC0 + ((cp >> 6) & 0x1F));
+        *out++ = static_cast<unsigned char>(0x80 + (cp & 0x3F));
+        break;
+    case 3:
+        *out++ = static_cast<unsigned char>(0xE0 + ((cp >> 12) & 0x0F));
+        *out++ = static_cast<unsigned char>(0x80 + ((cp >> 6) & 0x3F));
+        *out++ = static_cast<unsigned char>(0x80 + (cp & 0x3F));
+        break;
+    default:
+        *out++ = static_cast<unsigned char>(0xF0 + ((cp >> 18) & 0x07));
+        *out++ = static_cast<unsigned char>(0x80 + ((cp >> 12) & 0x3F));
+        *out++ = static_cast<unsigned char>(0x80 + ((cp >> 6) & 0x3F));
+        *out++ = static_cast<unsigned char>(0x80 + (cp & 0x3F));
+        break;
+    }
+    return out;
+}
+
+encode_n_result utf8_encode_n_scalar(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    const char32_t *in_next = in_first;
+    unsigned char *out_next = out_first;
+    encode_status es = encode_status::no_error;
+    for (; in_next != in_last; ++in_next) {
+        int n = utf8_encoded_code_units(*in_next);
+        if (n == 0) {
+            es = encode_status::invalid_character;
+            break;
+        }
+        if (out_last - out_next < n) {
+            break;
+        }
+        out_next = utf8_encode_code_point(*in_next, n, out_next);
+    }
+    return { in_next - in_first, out_next - out_first, es };
+}
+
+encode_n_result utf8_encoded_length_scalar(
+    const char32_t *first,
+    const char32_t *last) noexcept
+{
+    std::ptrdiff_t length = 0;
+    for (const char32_t *next = first; next != last; ++next) {
+        int n = utf8_encoded_code_units(*next);
+        if (n == 0) {
+            return { next - first, length, encode_status::invalid_character };
+        }
+        length += n;
+    }
+    return { last - first, length, encode_status::no_error };
+}
+
+// Encodes the code points [next, last) that follow a prefix of 'consumed'
+// code points encoded as 'written' code units by a vectorized implementation.
+encode_n_result utf8_encode_n_scalar_from(
+    const char32_t *next,
+    const char32_t *last,
+    unsigned char *out_next,
+    unsigned char *out_last,
+    std::ptrdiff_t consumed,
+    std::ptrdiff_t written) noexcept
+{
+    encode_n_result result =
+        utf8_encode_n_scalar(next, last, out_next, out_last);
+    result.code_points += consumed;
+    result.code_units += written;
+    return result;
+}
+
+encode_n_result utf8_encoded_length_scalar_from(
+    const char32_t *next,
+    const char32_t *last,
+    std::ptrdiff_t measured,
+    std::ptrdiff_t length) noexcept
+{
+    encode_n_result result = utf8_encoded_length_scalar(next, last);
+    result.code_points += measured;
+    result.code_units += length;
+    return result;
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// The vectorized encoders copy blocks of code points that are all ASCII with
+// pack instructions and encode the code points of other blocks individually.
+// The vectorized measuring functions classify a block of code points with
+// comparisons; a code point requires one code unit plus one for each of the
+// thresholds 0x7F, 0x7FF, and 0xFFFF that it exceeds.  Lane counts are
+// flushed to a scalar total before they can overflow.  Blocks that contain a
+// surrogate code point or a value above 0x10FFFF are left to the scalar
+// implementation so that the error is reported at its exact offset.
+constexpr std::ptrdiff_t utf8_length_flush_interval = 1 << 20;
+
+__attribute__((target("sse4.2")))
+bool utf8_has_invalid_code_point_sse42(__m128i cp) noexcept {
+    __m128i surrogate = _mm_cmpeq_epi32(
+        _mm_and_si128(cp, _mm_set1_epi32(0xFFFFF800)),
+        _mm_set1_epi32(0xD800));
+    __m128i in_range = _mm_cmpeq_epi32(
+        _mm_min_epu32(cp, _mm_set1_epi32(0x10FFFF)), cp);
+    return ! _mm_testc_si128(_mm_andnot_si128(surrogate, in_range),
+                             _mm_set1_epi32(-1));
+}
+
+__attribute__((target("sse4.2")))
+std::ptrdiff_t utf8_sum_lanes_sse42(__m128i lanes) noexcept {
+    alignas(16) std::uint32_t counts[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(counts), lanes);
+    return std::ptrdiff_t(counts[0]) + counts[1] + counts[2] + counts[3];
+}
+
+__attribute__((target("sse4.2")))
+encode_n_result utf8_encoded_length_sse42(
+    const char32_t *first,
+    const char32_t *last) noexcept
+{
+    const char32_t *next = first;
+    std::ptrdiff_t length = 0;
+    while (last - next >= 4) {
+        std::ptrdiff_t blocks =
+            std::min<std::ptrdiff_t>((last - next) / 4,
+                                     utf8_length_flush_interval);
+        __m128i extra = _mm_setzero_si128();
+        for (; blocks > 0; --blocks) {
+            __m128i cp = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(next));
+            if (utf8_has_invalid_code_point_sse42(cp)) {
+                break;
+            }
+            // Comparison results are -1 for lanes above each threshold.
+            extra = _mm_sub_epi32(extra,
+                _mm_cmpgt_epi32(cp, _mm_set1_epi32(0x7F)));
+            extra = _mm_sub_epi32(extra,
+                _mm_cmpgt_epi32(cp, _mm_set1_epi32(0x7FF)));
+            extra = _mm_sub_epi32(extra,
+                _mm_cmpgt_epi32(cp, _mm_set1_epi32(0xFFFF)));
+            length += 4;
+            next += 4;
+        }
+        length += utf8_sum_lanes_sse42(extra);
+        if (blocks != 0) {
+            break;
+        }
+    }
+    return utf8_encoded_length_scalar_from(next, last, next - first, length);
+}
+
+__attribute__((target("sse4.2")))
+encode_n_result utf8_encode_n_sse42(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    const char32_t *in_next = in_first;
+    unsigned char *out_next = out_first;
+    // Every code point of a block fits when there is room for four code
+    // units per code point.
+    while (in_last - in_next >= 4 && out_last - out_next >= 16) {
+        __m128i cp = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(in_next));
+        if (_mm_testz_si128(cp, _mm_set1_epi32(~0x7F))) {
+            __m128i units = _mm_packus_epi16(_mm_packus_epi32(cp, cp),
+                                             _mm_setzero_si128());
+            std::uint32_t block = _mm_cvtsi128_si32(units);
+            std::memcpy(out_next, &block, sizeof(block));
+            in_next += 4;
+            out_next += 4;
+            continue;
+        }
+        for (const char32_t *block_last = in_next + 4;
+             in_next != block_last;
+             ++in_next)
+        {
+            int n = utf8_encoded_code_units(*in_next);
+            if (n == 0) {
+                return { in_next - in_first,
+                         out_next - out_first,
+                         encode_status::invalid_character };
+            }
+            out_next = utf8_encode_code_point(*in_next, n, out_next);
+        }
+    }
+    return utf8_encode_n_scalar_from(
+        in_next, in_last, out_next, out_last,
+        in_next - in_first, out_next - out_first);
+}
+
+
+__attribute__((target("avx2")))
+bool utf8_has_invalid_code_point_avx2(__m256i cp) noexcept {
+    __m256i surrogate = _mm256_cmpeq_epi32(
+        _mm256_and_si256(cp, _mm256_set1_epi32(0xFFFFF800)),
+        _mm256_set1_epi32(0xD800));
+    __m256i in_range = _mm256_cmpeq_epi32(
+        _mm256_min_epu32(cp, _mm256_set1_epi32(0x10FFFF)), cp);
+    return ! _mm256_testc_si256(_mm256_andnot_si256(surrogate, in_range),
+                                _mm256_set1_epi32(-1));
+}
+
+__attribute__((target("avx2")))
+std::ptrdiff_t utf8_sum_lanes_avx2(__m256i lanes) noexcept {
+    alignas(32) std::uint32_t counts[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(counts), lanes);
+    std::ptrdiff_t sum = 0;
+    for (std::uint32_t count : counts) {
+        sum += count;
+    }
+    return sum;
+}
+
+__attribute__((target("avx2")))
+encode_n_result utf8_encoded_length_avx2(
+    const char32_t *first,
+    const char32_t *last) noexcept
+{
+    const char32_t *next = first;
+    std::ptrdiff_t length = 0;
+    while (last - next >= 8) {
+        std::ptrdiff_t blocks =
+            std::min<std::ptrdiff_t>((last - next) / 8,
+                                     utf8_length_flush_interval);
+        __m256i extra = _mm256_setzero_si256();
+        for (; blocks > 0; --blocks) {
+            __m256i cp = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(next));
+            if (utf8_has_invalid_code_point_avx2(cp)) {
+                break;
+            }
+            // Comparison results are -1 for lanes above each threshold.
+            extra = _mm256_sub_epi32(extra,
+                _mm256_cmpgt_epi32(cp, _mm256_set1_epi32(0x7F)));
+            extra = _mm256_sub_epi32(extra,
+                _mm256_cmpgt_epi32(cp, _mm256_set1_epi32(0x7FF)));
+            extra = _mm256_sub_epi32(extra,
+                _mm256_cmpgt_epi32(cp, _mm256_set1_epi32(0xFFFF)));
+            length += 8;
+            next += 8;
+        }
+        length += utf8_sum_lanes_avx2(extra);
+        if (blocks != 0) {
+            break;
+        }
+    }
+    return utf8_encoded_length_scalar_from(next, last, next - first, length);
+}
+
+__attribute__((target("avx2")))
+encode_n_result utf8_encode_n_avx2(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    const char32_t *in_next = in_first;
+    unsigned char *out_next = out_first;
+    // Every code point of a block fits when there is room for four code
+    // units per code point.
+    while (in_last - in_next >= 8 && out_last - out_next >= 32) {
+        __m256i cp = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(in_next));
+        if (_mm256_testz_si256(cp, _mm256_set1_epi32(~0x7F))) {
+            // The packs operate within 128-bit lanes; the low four code
+            // units of each lane are gathered into the low eight bytes.
+            __m256i units = _mm256_packus_epi16(_mm256_packus_epi32(cp, cp),
+                                                _mm256_setzero_si256());
+            units = _mm256_permutevar8x32_epi32(
+                units, _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out_next),
+                             _mm256_castsi256_si128(units));
+            in_next += 8;
+            out_next += 8;
+            continue;
+        }
+        for (const char32_t *block_last = in_next + 8;
+             in_next != block_last;
+             ++in_next)
+        {
+            int n = utf8_encoded_code_units(*in_next);
+            if (n == 0) {
+                return { in_next - in_first,
+                         out_next - out_first,
+                         encode_status::invalid_character };
+            }
+            out_next = utf8_encode_code_point(*in_next, n, out_next);
+        }
+    }
+    return utf8_encode_n_scalar_from(
+        in_next, in_last, out_next, out_last,
+        in_next - in_first, out_next - out_first);
+}
+
+#endif // x86
+
+
+using utf8_encode_n_function =
+    encode_n_result (*)(const char32_t*, const char32_t*,
+                        unsigned char*, unsigned char*);
+using utf8_encoded_length_function =
+    encode_n_result (*)(const char32_t*, const char32_t*);
+
+kernel_dispatcher<utf8_encode_n_function> utf8_encode_n_kernels{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx2, utf8_encode_n_avx2 },
+    { simd_level::sse4_2, utf8_encode_n_sse42 },
+#endif
+    { simd_level::scalar, utf8_encode_n_scalar }};
+
+kernel_dispatcher<utf8_encoded_length_function> utf8_encoded_length_kernels{
+#if defined(__x86_64__) || defined(__i386__)
+    { simd_level::avx2, utf8_encoded_length_avx2 },
+    { simd_level::sse4_2, utf8_encoded_length_sse42 },
+#endif
+    { simd_level::scalar, utf8_encoded_length_scalar }};
+
+} // unnamed namespace
+
+
+validate_result utf8_validate(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    return utf8_validate_kernels(first, last);
+}
+
+decode_n_result utf8_count_code_points(
+    const unsigned char *first,
+    const unsigned char *last) noexcept
+{
+    validate_result r = utf8_validate(first, last);
+    return { r.code_units,
+             utf8_count_leading_kernels(first, first + r.code_units),
+             r.status };
+}
+
+encode_n_result utf8_encode_n(
+    const char32_t *in_first,
+    const char32_t *in_last,
+    unsigned char *out_first,
+    unsigned char *out_last) noexcept
+{
+    return utf8_encode_n_kernels(in_first, in_last, out_first, out_last);
+}
+
+encode_n_result utf8_encoded_length(
+    const char32_t *first,
+    const char32_t *last) noexcept
+{
+    return utf8_encoded_length_kernels(first, last);
+}
+
+
+} // namespace text_detail
+} // inline namespace text
+} // namespace experimental
+} // namespace std
@@ -0,0 +1,1531 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+// Ensure assert is enabled regardless of build type
+#if defined(NDEBUG)
+#undef NDEBUG
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <list>
+#include <string>
+#include <vector>
+#include <experimental/text_view>
+#include "test_samples.hpp"
+
+using namespace std;
+using namespace std::experimental;
+
+
+// Code point sequences that exercise each of the encoding rules of the UTF
+// encodings, including the handling of invalid code points.
+const vector<u32string> code_point_samples = {
+    U"",
+    U"a",
+    U"Hello, world!  This is a sequence of ASCII characters.",
+    U"\u00F8\u07FF\u0800\uD7FF\uE000\uFFFF\U00010000\U0010FFFF",
+    U"ASCII, then \u00E9, \u4E2D\u6587, and \U0001F600 mixed in",
+    u32string{U'a', 0xD800, U'b'},
+    u32string{0xDFFF},
+    u32string{U'a', U'b', 0x110000},
+    u32string{U'a', 0xFFFFFFFF},
+    u32string{U'a', 0x80000000},
+};
+
+
+// Returns the bytes of the provided code units, most significant byte first
+// if big_endian is true and least significant byte first otherwise.
+template<typename CUT>
+string
+to_bytes(
+    const basic_string<CUT> &cus,
+    bool big_endian)
+{
+    string bytes;
+    for (CUT cu : cus) {
+        for (size_t i = 0; i != sizeof(CUT); ++i) {
+            size_t shift = 8 * (big_endian ? sizeof(CUT) - 1 - i : i);
+            bytes += static_cast<char>((cu >> shift) & 0xFF);
+        }
+    }
+    return bytes;
+}
+
+
+// Decodes the provided code unit sequence one code point at a time using the
+// decode() member of the encoding.  The result reflects what the bulk decode
+// functions are expected to report.
+template<TextEncoding ET, typename CPT>
+decode_n_result
+reference_decode(
+    const code_unit_type_t<ET> *first,
+    const code_unit_type_t<ET> *last,
+    vector<CPT> &code_points)
+{
+    auto state = ET::initial_state();
+    const code_unit_type_t<ET> *in_next = first;
+    while (in_next != last) {
+        const code_unit_type_t<ET> *in_prev = in_next;
+        character_type_t<ET> c;
+        int decoded_code_units = 0;
+        decode_status ds = ET::decode(state, in_next, last, c,
+                                      decoded_code_units);
+        if (error_occurred(ds)) {
+            return { in_prev - first,
+                     static_cast<ptrdiff_t>(code_points.size()),
+                     ds };
+        }
+        if (ds == decode_status::no_error) {
+            code_points.push_back(c.get_code_point());
+        }
+    }
+    return { in_next - first,
+             static_cast<ptrdiff_t>(code_points.size()),
+             decode_status::no_error };
+}
+
+
+template<TextEncoding ET>
+void test_decode_n(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    using CPT = code_point_type_t<character_set_type_t<character_type_t<ET>>>;
+
+    const code_unit_type_t<ET> *first = cus.data();
+    const code_unit_type_t<ET> *last = cus.data() + cus.size();
+
+    vector<CPT> expected;
+    decode_n_result expected_result =
+        reference_decode<ET>(first, last, expected);
+
+    // Decode with an output buffer large enough for all code points.
+    vector<CPT> actual(cus.size() + 1);
+    decode_n_result result =
+        ET::decode_n(first, last, actual.data(), actual.data() + actual.size());
+    assert(result.code_units == expected_result.code_units);
+    assert(result.code_points == expected_result.code_points);
+    assert(result.status == expected_result.status);
+    actual.resize(result.code_points);
+    assert(actual == expected);
+
+    // Decode with an output buffer that holds a single code point at a time;
+    // each call must stop after producing one code point and resume from
+    // where the previous call stopped.
+    vector<CPT> piecewise;
+    const code_unit_type_t<ET> *in_next = first;
+    for (;;) {
+        CPT cp;
+        result = ET::decode_n(in_next, last, &cp, &cp + 1);
+        in_next += result.code_units;
+        if (result.code_points == 0) {
+            break;
+        }
+        assert(result.code_points == 1);
+        piecewise.push_back(cp);
+    }
+    assert(in_next - first == expected_result.code_units);
+    assert(result.status == expected_result.status);
+    assert(piecewise == expected);
+
+    // An empty output buffer consumes nothing.
+    result = ET::decode_n(first, last, actual.data(), actual.data());
+    assert(result.code_units == 0);
+    assert(result.code_points == 0);
+    assert(result.status == decode_status::no_error);
+}
+
+template<TextEncoding ET>
+void test_validate(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    using CPT = code_point_type_t<character_set_type_t<character_type_t<ET>>>;
+
+    const code_unit_type_t<ET> *first = cus.data();
+    const code_unit_type_t<ET> *last = cus.data() + cus.size();
+
+    vector<CPT> expected;
+    decode_n_result expected_result =
+        reference_decode<ET>(first, last, expected);
+
+    validate_result result = ET::validate(first, last);
+    assert(result.code_units == expected_result.code_units);
+    assert(result.status == expected_result.status);
+}
+
+// Iterates a text view over a contiguous code unit sequence and checks that
+// each character and its base range match those produced by decode().  Views
+// over pointers enable the single code unit run fast path of itext_iterator.
+template<TextEncoding ET>
+void test_iteration(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    const code_unit_type_t<ET> *first = cus.data();
+    const code_unit_type_t<ET> *last = cus.data() + cus.size();
+
+    auto tv = make_text_view<ET, text_permissive_error_policy>(first, last);
+    auto tvit = begin(tv);
+    auto state = ET::initial_state();
+    const code_unit_type_t<ET> *in_next = first;
+    while (in_next != last) {
+        const code_unit_type_t<ET> *in_prev = in_next;
+        character_type_t<ET> c;
+        int decoded_code_units = 0;
+        decode_status ds = ET::decode(state, in_next, last, c,
+                                      decoded_code_units);
+        assert(tvit != end(tv));
+        assert(begin(tvit.base_range()) == in_prev);
+        assert(end(tvit.base_range()) == in_next);
+        assert(tvit.get_error() == ds);
+        if (ds == decode_status::no_error) {
+            assert(*tvit == c);
+        }
+        ++tvit;
+    }
+    assert(tvit == end(tv));
+}
+
+// Decodes the provided code unit sequence from its end one character at a time
+// using the decode_prev() member of the encoding and checks that each call
+// produces the same results as rdecode().  A text view over the code units is
+// iterated in reverse alongside; views over pointers decode with
+// decode_prev().
+template<TextEncoding ET>
+void test_decode_prev(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    const code_unit_type_t<ET> *first = cus.data();
+    const code_unit_type_t<ET> *last = cus.data() + cus.size();
+
+    auto tv = make_text_view<ET, text_permissive_error_policy>(first, last);
+    auto tvit = end(tv);
+    auto state = ET::initial_state();
+    auto ref_state = ET::initial_state();
+    const code_unit_type_t<ET> *in_next = last;
+    auto ref_rin_next = cus.crbegin();
+    while (ref_rin_next != cus.crend()) {
+        character_type_t<ET> c;
+        character_type_t<ET> ref_c;
+        int decoded_code_units = 0;
+        int ref_decoded_code_units = 0;
+        const code_unit_type_t<ET> *in_prev = in_next;
+        decode_status ds = ET::decode_prev(state, first, in_next, c,
+                                           decoded_code_units);
+        decode_status ref_ds = ET::rdecode(ref_state, ref_rin_next,
+                                           cus.crend(), ref_c,
+                                           ref_decoded_code_units);
+        assert(ds == ref_ds);
+        assert(in_next == first + (cus.crend() - ref_rin_next));
+        assert(decoded_code_units == ref_decoded_code_units);
+        if (ds == decode_status::no_error) {
+            assert(c == ref_c);
+        }
+
+        assert(tvit != begin(tv));
+        --tvit;
+        assert(begin(tvit.base_range()) == in_next);
+        assert(end(tvit.base_range()) == in_prev);
+        assert(tvit.get_error() == ds);
+        if (ds == decode_status::no_error) {
+            assert(*tvit == c);
+        }
+    }
+    assert(in_next == first);
+    assert(tvit == begin(tv));
+
+    // Views over pointers to non-const code units also decode with
+    // decode_prev().
+    basic_string<code_unit_type_t<ET>> mcus{cus};
+    code_unit_type_t<ET> *mfirst = &mcus[0];
+    auto mtv = make_text_view<ET, text_permissive_error_policy>(
+        mfirst, mfirst + mcus.size());
+    auto mtvit = end(mtv);
+    for (tvit = end(tv); tvit != begin(tv); ) {
+        --tvit;
+        assert(mtvit != begin(mtv));
+        --mtvit;
+        assert(begin(mtvit.base_range()) - mfirst ==
+               begin(tvit.base_range()) - first);
+        assert(mtvit.get_error() == tvit.get_error());
+        if (! mtvit.error_occurred()) {
+            assert(*mtvit == *tvit);
+        }
+    }
+    assert(mtvit == begin(mtv));
+}
+
+// Iterates text views with text_assume_valid_error_policy over a well-formed
+// code unit sequence and checks that they produce the same characters and
+// base ranges as views with the strict error policy, both forward and in
+// reverse.  Views over a list of code units do not decode with the single
+// code unit run fast path or with decode_prev().
+template<TextEncoding ET>
+void test_assume_valid_iteration(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    const code_unit_type_t<ET> *first = cus.data();
+    const code_unit_type_t<ET> *last = cus.data() + cus.size();
+    assert(ET::validate(first, last).status == decode_status::no_error);
+
+    auto tv = make_text_view<ET, text_assume_valid_error_policy>(first, last);
+    auto ref_tv = make_text_view<ET, text_strict_error_policy>(first, last);
+    auto tvit = begin(tv);
+    for (auto ref_tvit = begin(ref_tv); ref_tvit != end(ref_tv); ++ref_tvit) {
+        assert(tvit != end(tv));
+        assert(*tvit == *ref_tvit);
+        assert(begin(tvit.base_range()) == begin(ref_tvit.base_range()));
+        assert(end(tvit.base_range()) == end(ref_tvit.base_range()));
+        ++tvit;
+    }
+    assert(tvit == end(tv));
+    auto ref_tvit = end(ref_tv);
+    while (tvit != begin(tv)) {
+        --tvit;
+        --ref_tvit;
+        assert(*tvit == *ref_tvit);
+        assert(begin(tvit.base_range()) == begin(ref_tvit.base_range()));
+    }
+    assert(ref_tvit == begin(ref_tv));
+
+    list<code_unit_type_t<ET>> cul(cus.begin(), cus.end());
+    auto ltv = make_text_view<ET, text_assume_valid_error_policy>(cul);
+    auto ltvit = begin(ltv);
+    for (auto c : ref_tv) {
+        assert(ltvit != end(ltv));
+        assert(*ltvit == c);
+        ++ltvit;
+    }
+    assert(ltvit == end(ltv));
+}
+
+// Encodes the provided code points one at a time using the encode() member of
+// ET.  The result reflects what encode_n() is expected to report.
+template<TextEncoding ET>
+encode_n_result
+reference_encode(
+    const u32string &cps,
+    basic_string<code_unit_type_t<ET>> &code_units)
+{
+    auto state = ET::initial_state();
+    for (size_t i = 0; i != cps.size(); ++i) {
+        character_type_t<ET> c;
+        c.set_code_point(cps[i]);
+        auto out = back_inserter(code_units);
+        int encoded_code_units = 0;
+        encode_status es = ET::encode(state, out, c, encoded_code_units);
+        if (error_occurred(es)) {
+            return { static_cast<ptrdiff_t>(i),
+                     static_cast<ptrdiff_t>(code_units.size()),
+                     es };
+        }
+    }
+    return { static_cast<ptrdiff_t>(cps.size()),
+             static_cast<ptrdiff_t>(code_units.size()),
+             encode_status::no_error };
+}
+
+template<TextEncoding ET>
+void test_encode_n(
+    const u32string &cps)
+{
+    using code_unit_type = code_unit_type_t<ET>;
+
+    const char32_t *first = cps.data();
+    const char32_t *last = cps.data() + cps.size();
+
+    basic_string<code_unit_type> expected;
+    encode_n_result expected_result = reference_encode<ET>(cps, expected);
+
+    // Measure, then encode to a buffer of exactly the measured size.
+    encode_n_result length = ET::encoded_length(first, last);
+    assert(length.code_points == expected_result.code_points);
+    assert(length.code_units == expected_result.code_units);
+    assert(length.status == expected_result.status);
+
+    vector<code_unit_type> actual(length.code_units);
+    encode_n_result result = ET::encode_n(
+        first, last, actual.data(), actual.data() + actual.size());
+    assert(result.code_points == expected_result.code_points);
+    assert(result.code_units == expected_result.code_units);
+    assert(result.status == expected_result.status);
+    assert(equal(expected.begin(), expected.end(), actual.begin()));
+
+    // Encode to output buffers of various small sizes; each call must stop
+    // before a code point that does not fit and resume from where the
+    // previous call stopped.
+    for (ptrdiff_t size = ET::max_code_units; size <= 9; ++size) {
+        basic_string<code_unit_type> piecewise;
+        const char32_t *in_next = first;
+        for (;;) {
+            code_unit_type buffer[9];
+            result = ET::encode_n(in_next, last, buffer, buffer + size);
+            in_next += result.code_points;
+            piecewise.append(buffer, buffer + result.code_units);
+            if (result.code_points == 0) {
+                break;
+            }
+        }
+        assert(in_next - first == expected_result.code_points);
+        assert(result.status == expected_result.status);
+        assert(piecewise == expected);
+    }
+}
+
+// Decodes the provided code unit sequence in both directions with ET and with
+// RefET and checks that each call produces identical results.
+template<TextEncoding ET, TextEncoding RefET>
+void test_equivalent_decoding(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    auto state = ET::initial_state();
+    auto ref_state = RefET::initial_state();
+
+    auto in_next = cus.begin();
+    auto ref_in_next = cus.begin();
+    while (ref_in_next != cus.end()) {
+        character_type_t<ET> c;
+        character_type_t<RefET> ref_c;
+        int decoded_code_units = 0;
+        int ref_decoded_code_units = 0;
+        decode_status ds = ET::decode(state, in_next, cus.end(), c,
+                                      decoded_code_units);
+        decode_status ref_ds = RefET::decode(ref_state, ref_in_next,
+                                             cus.end(), ref_c,
+                                             ref_decoded_code_units);
+        assert(ds == ref_ds);
+        assert(in_next == ref_in_next);
+        assert(decoded_code_units == ref_decoded_code_units);
+        if (ds == decode_status::no_error) {
+            assert(c == ref_c);
+        }
+    }
+
+    auto rin_next = cus.rbegin();
+    auto ref_rin_next = cus.rbegin();
+    while (ref_rin_next != cus.rend()) {
+        character_type_t<ET> c;
+        character_type_t<RefET> ref_c;
+        int decoded_code_units = 0;
+        int ref_decoded_code_units = 0;
+        decode_status ds = ET::rdecode(state, rin_next, cus.rend(), c,
+                                       decoded_code_units);
+        decode_status ref_ds = RefET::rdecode(ref_state, ref_rin_next,
+                                              cus.rend(), ref_c,
+                                              ref_decoded_code_units);
+        assert(ds == ref_ds);
+        assert(rin_next == ref_rin_next);
+        assert(decoded_code_units == ref_decoded_code_units);
+        if (ds == decode_status::no_error) {
+            assert(c == ref_c);
+        }
+    }
+}
+
+// Returns the number of characters produced by iterating the provided text
+// view.
+template<TextView TVT>
+ptrdiff_t
+reference_code_point_count(
+    const TVT &tv)
+{
+    ptrdiff_t count = 0;
+    for (auto tvit = begin(tv); tvit != end(tv); ++tvit) {
+        ++count;
+    }
+    return count;
+}
+
+template<TextEncoding ET>
+void test_code_point_count(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    const code_unit_type_t<ET> *first = cus.data();
+    const code_unit_type_t<ET> *last = cus.data() + cus.size();
+
+    // Views of contiguous code units use the encoding's counting routine.
+    auto tv = make_text_view<ET>(first, last);
+    assert(code_point_count(tv) == reference_code_point_count(tv));
+
+    // Views of other forward code unit iterators count by decoding.
+    list<code_unit_type_t<ET>> cul(cus.begin(), cus.end());
+    auto ltv = make_text_view<ET>(cul);
+    assert(code_point_count(ltv) == reference_code_point_count(ltv));
+}
+
+// Transcodes the provided code unit sequence one character at a time using the
+// decode() member of FromET and the encode() member of ToET.  The result
+// reflects what transcode() is expected to report.
+template<TextEncoding FromET, TextEncoding ToET>
+transcode_result
+reference_transcode(
+    const code_unit_type_t<FromET> *first,
+    const code_unit_type_t<FromET> *last,
+    basic_string<code_unit_type_t<ToET>> &code_units)
+{
+    auto from_state = FromET::initial_state();
+    auto to_state = ToET::initial_state();
+    const code_unit_type_t<FromET> *in_next = first;
+    while (in_next != last) {
+        const code_unit_type_t<FromET> *in_prev = in_next;
+        character_type_t<FromET> c;
+        int decoded_code_units = 0;
+        decode_status ds = FromET::decode(from_state, in_next, last, c,
+                                          decoded_code_units);
+        if (error_occurred(ds)) {
+            return { in_prev - first,
+                     static_cast<ptrdiff_t>(code_units.size()),
+                     ds,
+                     encode_status::no_error };
+        }
+        if (ds == decode_status::no_error) {
+            auto out = back_inserter(code_units);
+            int encoded_code_units = 0;
+            encode_status es = ToET::encode(to_state, out, c,
+                                            encoded_code_units);
+            if (error_occurred(es)) {
+                return { in_prev - first,
+                         static_cast<ptrdiff_t>(code_units.size()),
+                         decode_status::no_error,
+                         es };
+            }
+        }
+    }
+    return { in_next - first,
+             static_cast<ptrdiff_t>(code_units.size()),
+             decode_status::no_error,
+             encode_status::no_error };
+}
+
+template<TextEncoding FromET, TextEncoding ToET>
+void test_transcode(
+    const basic_string<code_unit_type_t<FromET>> &cus)
+{
+    using to_code_unit_type = code_unit_type_t<ToET>;
+
+    const code_unit_type_t<FromET> *first = cus.data();
+    const code_unit_type_t<FromET> *last = cus.data() + cus.size();
+
+    basic_string<to_code_unit_type> expected;
+    transcode_result expected_result =
+        reference_transcode<FromET, ToET>(first, last, expected);
+
+    // Transcode with an output buffer large enough for all code units.
+    vector<to_code_unit_type> actual(expected.size() + 8);
+    transcode_result result = transcode<FromET, ToET>(
+        first, last, actual.data(), actual.data() + actual.size());
+    assert(result.input_code_units == expected_result.input_code_units);
+    assert(result.output_code_units == expected_result.output_code_units);
+    assert(result.input_status == expected_result.input_status);
+    assert(result.output_status == expected_result.output_status);
+    assert(equal(expected.begin(), expected.end(), actual.begin()));
+
+    // Transcode with output buffers of various small sizes; each call must
+    // stop before a character that does not fit and resume from where the
+    // previous call stopped.
+    for (ptrdiff_t size = ToET::max_code_units; size <= 5; ++size) {
+        basic_string<to_code_unit_type> piecewise;
+        auto from_state = FromET::initial_state();
+        auto to_state = ToET::initial_state();
+        const code_unit_type_t<FromET> *in_next = first;
+        for (;;) {
+            to_code_unit_type buffer[5];
+            result = transcode<FromET, ToET>(
+                from_state, to_state, in_next, last, buffer, buffer + size);
+            in_next += result.input_code_units;
+            piecewise.append(buffer, buffer + result.output_code_units);
+            if (result.input_code_units == 0) {
+                break;
+            }
+        }
+        assert(in_next - first == expected_result.input_code_units);
+        assert(result.input_status == expected_result.input_status);
+        assert(result.output_status == expected_result.output_status);
+        assert(piecewise == expected);
+    }
+}
+
+// Copies the characters of a text view to an otext_iterator for ToET that
+// has the same error policy as the view.  Returns false if an exception is
+// thrown.
+template<TextEncoding ToET, TextView TVT>
+bool reference_encode_view(
+    const TVT &tv,
+    basic_string<code_unit_type_t<ToET>> &code_units)
+{
+    auto out = make_otext_iterator<ToET, typename TVT::error_policy>(
+        back_inserter(code_units));
+    try {
+        for (const auto &c : tv) {
+            *out++ = c;
+        }
+    } catch (const text_error &) {
+        return false;
+    }
+    return true;
+}
+
+// Checks that encoded_size() reports the number of code units that copying
+// the characters of a text view to an otext_iterator produces, or throws
+// when that copy throws, for views of contiguous code units and for views of
+// other forward code unit iterators.
+template<TextView TVT, TextEncoding ToET>
+void test_encoded_size(const TVT &tv)
+{
+    basic_string<code_unit_type_t<ToET>> expected;
+    if (reference_encode_view<ToET>(tv, expected)) {
+        assert(encoded_size<ToET>(tv) ==
+               static_cast<ptrdiff_t>(expected.size()));
+    } else {
+        bool thrown = false;
+        try {
+            encoded_size<ToET>(tv);
+        } catch (const text_error &) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+}
+
+template<TextEncoding FromET, TextEncoding ToET>
+void test_encoded_size(
+    const basic_string<code_unit_type_t<FromET>> &cus)
+{
+    const code_unit_type_t<FromET> *first = cus.data();
+    const code_unit_type_t<FromET> *last = cus.data() + cus.size();
+    test_encoded_size<decltype(make_text_view<FromET>(first, last)), ToET>(
+        make_text_view<FromET>(first, last));
+    test_encoded_size<
+        decltype(make_text_view<FromET, text_permissive_error_policy>(
+            first, last)),
+        ToET>(
+        make_text_view<FromET, text_permissive_error_policy>(first, last));
+
+    list<code_unit_type_t<FromET>> cul(cus.begin(), cus.end());
+    test_encoded_size<decltype(make_text_view<FromET>(cul)), ToET>(
+        make_text_view<FromET>(cul));
+    test_encoded_size<
+        decltype(make_text_view<FromET, text_permissive_error_policy>(cul)),
+        ToET>(
+        make_text_view<FromET, text_permissive_error_policy>(cul));
+}
+
+// Checks that make_validated_text_view() throws for a text view that throws
+// when iterated with the strict error policy, and otherwise that the
+// validated view produces the same characters as the view and reports the
+// facts that iterating the view establishes.
+template<TextView TVT>
+void test_validated_text_view(const TVT &tv)
+{
+    using code_point_type = code_point_type_t<
+        character_set_type_t<character_type_t<encoding_type_t<TVT>>>>;
+    ptrdiff_t count = 0;
+    code_point_type max_cp = 0;
+    bool valid = true;
+    try {
+        for (const auto &c : tv) {
+            ++count;
+            max_cp = max(max_cp, c.get_code_point());
+        }
+    } catch (const text_decode_error &) {
+        valid = false;
+    }
+    if (! valid) {
+        bool thrown = false;
+        try {
+            make_validated_text_view(tv);
+        } catch (const text_decode_error &) {
+            thrown = true;
+        }
+        assert(thrown);
+        return;
+    }
+
+    auto vtv = make_validated_text_view(tv);
+    static_assert(TextForwardView<decltype(vtv)>());
+    assert(vtv.size() == count);
+    assert(vtv.empty() == (count == 0));
+    assert(vtv.max_code_point() == max_cp);
+    assert(vtv.is_ascii() == (max_cp < 0x80));
+    assert(vtv.is_bmp() == (max_cp < 0x10000));
+    assert(code_point_count(vtv) == count);
+    auto tvit = begin(tv);
+    for (const auto &c : vtv) {
+        assert(tvit != end(tv));
+        assert(c == *tvit);
+        ++tvit;
+    }
+    assert(tvit == end(tv));
+}
+
+template<TextEncoding ET>
+void test_validated_text_view(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    const code_unit_type_t<ET> *first = cus.data();
+    const code_unit_type_t<ET> *last = cus.data() + cus.size();
+    test_validated_text_view(make_text_view<ET>(first, last));
+
+    list<code_unit_type_t<ET>> cul(cus.begin(), cus.end());
+    test_validated_text_view(make_text_view<ET>(cul));
+}
+
+void test_utf8_decode_n() {
+    for (const auto &s : utf8_samples) {
+        test_decode_n<utf8_encoding>(s);
+    }
+    for (const auto &s : make_random_utf8_samples(2000, 40)) {
+        test_decode_n<utf8_encoding>(s);
+    }
+}
+
+void test_utf8_validate() {
+    for (const auto &s : utf8_samples) {
+        test_validate<utf8_encoding>(s);
+    }
+    for (const auto &s : make_random_utf8_samples(2000, 40)) {
+        test_validate<utf8_encoding>(s);
+    }
+
+    // Place each of the samples at a range of offsets within long sequences
+    // so that ill-formed code unit sequences are located at various positions
+    // relative to the blocks processed by vectorized implementations.
+    string prefix;
+    for (int i = 0; i < 150; ++i) {
+        prefix += i % 3 ? "a" : u8"\u00E9";
+        for (const auto &s : utf8_samples) {
+            test_validate<utf8_encoding>(prefix + s);
+            test_validate<utf8_encoding>(prefix + s + prefix);
+        }
+    }
+}
+
+void test_utf8_encode_n() {
+    const vector<u32string> &samples = code_point_samples;
+
+    // Place each of the samples at a range of offsets within long sequences
+    // so that invalid code points are located at various positions relative
+    // to the blocks processed by vectorized implementations.
+    u32string prefix;
+    for (int i = 0; i < 40; ++i) {
+        prefix += i % 5 ? U"a" : U"\U0001F600";
+        for (const auto &s : samples) {
+            test_encode_n<utf8_encoding>(s);
+            test_encode_n<utf8_encoding>(prefix + s);
+            test_encode_n<utf8_encoding>(prefix + s + prefix);
+        }
+    }
+}
+
+void test_utf8_iteration() {
+    for (const auto &s : utf8_samples) {
+        test_iteration<utf8_encoding>(s);
+    }
+    for (const auto &s : make_random_utf8_samples(2000, 40)) {
+        test_iteration<utf8_encoding>(s);
+    }
+
+    // Runs of ASCII characters longer than the distance scanned ahead at a
+    // time.
+    string ascii(200, 'x');
+    test_iteration<utf8_encoding>(ascii);
+    test_iteration<utf8_encoding>(ascii + u8"\u00E9" + ascii + "\xFF");
+}
+
+void test_utf8_decode_prev() {
+    for (const auto &s : utf8_samples) {
+        test_decode_prev<utf8_encoding>(s);
+    }
+    for (const auto &s : make_random_utf8_samples(2000, 40)) {
+        test_decode_prev<utf8_encoding>(s);
+    }
+
+    // Runs of trailing code units longer than a code unit sequence.
+    test_decode_prev<utf8_encoding>("\xF0\x90\x80\x80\x80");
+    test_decode_prev<utf8_encoding>("a\x80\x80\x80\x80\x80");
+    test_decode_prev<utf8_encoding>(u8"\U00010000\x80");
+}
+
+void test_utf8_dfa_decoding() {
+    for (const auto &s : utf8_samples) {
+        test_equivalent_decoding<utf8_dfa_encoding, utf8_encoding>(s);
+        test_iteration<utf8_dfa_encoding>(s);
+    }
+    for (const auto &s : make_random_utf8_samples(2000, 40)) {
+        test_equivalent_decoding<utf8_dfa_encoding, utf8_encoding>(s);
+        test_iteration<utf8_dfa_encoding>(s);
+    }
+
+    // Every sequence of up to three code units.
+    const unsigned char interesting[] = {
+        0x00, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF,
+        0xC0, 0xC1, 0xC2, 0xDF, 0xE0, 0xE1, 0xEC, 0xED,
+        0xEE, 0xEF, 0xF0, 0xF1, 0xF3, 0xF4, 0xF5, 0xFF
+    };
+    for (unsigned char cu1 : interesting) {
+        for (unsigned char cu2 : interesting) {
+            for (unsigned char cu3 : interesting) {
+                string s{char(cu1), char(cu2), char(cu3)};
+                test_equivalent_decoding<utf8_dfa_encoding, utf8_encoding>(s);
+                test_equivalent_decoding<utf8_dfa_encoding, utf8_encoding>(
+                    s + "\x80\xBF");
+            }
+        }
+    }
+}
+
+void test_utf16_decode_n() {
+    for (const auto &s : utf16_samples) {
+        test_decode_n<utf16_encoding>(s);
+    }
+
+    // Place each of the samples at a range of offsets within long sequences
+    // so that surrogates are located at various positions relative to the
+    // blocks processed by vectorized implementations.
+    u16string prefix;
+    for (int i = 0; i < 70; ++i) {
+        prefix += i % 7 ? u"\u4E2D" : u"\U0001F600";
+        for (const auto &s : utf16_samples) {
+            test_decode_n<utf16_encoding>(prefix + s);
+            test_decode_n<utf16_encoding>(prefix + s + prefix);
+        }
+    }
+}
+
+void test_utf16_validate() {
+    for (const auto &s : utf16_samples) {
+        test_validate<utf16_encoding>(s);
+    }
+
+    u16string prefix;
+    for (int i = 0; i < 70; ++i) {
+        prefix += i % 7 ? u"\u4E2D" : u"\U0001F600";
+        for (const auto &s : utf16_samples) {
+            test_validate<utf16_encoding>(prefix + s);
+            test_validate<utf16_encoding>(prefix + s + prefix);
+        }
+    }
+
+    // The offset of an unpaired surrogate that follows a long run of BMP
+    // characters is reported.
+    u16string bmp(300, u'\u4E2D');
+    u16string unpaired = bmp + u16string{0xDC00} + bmp;
+    validate_result result = utf16_encoding::validate(
+        unpaired.data(), unpaired.data() + unpaired.size());
+    assert(result.code_units == 300);
+    assert(result.status == decode_status::invalid_code_unit_sequence);
+}
+
+// Checks the bulk operations of a byte oriented encoding for the provided
+// byte sequence and for the same sequence with bytes added or removed at its
+// end, which may leave an incomplete code unit.
+template<TextEncoding ET>
+void test_byte_order_decoding(
+    const string &bytes)
+{
+    test_decode_n<ET>(bytes);
+    test_validate<ET>(bytes);
+    for (const string &tail :
+             { "\x00"s, "\xD8"s, "\xDC\x00"s, "\x00\xD8\x00"s })
+    {
+        test_decode_n<ET>(bytes + tail);
+        test_validate<ET>(bytes + tail);
+    }
+    if (! bytes.empty()) {
+        string truncated = bytes.substr(0, bytes.size() - 1);
+        test_decode_n<ET>(truncated);
+        test_validate<ET>(truncated);
+    }
+}
+
+void test_utf16_byte_order() {
+    u16string prefix;
+    for (int i = 0; i < 70; ++i) {
+        prefix += i % 7 ? u"\u4E2D" : u"\U0001F600";
+        for (const auto &s : utf16_samples) {
+            for (const u16string &cus :
+                     { s, prefix + s, prefix + s + prefix })
+            {
+                test_byte_order_decoding<utf16be_encoding>(
+                    to_bytes(cus, true));
+                test_byte_order_decoding<utf16le_encoding>(
+                    to_bytes(cus, false));
+            }
+        }
+    }
+
+    u32string cp_prefix;
+    for (int i = 0; i < 40; ++i) {
+        cp_prefix += i % 5 ? U"\u4E2D" : U"\U0001F600";
+        for (const auto &s : code_point_samples) {
+            test_encode_n<utf16be_encoding>(s);
+            test_encode_n<utf16be_encoding>(cp_prefix + s + cp_prefix);
+            test_encode_n<utf16le_encoding>(s);
+            test_encode_n<utf16le_encoding>(cp_prefix + s + cp_prefix);
+        }
+    }
+}
+
+void test_utf32_byte_order() {
+    u32string prefix;
+    for (int i = 0; i < 40; ++i) {
+        prefix += i % 5 ? U"a" : U"\U0001F600";
+        for (const auto &s : code_point_samples) {
+            for (const u32string &cps :
+                     { s, prefix + s, prefix + s + prefix })
+            {
+                test_byte_order_decoding<utf32be_encoding>(
+                    to_bytes(cps, true));
+                test_byte_order_decoding<utf32le_encoding>(
+                    to_bytes(cps, false));
+                test_encode_n<utf32be_encoding>(cps);
+                test_encode_n<utf32le_encoding>(cps);
+            }
+        }
+    }
+}
+
+// Checks the bulk operations of a BOM encoding, which take an encoding state,
+// against decode() starting from the initial state.
+template<TextEncoding ET>
+void test_bom_decode_n(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    using CPT = code_point_type_t<character_set_type_t<character_type_t<ET>>>;
+
+    const code_unit_type_t<ET> *first = cus.data();
+    const code_unit_type_t<ET> *last = cus.data() + cus.size();
+
+    vector<CPT> expected;
+    decode_n_result expected_result =
+        reference_decode<ET>(first, last, expected);
+
+    auto state = ET::initial_state();
+    vector<CPT> actual(cus.size() + 1);
+    decode_n_result result = ET::decode_n(
+        state, first, last, actual.data(), actual.data() + actual.size());
+    assert(result.code_units == expected_result.code_units);
+    assert(result.code_points == expected_result.code_points);
+    assert(result.status == expected_result.status);
+    actual.resize(result.code_points);
+    assert(actual == expected);
+
+    // The state is carried from one call to the next so that the BOM is only
+    // recognized at the start of the input.
+    state = ET::initial_state();
+    vector<CPT> piecewise;
+    const code_unit_type_t<ET> *in_next = first;
+    for (;;) {
+        CPT cp;
+        result = ET::decode_n(state, in_next, last, &cp, &cp + 1);
+        in_next += result.code_units;
+        if (result.code_points == 0) {
+            break;
+        }
+        piecewise.push_back(cp);
+    }
+    assert(in_next - first == expected_result.code_units);
+    assert(result.status == expected_result.status);
+    assert(piecewise == expected);
+
+    validate_result vr = ET::validate(ET::initial_state(), first, last);
+    assert(vr.code_units == expected_result.code_units);
+    assert(vr.status == expected_result.status);
+
+    // Views of the code units are counted and validated with decode_n().
+    test_code_point_count<ET>(cus);
+    test_validated_text_view<ET>(cus);
+}
+
+void test_bom_bulk_decoding() {
+    static_assert(text_detail::StatefulContiguousBulkDecoder<
+                      utf8bom_encoding,
+                      text_detail::basic_view<const char*>>());
+    static_assert(text_detail::StatefulContiguousBulkDecoder<
+                      utf16bom_encoding,
+                      text_detail::basic_view<const char*>>());
+    static_assert(text_detail::StatefulContiguousBulkDecoder<
+                      utf32bom_encoding,
+                      text_detail::basic_view<const char*>>());
+
+    const string utf8_bom = "\xEF\xBB\xBF";
+    for (const auto &s : utf8_samples) {
+        test_bom_decode_n<utf8bom_encoding>(s);
+        test_bom_decode_n<utf8bom_encoding>(utf8_bom + s);
+        test_bom_decode_n<utf8bom_encoding>(utf8_bom + utf8_bom + s);
+    }
+    test_bom_decode_n<utf8bom_encoding>("\xEF\xBB");
+
+    const u16string utf16_boms[] = { u"", u"\uFEFF", u"\uFEFF\uFEFF" };
+    for (const auto &s : utf16_samples) {
+        for (const auto &bom : utf16_boms) {
+            string be = to_bytes(bom + s, true);
+            string le = to_bytes(bom + s, false);
+            test_bom_decode_n<utf16bom_encoding>(be);
+            test_bom_decode_n<utf16bom_encoding>(be + "\x00"s);
+            test_bom_decode_n<utf16bom_encoding>(le);
+            test_bom_decode_n<utf16bom_encoding>(le + "\x00"s);
+        }
+    }
+    test_bom_decode_n<utf16bom_encoding>("\xFE"s);
+
+    const u32string utf32_boms[] = { U"", U"\uFEFF", U"\uFEFF\uFEFF" };
+    for (const auto &s : code_point_samples) {
+        for (const auto &bom : utf32_boms) {
+            string be = to_bytes(bom + s, true);
+            string le = to_bytes(bom + s, false);
+            test_bom_decode_n<utf32bom_encoding>(be);
+            test_bom_decode_n<utf32bom_encoding>(be + "\x00\x00"s);
+            test_bom_decode_n<utf32bom_encoding>(le);
+            test_bom_decode_n<utf32bom_encoding>(le + "\x00\x00"s);
+        }
+    }
+}
+
+void test_utf16_iteration() {
+    test_iteration<utf16_encoding>(u"");
+    test_iteration<utf16_encoding>(u"Hello, world!");
+    test_iteration<utf16_encoding>(u"\u00E9\uD7FF\uE000\uFFFF\U00010000a");
+    // Unpaired surrogates.
+    test_iteration<utf16_encoding>(u16string{u'a', 0xD800, u'b'});
+    test_iteration<utf16_encoding>(u16string{u'a', 0xDC00, u'b'});
+    test_iteration<utf16_encoding>(u16string{u'a', 0xD800});
+
+    u16string bmp(200, u'\u4E2D');
+    test_iteration<utf16_encoding>(bmp + u"\U0001F600" + bmp);
+}
+
+void test_utf16_decode_prev() {
+    test_decode_prev<utf16_encoding>(u"");
+    test_decode_prev<utf16_encoding>(u"Hello, world!");
+    test_decode_prev<utf16_encoding>(u"\u00E9\uD7FF\uE000\uFFFF\U00010000a");
+    test_decode_prev<utf16_encoding>(u"\U0001F600\U0010FFFF");
+    // Unpaired surrogates.
+    test_decode_prev<utf16_encoding>(u16string{u'a', 0xD800, u'b'});
+    test_decode_prev<utf16_encoding>(u16string{u'a', 0xDC00, u'b'});
+    test_decode_prev<utf16_encoding>(u16string{0xDC00, 0xD800});
+    test_decode_prev<utf16_encoding>(u16string{0xD800, 0xD800, 0xDC00});
+    test_decode_prev<utf16_encoding>(u16string{0xDC00, 0xDC00, u'a'});
+    test_decode_prev<utf16_encoding>(u16string{0xDC00});
+}
+
+void test_assume_valid_decoding() {
+    // UTF-8 and UTF-16 decode without validity checks; encodings that lack
+    // decode_unchecked(), such as the DFA based UTF-8 encoding, decode with
+    // decode().
+    static_assert(text_detail::UncheckedDecoder<
+                      utf8_encoding, const char*, const char*>());
+    static_assert(text_detail::UncheckedDecoder<
+                      utf16_encoding, const char16_t*, const char16_t*>());
+    static_assert(! text_detail::UncheckedDecoder<
+                      utf8_dfa_encoding, const char*, const char*>());
+
+    auto is_valid = [](const auto &s) {
+        return utf8_encoding::validate(s.data(), s.data() + s.size()).status
+            == decode_status::no_error;
+    };
+    for (const auto &s : utf8_samples) {
+        if (is_valid(s)) {
+            test_assume_valid_iteration<utf8_encoding>(s);
+            test_assume_valid_iteration<utf8_dfa_encoding>(s);
+        }
+    }
+    for (const auto &s : make_random_utf8_samples(2000, 40)) {
+        if (is_valid(s)) {
+            test_assume_valid_iteration<utf8_encoding>(s);
+        }
+    }
+    string ascii(200, 'x');
+    test_assume_valid_iteration<utf8_encoding>(
+        ascii + u8"\u00E9\U0010FFFF" + ascii);
+
+    for (const auto &s : utf16_samples) {
+        if (utf16_encoding::validate(s.data(), s.data() + s.size()).status
+                == decode_status::no_error)
+        {
+            test_assume_valid_iteration<utf16_encoding>(s);
+        }
+    }
+}
+
+void test_validated_text_view() {
+    for (const auto &s : utf8_samples) {
+        test_validated_text_view<utf8_encoding>(s);
+        test_validated_text_view<utf8bom_encoding>(u8"\uFEFF" + s);
+        test_validated_text_view<latin1_encoding>(s);
+    }
+    for (const auto &s : make_random_utf8_samples(2000, 40)) {
+        test_validated_text_view<utf8_encoding>(s);
+    }
+    string ascii(300, 'x');
+    test_validated_text_view<utf8_encoding>(ascii);
+    test_validated_text_view<utf8_encoding>(ascii + u8"\u00E9");
+    test_validated_text_view<utf8_encoding>(ascii + u8"\U0001F600");
+    test_validated_text_view<utf8_encoding>(ascii + "\xFF");
+
+    for (const auto &s : utf16_samples) {
+        test_validated_text_view<utf16_encoding>(s);
+    }
+}
+
+void test_fixed_width_text_view() {
+    // ASCII UTF-8 text is fixed width; random access iterators decode it in
+    // place and support binary search.
+    string ascii = "abcdefghijklmnopqrstuvwxyz";
+    auto vtv = make_validated_text_view(make_text_view<utf8_encoding>(
+        ascii.data(), ascii.data() + ascii.size()));
+    assert(vtv.is_fixed_width());
+    auto ftv = make_fixed_width_text_view(vtv);
+    static_assert(TextRandomAccessView<decltype(ftv)>());
+    assert(end(ftv) - begin(ftv) == 26);
+    assert(begin(ftv)[25].get_code_point() == U'z');
+    assert((begin(ftv) + 3)->get_code_point() == U'd');
+    assert((end(ftv) - 1)->get_code_point() == U'z');
+    auto it = std::lower_bound(begin(ftv), end(ftv), character_type_t<
+        utf8_encoding>{U'q'}, [](const auto &a, const auto &b) {
+            return a.get_code_point() < b.get_code_point();
+        });
+    assert(it - begin(ftv) == 16);
+    assert(begin(it.base_range()) == ascii.c_str() + 16);
+
+    // BMP UTF-16 text is fixed width.
+    u16string bmp = u"\u00E9\u4E2D\u6587\uFFFD";
+    auto ftv16 = make_fixed_width_text_view(
+        make_text_view<utf16_encoding>(bmp.data(), bmp.data() + bmp.size()));
+    static_assert(TextRandomAccessView<decltype(ftv16)>());
+    assert(end(ftv16) - begin(ftv16) == 4);
+    assert(begin(ftv16)[1].get_code_point() == U'\u4E2D');
+
+    // Text with characters encoded by more than one code unit is not.
+    string u8 = u8"abc\u00E9";
+    auto u8vtv = make_validated_text_view(
+        make_text_view<utf8_encoding>(u8.data(), u8.data() + u8.size()));
+    assert(! u8vtv.is_fixed_width());
+    bool thrown = false;
+    try {
+        make_fixed_width_text_view(u8vtv);
+    } catch (const text_decode_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+    u16string astral = u"a\U0001F600";
+    thrown = false;
+    try {
+        make_fixed_width_text_view(make_text_view<utf16_encoding>(
+            astral.data(), astral.data() + astral.size()));
+    } catch (const text_decode_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Without validation, each code unit that does not encode a character
+    // by itself decodes as an error, so that random access is preserved.
+    using fw_utf8_encoding = fixed_width_encoding<utf8_encoding>;
+    auto ptv = make_text_view<fw_utf8_encoding, text_permissive_error_policy>(
+        u8.data(), u8.data() + u8.size());
+    assert(end(ptv) - begin(ptv) == 5);
+    assert(code_point_count(ptv) == 5);
+    assert(begin(ptv)[2].get_code_point() == U'c');
+    assert(begin(ptv)[3].get_code_point() == U'\uFFFD');
+    assert((begin(ptv) + 4).get_error() ==
+           decode_status::invalid_code_unit_sequence);
+    auto rit = end(ptv);
+    --rit;
+    assert(rit->get_code_point() == U'\uFFFD');
+    assert(begin(rit.base_range()) == u8.c_str() + 4);
+}
+
+void test_code_point_count() {
+    for (const auto &s : utf8_samples) {
+        test_code_point_count<utf8_encoding>(s);
+        test_code_point_count<utf8bom_encoding>(s);
+        test_code_point_count<utf8bom_encoding>(u8"\uFEFF" + s);
+    }
+    for (const auto &s : make_random_utf8_samples(2000, 40)) {
+        test_code_point_count<utf8_encoding>(s);
+    }
+
+    // Place each of the samples at a range of offsets within long sequences
+    // so that ill-formed code unit sequences are located at various positions
+    // relative to the blocks processed by vectorized implementations.
+    string prefix;
+    for (int i = 0; i < 80; ++i) {
+        prefix += i % 3 ? "a" : u8"\u00E9";
+        for (const auto &s : utf8_samples) {
+            test_code_point_count<utf8_encoding>(prefix + s + prefix);
+        }
+    }
+
+    const vector<u16string> utf16_samples = {
+        u"",
+        u"Hello, world!",
+        u"\u00E9\uD7FF\uFFFF\U00010000a",
+        u16string{u'a', 0xD800, u'b'},
+        u16string{u'a', 0xDC00, 0xDC00, u'b'},
+        u16string{0xD800, 0xDC00, 0xDC00},
+        u16string{0xD800, 0xD800, 0xDC00},
+        u16string{u'a', 0xD800},
+    };
+    u16string prefix16;
+    for (int i = 0; i < 40; ++i) {
+        prefix16 += i % 5 ? u"a" : u"\U0001F600";
+        for (const auto &s : utf16_samples) {
+            test_code_point_count<utf16_encoding>(s);
+            test_code_point_count<utf16_encoding>(prefix16 + s);
+            test_code_point_count<utf16_encoding>(prefix16 + s + prefix16);
+        }
+    }
+
+    const vector<u32string> utf32_samples = {
+        U"",
+        U"Hello, \U0001F600!",
+        u32string{U'a', 0xD800, U'b'},
+        u32string{U'a', 0xD800, 0x110000, 0xDFFF, U'b'},
+        u32string{0x110000, U'a', 0xDC00},
+    };
+    for (const auto &s : utf32_samples) {
+        test_code_point_count<utf32_encoding>(s);
+    }
+}
+
+void test_encoded_size() {
+    for (const auto &s : utf8_samples) {
+        test_encoded_size<utf8_encoding, utf16_encoding>(s);
+        test_encoded_size<utf8_encoding, utf32_encoding>(s);
+        test_encoded_size<utf8_encoding, utf8_encoding>(s);
+        test_encoded_size<utf8_encoding, utf8bom_encoding>(s);
+        test_encoded_size<utf8bom_encoding, utf16_encoding>(u8"\uFEFF" + s);
+    }
+    for (const auto &s : make_random_utf8_samples(500, 40)) {
+        test_encoded_size<utf8_encoding, utf16_encoding>(s);
+        test_encoded_size<utf8_encoding, utf32_encoding>(s);
+    }
+
+    // Place each of the samples at a range of offsets within long sequences
+    // so that ill-formed code unit sequences are located at various positions
+    // relative to the blocks processed by vectorized implementations.
+    string prefix;
+    for (int i = 0; i < 80; ++i) {
+        prefix += i % 5 ? "a" : (i % 2 ? u8"\u00E9" : u8"\U0001F600");
+        for (const auto &s : utf8_samples) {
+            test_encoded_size<utf8_encoding, utf16_encoding>(
+                prefix + s + prefix);
+        }
+    }
+
+    const vector<u16string> utf16_samples = {
+        u"",
+        u"Hello, world!",
+        u"\u007F\u0080\u07FF\u0800\uD7FF\uE000\uFFFF\U00010000\U0010FFFF",
+        u16string{u'a', 0xD800, u'b'},
+        u16string{u'a', 0xDC00, 0xDC00, u'b'},
+        u16string{u'a', 0xD800},
+    };
+    u16string prefix16;
+    for (int i = 0; i < 40; ++i) {
+        prefix16 += i % 5 ? u"\u0430" : (i % 2 ? u"a" : u"\uFFFD\U0001F600");
+        for (const auto &s : utf16_samples) {
+            test_encoded_size<utf16_encoding, utf8_encoding>(s);
+            test_encoded_size<utf16_encoding, utf8_encoding>(prefix16 + s);
+            test_encoded_size<utf16_encoding, utf8_encoding>(
+                prefix16 + s + prefix16);
+            test_encoded_size<utf16_encoding, utf32_encoding>(
+                prefix16 + s + prefix16);
+            test_encoded_size<utf16le_encoding, utf32_encoding>(
+                to_bytes(prefix16 + s + prefix16, false));
+            test_encoded_size<utf16_encoding, utf32be_encoding>(
+                prefix16 + s + prefix16);
+            test_encoded_size<utf16be_encoding, utf32le_encoding>(
+                to_bytes(prefix16 + s + prefix16, true));
+        }
+    }
+
+    const vector<u32string> utf32_samples = {
+        U"",
+        U"Hello, \u00E9\u4E2D\U0001F600!",
+        u32string{U'a', 0xD800, U'b'},
+        u32string{U'a', 0xD800, 0x110000, 0xDFFF, U'b'},
+    };
+    for (const auto &s : utf32_samples) {
+        test_encoded_size<utf32_encoding, utf8_encoding>(s);
+        test_encoded_size<utf32_encoding, utf16_encoding>(s);
+        test_encoded_size<utf32_encoding, utf16be_encoding>(s);
+        test_encoded_size<utf32be_encoding, utf16_encoding>(to_bytes(s, true));
+        test_encoded_size<utf32le_encoding, utf16le_encoding>(
+            to_bytes(s, false));
+    }
+
+    // Sequences long enough for the counters of vectorized implementations to
+    // be flushed.
+    string long_utf8;
+    u16string long_utf16;
+    for (int i = 0; i < 60000; ++i) {
+        long_utf8 += u8"a\u00E9\u4E2D\U0001F600";
+        long_utf16 += u"a\u00E9\u4E2D\U0001F600";
+    }
+    test_encoded_size<utf8_encoding, utf16_encoding>(long_utf8);
+    test_encoded_size<utf16_encoding, utf8_encoding>(long_utf16);
+
+    // The size reserves exactly the capacity that writing through an
+    // otext_iterator requires.
+    string s = u8"\u00E9\u4E2D\U0001F600 and ASCII";
+    auto tv = make_text_view<utf8_encoding>(s.data(), s.data() + s.size());
+    u16string utf16;
+    utf16.reserve(encoded_size<utf16_encoding>(tv));
+    const char16_t *data = utf16.data();
+    auto out = make_otext_iterator<utf16_encoding>(back_inserter(utf16));
+    for (const auto &c : tv) {
+        *out++ = c;
+    }
+    assert(utf16.data() == data);
+    assert(utf16 == u"\u00E9\u4E2D\U0001F600 and ASCII");
+}
+
+void test_utf8_utf16_transcode() {
+    auto to_utf16 = [](const string &s) {
+        u16string result;
+        transcode_result r = reference_transcode<utf8_encoding, utf16_encoding>(
+            s.data(), s.data() + s.size(), result);
+        assert(r.input_code_units == static_cast<ptrdiff_t>(s.size()));
+        return result;
+    };
+
+    for (const auto &s : utf8_samples) {
+        test_transcode<utf8_encoding, utf16_encoding>(s);
+        test_transcode<utf8_encoding, utf32_encoding>(s);
+    }
+    for (const auto &s : make_random_utf8_samples(2000, 40)) {
+        test_transcode<utf8_encoding, utf16_encoding>(s);
+    }
+
+    // Place ill-formed code unit sequences at a range of offsets relative to
+    // the blocks processed by vectorized implementations.
+    string prefix;
+    for (int i = 0; i < 80; ++i) {
+        prefix += i % 7 ? "a" : u8"\u00E9";
+        for (const auto &s : utf8_samples) {
+            test_transcode<utf8_encoding, utf16_encoding>(prefix + s + prefix);
+        }
+        u16string utf16_prefix = to_utf16(prefix);
+        test_transcode<utf16_encoding, utf8_encoding>(utf16_prefix);
+        test_transcode<utf16_encoding, utf8_encoding>(
+            utf16_prefix + u16string{0xDC00} + utf16_prefix);
+        test_transcode<utf16_encoding, utf8_encoding>(
+            utf16_prefix + u16string{0xD800, u'a'} + utf16_prefix);
+        test_transcode<utf16_encoding, utf8_encoding>(
+            utf16_prefix + u16string{0xD800});
+    }
+
+    for (const auto &s : make_random_utf8_samples(500, 40)) {
+        const char *first = s.data();
+        const char *last = s.data() + s.size();
+        vector<char32_t> code_points(s.size());
+        decode_n_result r = utf8_encoding::decode_n(
+            first, last, code_points.data(),
+            code_points.data() + code_points.size());
+        u16string utf16 = to_utf16(string(first, first + r.code_units));
+        test_transcode<utf16_encoding, utf8_encoding>(utf16);
+        test_transcode<utf16_encoding, utf16be_encoding>(utf16);
+    }
+
+    const vector<u32string> utf32_samples = {
+        U"",
+        U"Hello, \u00E9\u07FF\u0800\uFFFF\U00010000\U0010FFFF!",
+        u32string{U'a', 0xD800, U'b'},
+        u32string{U'a', 0xDFFF},
+        u32string{0x110000, U'a'},
+    };
+    for (const auto &s : utf32_samples) {
+        test_transcode<utf32_encoding, utf8_encoding>(s);
+    }
+}
+
+void test_latin1_utf8_transcode() {
+    string all_code_units;
+    for (int i = 0; i < 256; ++i) {
+        all_code_units += static_cast<char>(i);
+    }
+    const vector<string> latin1_samples = {
+        "",
+        "a",
+        "Hello, world!  This is a sequence of ASCII characters.",
+        "caf\xE9, na\xEFve, Stra\xDF" "e, \xA9 \xBF\xC0\xFF",
+        "\xE9\xE8\xEA\xEB\xE0\xE2\xE4\xF4"
+        "\xF6\xFB\xFC\xE7\xC9\xC8\xCA\xCB",
+        all_code_units,
+    };
+    // UTF-8 sequences for code points that Latin-1 cannot encode, ill-formed
+    // sequences, and sequences that are truncated or that span the blocks
+    // processed by vectorized implementations.
+    const vector<string> utf8_latin1_samples = {
+        u8"\u0100",
+        u8"a\u4E2D",
+        u8"\U0001F600 emoji",
+        "\xC0\x80",
+        "\xC1\xBF",
+        "\xC3",
+        "\x80\xC3\xA9",
+        "\xC3\xC3\xA9",
+        "\xC3\xA9\xA9",
+        "\xC4\x80",
+    };
+
+    // Place each of the samples at a range of offsets relative to the blocks
+    // processed by vectorized implementations.
+    string prefix;
+    string utf8_prefix;
+    for (int i = 0; i < 40; ++i) {
+        prefix += i % 3 ? "a" : "\xE9";
+        utf8_prefix += i % 3 ? "a" : u8"\u00E9";
+        for (const auto &s : latin1_samples) {
+            for (const string &cus : { s, prefix + s, prefix + s + prefix }) {
+                test_transcode<latin1_encoding, utf8_encoding>(cus);
+                string utf8;
+                transcode_result r =
+                    reference_transcode<latin1_encoding, utf8_encoding>(
+                        cus.data(), cus.data() + cus.size(), utf8);
+                assert(r.input_code_units ==
+                       static_cast<ptrdiff_t>(cus.size()));
+                test_transcode<utf8_encoding, latin1_encoding>(utf8);
+            }
+        }
+        for (const auto &s : utf8_latin1_samples) {
+            test_transcode<utf8_encoding, latin1_encoding>(utf8_prefix + s);
+            test_transcode<utf8_encoding, latin1_encoding>(
+                utf8_prefix + s + utf8_prefix);
+        }
+    }
+    for (const auto &s : utf8_samples) {
+        test_transcode<utf8_encoding, latin1_encoding>(s);
+    }
+    for (const auto &s : make_random_utf8_samples(500, 40)) {
+        test_transcode<utf8_encoding, latin1_encoding>(s);
+    }
+
+    for (const auto &s : latin1_samples) {
+        test_encoded_size<latin1_encoding, utf8_encoding>(prefix + s);
+        test_encoded_size<utf8_encoding, latin1_encoding>(utf8_prefix + s);
+    }
+    for (const auto &s : utf8_latin1_samples) {
+        test_encoded_size<utf8_encoding, latin1_encoding>(utf8_prefix + s);
+    }
+}
+
+void test_utf16_utf32_transcode() {
+    // Place each of the samples at a range of offsets relative to the blocks
+    // processed by vectorized implementations.
+    u16string prefix;
+    for (int i = 0; i < 40; ++i) {
+        prefix += i % 5 ? u"\u4E2D" : u"\U0001F600";
+        for (const auto &s : utf16_samples) {
+            for (const u16string &cus :
+                     { s, prefix + s, prefix + s + prefix })
+            {
+                test_transcode<utf16_encoding, utf32_encoding>(cus);
+                test_transcode<utf16be_encoding, utf32_encoding>(
+                    to_bytes(cus, true));
+                test_transcode<utf16le_encoding, utf32_encoding>(
+                    to_bytes(cus, false));
+                test_transcode<utf16_encoding, utf32be_encoding>(cus);
+                test_transcode<utf16_encoding, utf32le_encoding>(cus);
+                test_transcode<utf16be_encoding, utf32be_encoding>(
+                    to_bytes(cus, true));
+                test_transcode<utf16be_encoding, utf32le_encoding>(
+                    to_bytes(cus, true));
+                test_transcode<utf16le_encoding, utf32be_encoding>(
+                    to_bytes(cus, false));
+                test_transcode<utf16le_encoding, utf32le_encoding>(
+                    to_bytes(cus, false));
+            }
+        }
+    }
+    // An odd trailing byte is an incomplete code unit.
+    test_transcode<utf16be_encoding, utf32_encoding>(
+        to_bytes(prefix, true) + "\x00"s);
+    test_transcode<utf16le_encoding, utf32_encoding>(
+        to_bytes(prefix, false) + "\xD8"s);
+    test_transcode<utf16be_encoding, utf32le_encoding>(
+        to_bytes(prefix, true) + "\x00"s);
+    test_transcode<utf16le_encoding, utf32be_encoding>(
+        to_bytes(prefix, false) + "\xD8"s);
+
+    u32string cp_prefix;
+    for (int i = 0; i < 40; ++i) {
+        cp_prefix += i % 5 ? U"\u4E2D" : U"\U0001F600";
+        for (const auto &s : code_point_samples) {
+            for (const u32string &cps :
+                     { s, cp_prefix + s, cp_prefix + s + cp_prefix })
+            {
+                test_encode_n<utf16_encoding>(cps);
+                test_transcode<utf32_encoding, utf16_encoding>(cps);
+                test_transcode<utf32_encoding, utf16be_encoding>(cps);
+                test_transcode<utf32_encoding, utf16le_encoding>(cps);
+                for (bool big_endian : { true, false }) {
+                    string bytes = to_bytes(cps, big_endian);
+                    if (big_endian) {
+                        test_transcode<utf32be_encoding, utf16_encoding>(
+                            bytes);
+                        test_transcode<utf32be_encoding, utf16be_encoding>(
+                            bytes);
+                        test_transcode<utf32be_encoding, utf16le_encoding>(
+                            bytes);
+                    } else {
+                        test_transcode<utf32le_encoding, utf16_encoding>(
+                            bytes);
+                        test_transcode<utf32le_encoding, utf16be_encoding>(
+                            bytes);
+                        test_transcode<utf32le_encoding, utf16le_encoding>(
+                            bytes);
+                    }
+                }
+            }
+        }
+    }
+    // Trailing bytes that do not complete a code unit.
+    test_transcode<utf32be_encoding, utf16_encoding>(
+        to_bytes(cp_prefix, true) + "\x00\x01"s);
+    test_transcode<utf32le_encoding, utf16be_encoding>(
+        to_bytes(cp_prefix, false) + "\x41\x00\x00"s);
+}
+
+
+int main() {
+    // Each test is run with the implementations of every level that the
+    // processor supports, down to the scalar implementations.
+    for (int level = static_cast<int>(simd_level::avx512bw);
+         level >= static_cast<int>(simd_level::scalar);
+         --level)
+    {
+        set_simd_level_limit(static_cast<simd_level>(level));
+        if (get_simd_level() != static_cast<simd_level>(level)) {
+            continue;
+        }
+
+        test_utf8_decode_n();
+        test_utf8_validate();
+        test_utf8_encode_n();
+        test_utf8_iteration();
+        test_utf8_decode_prev();
+        test_utf8_dfa_decoding();
+        test_utf16_decode_n();
+        test_utf16_validate();
+        test_utf16_iteration();
+        test_utf16_decode_prev();
+        test_utf16_byte_order();
+        test_utf32_byte_order();
+        test_bom_bulk_decoding();
+        test_utf8_utf16_transcode();
+        test_utf16_utf32_transcode();
+        test_latin1_utf8_transcode();
+        test_encoded_size();
+        test_code_point_count();
+        test_assume_valid_decoding();
+        test_validated_text_view();
+        test_fixed_width_text_view();
+    }
+
+    return 0;
+}
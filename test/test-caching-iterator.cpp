@@ -10,6 +10,7 @@
 #endif
 
 #include <cassert>
+#include <utility>
 #include <experimental/ranges/iterator>
 #include <text_view_detail/adl_customization.hpp>
 #include <text_view_detail/caching_iterator.hpp>
@@ -18,11 +19,14 @@
 using namespace std::experimental;
 using namespace std::experimental::text_detail;
 
-int main() {
+// Exercises caching_iterator with the specified capacity; 0 denotes an
+// unbounded cache.  The cache holds no more than 4 values.
+template<std::size_t N>
+void test_caching_iterator() {
     int seq[] = { 1, 2, 3, 4 };
 
     using IIA = input_iterator_adapter<int*>;
-    using CI = caching_iterator<IIA>;
+    using CI = caching_iterator<IIA, N>;
     using CIS = caching_iterator_sentinel<IIA>;
 
     static_assert(ranges::ForwardIterator<CI>);
@@ -120,6 +124,150 @@ int main() {
     ci.clear_cache(); // Invalidates ci2!
     assert(ranges::size(ci.cached_range()) == 0);
     assert(ranges::size(ci.look_ahead_range()) == 0);
+}
+
+// Exercises a caching_iterator with a capacity of 2 over a sequence that is
+// longer than that, clearing the cache while values remain to be looked at.
+void test_fixed_capacity_caching_iterator() {
+    int seq[] = { 1, 2, 3, 4, 5 };
+
+    using IIA = input_iterator_adapter<int*>;
+    using CI = caching_iterator<IIA, 2>;
+    using CIS = caching_iterator_sentinel<IIA>;
+
+    CI ci = make_caching_iterator<2>(IIA{adl_begin(seq)});
+    CIS cis = IIA{adl_end(seq)};
+    int expected = 1;
+    while (ci != cis) {
+        CI ci2 = ci;
+        assert(*ci2 == expected);
+        ++ci2;
+        if (ci2 != cis) {
+            assert(*ci2 == expected + 1); // Look ahead one value.
+        }
+        assert(ranges::size(ci.look_ahead_range()) ==
+               (expected == 5 ? 1 : 2));
+        ++ci;
+        assert(ranges::size(ci.cached_range()) == 1);
+        assert(*adl_begin(ci.cached_range()) == expected);
+        ci.clear_cache();
+        assert(ranges::size(ci.cached_range()) == 0);
+        assert(ranges::size(ci.look_ahead_range()) ==
+               (expected == 5 ? 0 : 1));
+        if (expected != 5) {
+            assert(*adl_begin(ci.look_ahead_range()) == expected + 1);
+        }
+        ++expected;
+    }
+    assert(expected == 6);
+
+    // Caching more values than the capacity between calls to clear_cache()
+    // moves them out of the fixed capacity buffer.
+    ci = make_caching_iterator<2>(IIA{adl_begin(seq)});
+    CI ci3 = ci;
+    ++ci3;
+    ++ci3;
+    ++ci3;
+    ++ci;
+    assert(ranges::size(ci.cached_range()) == 1);
+    assert(ranges::size(ci.look_ahead_range()) == 2);
+    ci.clear_cache();
+    assert(ranges::size(ci.look_ahead_range()) == 2);
+    assert(*adl_begin(ci.look_ahead_range()) == 2);
+    expected = 2;
+    while (ci != cis) {
+        assert(*ci == expected);
+        ++ci;
+        ci.clear_cache();
+        ++expected;
+    }
+    assert(expected == 6);
+}
+
+// Exercises the sharing of cached values by copied, assigned, and moved
+// caching_iterators, and by caching_iterators that outlive the one they were
+// copied from.
+void test_shared_caching_iterator() {
+    int seq[] = { 1, 2, 3 };
+
+    using IIA = input_iterator_adapter<int*>;
+    using CI = caching_iterator<IIA>;
+    using CIS = caching_iterator_sentinel<IIA>;
+
+    CIS cis = IIA{adl_end(seq)};
+    CI ci;
+    {
+        CI ci1 = IIA{adl_begin(seq)};
+        CI ci2 = ci1;
+        ++ci2;
+        ci = ci2;
+        assert(ci == ci2);
+        assert(ci != ci1);
+        CI ci3 = std::move(ci2);
+        assert(ci3 == ci);
+        ci3 = ci3;
+        assert(ci3 == ci);
+        ci1 = std::move(ci3);
+        assert(ci1 == ci);
+    }
+    assert(*ci == 2);
+    assert(ranges::size(ci.cached_range()) == 1);
+    assert(*adl_begin(ci.cached_range()) == 1);
+    CI ci4 = ci;
+    ci = CI{IIA{adl_begin(seq)}};
+    ++ci4;
+    assert(*ci4 == 3);
+    ++ci4;
+    assert(ci4 == cis);
+}
+
+// Exercises a caching_iterator with a window of 3 values while an iterator
+// copy that is never advanced would otherwise retain every value read.
+void test_windowed_caching_iterator() {
+    int seq[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    using IIA = input_iterator_adapter<int*>;
+    using CI = caching_iterator<IIA>;
+    using CIS = caching_iterator_sentinel<IIA>;
+
+    CI ci = make_caching_iterator(IIA{adl_begin(seq)}, 3);
+    CIS cis = IIA{adl_end(seq)};
+    CI forgotten = ci;
+    assert(*forgotten == 1);
+    int expected = 1;
+    while (ci != cis) {
+        assert(*ci == expected);
+        assert(ranges::size(ci.cached_range()) ==
+               std::size_t(expected < 3 ? expected - 1 : 2));
+        assert(*adl_begin(ci.look_ahead_range()) == expected);
+        ++ci;
+        ++expected;
+    }
+    assert(expected == 9);
+    assert(ranges::size(ci.cached_range()) == 3);
+    assert(*adl_begin(ci.cached_range()) == 6);
+    assert(ci.cache_high_water_mark() == 3);
+    assert(forgotten.cache_high_water_mark() == 3);
+
+    // Without a window, the cache holds every value until it is cleared.
+    CI ci2 = IIA{adl_begin(seq)};
+    forgotten = ci2;
+    while (ci2 != cis) {
+        ++ci2;
+    }
+    assert(ranges::size(ci2.cached_range()) == 8);
+    assert(ci2.cache_high_water_mark() == 8);
+    ci2.clear_cache();
+    assert(ranges::size(ci2.cached_range()) == 0);
+    assert(ci2.cache_high_water_mark() == 8);
+}
+
+int main() {
+    test_caching_iterator<0>();
+    test_caching_iterator<4>();
+    test_fixed_capacity_caching_iterator();
+    test_shared_caching_iterator();
+    test_windowed_caching_iterator();
 
     return 0;
 }
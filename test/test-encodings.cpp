@@ -1315,8 +1315,8 @@ void test_u32text_view() {
                       char32_character_encoding>::value);
 }
 
+template<TextEncoding ET>
 void test_utf8_encoding() {
-    using ET = utf8_encoding;
     using CT = character_type_t<ET>;
     using CUT = code_unit_type_t<ET>;
     using CUMS = code_unit_map_sequence<ET>;
@@ -1962,6 +1962,99 @@ void test_utf32bom_encoding() {
     test_noexcept_encoding<ET>();
 }
 
+void test_latin1_encoding() {
+    using ET = latin1_encoding;
+    using CT = character_type_t<ET>;
+    using CUT = code_unit_type_t<ET>;
+    using CUMS = code_unit_map_sequence<ET>;
+
+    // FIXME: code_unit_type for Latin-1 is char, but the values below require
+    // FIXME: an unsigned (8-bit) char.  An initializer that allows narrowing
+    // FIXME: conversions is used to support implementations with a signed
+    // FIXME: 8-bit char.
+
+    // Test an empty code unit sequence.
+    CUMS code_unit_maps_empty{};
+    test_random_access_encoding<ET>(code_unit_maps_empty);
+
+    // Test code unit boundaries.
+    CUMS code_unit_maps{
+        { {}, { CT{U'\0'}         }, { CUT(0x00) } },
+        { {}, { CT{U'\U0000007F'} }, { CUT(0x7F) } },
+        { {}, { CT{U'\U00000080'} }, { CUT(0x80) } },
+        { {}, { CT{U'\U000000E9'} }, { CUT(0xE9) } },
+        { {}, { CT{U'\U000000FF'} }, { CUT(0xFF) } } };
+    test_random_access_encoding<ET>(code_unit_maps);
+
+    // Code points above U+00FF cannot be encoded.
+    {
+    string s;
+    auto out = back_inserter(s);
+    int encoded_code_units = 0;
+    auto state = ET::initial_state();
+    assert(ET::encode(state, out, CT{U'\U00000100'}, encoded_code_units) ==
+           encode_status::invalid_character);
+    assert(s.empty());
+    }
+
+    test_noexcept_encoding<ET>();
+}
+
+void test_fixed_width_encoding() {
+    {
+    using ET = fixed_width_encoding<utf8_encoding>;
+    using CT = character_type_t<ET>;
+    using CUT = code_unit_type_t<ET>;
+    using CUMS = code_unit_map_sequence<ET>;
+
+    CUMS code_unit_maps_empty{};
+    test_random_access_encoding<ET>(code_unit_maps_empty);
+
+    CUMS code_unit_maps{
+        { {}, { CT{U'\0'}         }, { CUT(0x00) } },
+        { {}, { CT{U'a'}          }, { CUT(0x61) } },
+        { {}, { CT{U'\U0000007F'} }, { CUT(0x7F) } } };
+    test_random_access_encoding<ET>(code_unit_maps);
+
+    // Characters encoded by more than one code unit cannot be encoded.
+    string s;
+    auto out = back_inserter(s);
+    int encoded_code_units = 0;
+    auto state = ET::initial_state();
+    assert(ET::encode(state, out, CT{U'\U000000E9'}, encoded_code_units) ==
+           encode_status::invalid_character);
+    assert(s.empty());
+
+    test_noexcept_encoding<ET>();
+    }
+
+    {
+    using ET = fixed_width_encoding<utf16_encoding>;
+    using CT = character_type_t<ET>;
+    using CUT = code_unit_type_t<ET>;
+    using CUMS = code_unit_map_sequence<ET>;
+
+    CUMS code_unit_maps{
+        { {}, { CT{U'\0'}         }, { CUT(0x0000) } },
+        { {}, { CT{U'\U000000E9'} }, { CUT(0x00E9) } },
+        { {}, { CT{U'\U0000D7FF'} }, { CUT(0xD7FF) } },
+        { {}, { CT{U'\U0000E000'} }, { CUT(0xE000) } },
+        { {}, { CT{U'\U0000FFFF'} }, { CUT(0xFFFF) } } };
+    test_random_access_encoding<ET>(code_unit_maps);
+
+    // Characters encoded by a surrogate pair cannot be encoded.
+    u16string s;
+    auto out = back_inserter(s);
+    int encoded_code_units = 0;
+    auto state = ET::initial_state();
+    assert(ET::encode(state, out, CT{U'\U00010000'}, encoded_code_units) ==
+           encode_status::invalid_character);
+    assert(s.empty());
+
+    test_noexcept_encoding<ET>();
+    }
+}
+
 int main() {
     test_any_character_set();
 
@@ -1971,7 +2064,8 @@ int main() {
     test_u16text_view();
     test_u32text_view();
 
-    test_utf8_encoding();
+    test_utf8_encoding<utf8_encoding>();
+    test_utf8_encoding<utf8_dfa_encoding>();
     test_utf8bom_encoding();
     test_utf16_encoding();
     test_utf16be_encoding();
@@ -1981,6 +2075,8 @@ int main() {
     test_utf32be_encoding();
     test_utf32le_encoding();
     test_utf32bom_encoding();
+    test_latin1_encoding();
+    test_fixed_width_encoding();
 
     return 0;
 }
@@ -0,0 +1,85 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+// Ensure assert is enabled regardless of build type
+#if defined(NDEBUG)
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <experimental/text_view>
+
+using namespace std;
+using namespace std::experimental;
+
+
+// The initial limit is read from the environment when it is first needed.
+void test_environment_limit() {
+    setenv("TEXT_VIEW_SIMD_LEVEL", "sse2", 1);
+    assert(get_simd_level_limit() == simd_level::sse2);
+    assert(get_simd_level() <= simd_level::sse2);
+    setenv("TEXT_VIEW_SIMD_LEVEL", "scalar", 1);
+    assert(get_simd_level_limit() == simd_level::sse2);
+}
+
+void test_set_limit() {
+    set_simd_level_limit(simd_level::scalar);
+    assert(get_simd_level_limit() == simd_level::scalar);
+    assert(get_simd_level() == simd_level::scalar);
+
+    set_simd_level_limit(simd_level::avx512bw);
+    assert(get_simd_level_limit() == simd_level::avx512bw);
+    simd_level highest = get_simd_level();
+    for (int level = static_cast<int>(simd_level::scalar);
+         level <= static_cast<int>(simd_level::avx512bw);
+         ++level)
+    {
+        set_simd_level_limit(static_cast<simd_level>(level));
+        assert(get_simd_level() <= static_cast<simd_level>(level));
+        assert(get_simd_level() <= highest);
+    }
+}
+
+// Bulk operations report the same results regardless of the implementations
+// selected, including after the limit is changed between calls.
+void test_redispatch() {
+    string s(100, 'a');
+    s += u8"\u00E9\u4E2D\U0001F600";
+    s += string(100, 'b');
+    s += "\xC0\xAF";
+    s += string(100, 'c');
+    const char *first = s.data();
+    const char *last = s.data() + s.size();
+
+    set_simd_level_limit(simd_level::avx512bw);
+    validate_result expected = utf8_encoding::validate(first, last);
+    assert(expected.code_units == 209);
+    assert(expected.status == decode_status::invalid_code_unit_sequence);
+    std::ptrdiff_t expected_count = utf8_encoding::code_point_count(
+        first, last);
+
+    for (int level = static_cast<int>(simd_level::avx512bw);
+         level >= static_cast<int>(simd_level::scalar);
+         --level)
+    {
+        set_simd_level_limit(static_cast<simd_level>(level));
+        validate_result r = utf8_encoding::validate(first, last);
+        assert(r.code_units == expected.code_units);
+        assert(r.status == expected.status);
+        assert(utf8_encoding::code_point_count(first, last) ==
+               expected_count);
+    }
+}
+
+int main() {
+    test_environment_limit();
+    test_set_limit();
+    test_redispatch();
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+// Ensure assert is enabled regardless of build type
+#if defined(NDEBUG)
+#undef NDEBUG
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <experimental/text_view>
+#include "test_samples.hpp"
+
+using namespace std;
+using namespace std::experimental;
+
+
+// Checks that a text view of a mapped file decodes the same characters as a
+// view of the same code units in memory, and that its code unit iterators are
+// pointers.
+template<TextEncoding ET>
+void test_mapped_file(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    using CUT = code_unit_type_t<ET>;
+    const char *path = "test-mapped-file.tmp";
+    {
+        ofstream ofs(path, ios_base::binary | ios_base::trunc);
+        ofs.write(reinterpret_cast<const char*>(cus.data()),
+                  cus.size() * sizeof(CUT));
+        // A trailing partial code unit is excluded.
+        if (sizeof(CUT) > 1) {
+            ofs.put('\x01');
+        }
+    }
+
+    basic_mapped_file<CUT> mf{path};
+    assert(mf.size() == cus.size());
+    assert(mf.empty() == cus.empty());
+    assert(equal(mf.begin(), mf.end(), cus.begin(), cus.end()));
+
+    auto tv = make_text_view<ET, text_permissive_error_policy>(mf);
+    static_assert(is_same<typename decltype(tv)::code_unit_iterator,
+                          const CUT*>::value);
+    auto etv = make_text_view<ET, text_permissive_error_policy>(
+        cus.data(), cus.data() + cus.size());
+    assert(equal(begin(tv), end(tv), begin(etv), end(etv)));
+    assert(code_point_count(tv) == code_point_count(etv));
+
+    // Moving transfers the mapping.
+    basic_mapped_file<CUT> mf2{std::move(mf)};
+    assert(mf.empty());
+    assert(mf2.size() == cus.size());
+    mf = basic_mapped_file<CUT>{path, mapped_file_advice::random};
+    assert(equal(mf.begin(), mf.end(), mf2.begin(), mf2.end()));
+
+    remove(path);
+}
+
+void test_mapped_file() {
+    for (const auto &s : utf8_samples) {
+        test_mapped_file<utf8_encoding>(s);
+    }
+    for (const auto &s : utf16_samples) {
+        test_mapped_file<utf16_encoding>(s);
+    }
+
+    bool thrown = false;
+    try {
+        basic_mapped_file<char> mf{"test-mapped-file-nonexistent.tmp"};
+    } catch (const system_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+
+int main() {
+    test_mapped_file();
+
+    return 0;
+}
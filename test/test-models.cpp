@@ -25,6 +25,7 @@ void test_error_policy_models() {
     static_assert(! TextErrorPolicy<text_error_policy>());
     static_assert(TextErrorPolicy<text_strict_error_policy>());
     static_assert(TextErrorPolicy<text_permissive_error_policy>());
+    static_assert(TextErrorPolicy<text_assume_valid_error_policy>());
     static_assert(TextErrorPolicy<text_default_error_policy>());
 }
 
@@ -130,6 +131,9 @@ void test_text_encoding_models() {
     static_assert(TextEncoding<utf32_encoding>());
     static_assert(TextEncoding<utf32be_encoding>());
     static_assert(TextEncoding<utf32le_encoding>());
+    static_assert(TextEncoding<latin1_encoding>());
+    static_assert(TextEncoding<fixed_width_encoding<utf8_encoding>>());
+    static_assert(TextEncoding<fixed_width_encoding<utf16_encoding>>());
     static_assert(TextEncoding<basic_execution_character_encoding>());
     static_assert(TextEncoding<basic_execution_wide_character_encoding>());
 #if defined(__STDC_ISO_10646__)
@@ -205,6 +209,15 @@ void test_text_encoder_models() {
     static_assert(TextEncoder<
                       utf32bom_encoding,
                       char*>());
+    static_assert(TextEncoder<
+                      latin1_encoding,
+                      char*>());
+    static_assert(TextEncoder<
+                      fixed_width_encoding<utf8_encoding>,
+                      char*>());
+    static_assert(TextEncoder<
+                      fixed_width_encoding<utf16_encoding>,
+                      char16_t*>());
 }
 
 void test_text_decoder_models() {
@@ -270,6 +283,15 @@ void test_text_decoder_models() {
     static_assert(TextBidirectionalDecoder<
                       utf32bom_encoding,
                       char*>());
+    static_assert(TextRandomAccessDecoder<
+                      latin1_encoding,
+                      char*>());
+    static_assert(TextRandomAccessDecoder<
+                      fixed_width_encoding<utf8_encoding>,
+                      char*>());
+    static_assert(TextRandomAccessDecoder<
+                      fixed_width_encoding<utf16_encoding>,
+                      char16_t*>());
 
     // Expected model failures.
     static_assert(! TextRandomAccessDecoder<
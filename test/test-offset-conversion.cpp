@@ -0,0 +1,141 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+// Ensure assert is enabled regardless of build type
+#if defined(NDEBUG)
+#undef NDEBUG
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <list>
+#include <string>
+#include <vector>
+#include <experimental/text_view>
+#include "test_samples.hpp"
+
+using namespace std;
+using namespace std::experimental;
+
+
+// Checks that convert_offset() and convert_offsets(), with and without an
+// index, map offsets in each unit to the offsets of the start of the
+// character that contains them, as measured by iterating the view.  Offsets
+// are converted in increasing order, in decreasing order, and one at a time.
+template<TextEncoding ET>
+void test_convert_offsets(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    const code_unit_type_t<ET> *first = cus.data();
+    const code_unit_type_t<ET> *last = cus.data() + cus.size();
+    auto tv = make_text_view<ET, text_permissive_error_policy>(first, last);
+    list<code_unit_type_t<ET>> cul(cus.begin(), cus.end());
+    auto ltv = make_text_view<ET, text_permissive_error_policy>(cul);
+
+    // The offsets of the start of each character and of the end of the view
+    // in each unit.
+    vector<ptrdiff_t> bounds[3] = { { 0 }, { 0 }, { 0 } };
+    for (auto it = begin(tv); it != end(tv); ++it) {
+        bounds[0].push_back(end(it.base_range()) - first);
+        bounds[1].push_back(bounds[1].back() + 1);
+        bounds[2].push_back(bounds[2].back() +
+                            ((*it).get_code_point() >= 0x10000 ? 2 : 1));
+    }
+
+    const text_offset_unit units[] = {
+        text_offset_unit::code_unit,
+        text_offset_unit::code_point,
+        text_offset_unit::utf16_code_unit
+    };
+    for (int from = 0; from != 3; ++from) {
+        vector<ptrdiff_t> offsets;
+        for (ptrdiff_t o = -1; o <= bounds[from].back() + 1; ++o) {
+            offsets.push_back(o);
+        }
+        vector<ptrdiff_t> roffsets(offsets.rbegin(), offsets.rend());
+        for (int to = 0; to != 3; ++to) {
+            vector<ptrdiff_t> expected;
+            for (ptrdiff_t o : offsets) {
+                ptrdiff_t k = upper_bound(
+                    bounds[from].begin(), bounds[from].end(), o) -
+                    bounds[from].begin();
+                expected.push_back(bounds[to][k == 0 ? 0 : k - 1]);
+            }
+            vector<ptrdiff_t> rexpected(expected.rbegin(), expected.rend());
+
+            vector<ptrdiff_t> results(offsets.size());
+            convert_offsets(tv, units[from], units[to],
+                            offsets.data(), offsets.data() + offsets.size(),
+                            results.data());
+            assert(results == expected);
+            convert_offsets(ltv, units[from], units[to],
+                            offsets.data(), offsets.data() + offsets.size(),
+                            results.data());
+            assert(results == expected);
+            convert_offsets(tv, units[from], units[to],
+                            roffsets.data(),
+                            roffsets.data() + roffsets.size(),
+                            results.data());
+            assert(results == rexpected);
+            for (size_t i = 0; i != offsets.size(); ++i) {
+                assert(convert_offset(tv, units[from], units[to],
+                                      offsets[i]) == expected[i]);
+            }
+
+            for (ptrdiff_t interval : { 1, 4, 64 }) {
+                auto idx = make_text_index(tv, interval);
+                convert_offsets(idx, units[from], units[to],
+                                offsets.data(),
+                                offsets.data() + offsets.size(),
+                                results.data());
+                assert(results == expected);
+                convert_offsets(idx, units[from], units[to],
+                                roffsets.data(),
+                                roffsets.data() + roffsets.size(),
+                                results.data());
+                assert(results == rexpected);
+                auto lidx = make_text_index(ltv, interval);
+                assert(convert_offset(lidx, units[from], units[to],
+                                      offsets.back()) == expected.back());
+            }
+        }
+    }
+}
+
+void test_convert_offsets() {
+    for (const auto &s : utf8_samples) {
+        test_convert_offsets<utf8_encoding>(s);
+    }
+    for (const auto &s : make_random_utf8_samples(200, 40)) {
+        test_convert_offsets<utf8_encoding>(s);
+    }
+    string ascii(100, 'x');
+    test_convert_offsets<utf8_encoding>(
+        ascii + u8"\u00E9" + ascii + u8"\U0001F600" + ascii + "\xFF");
+    for (const auto &s : utf16_samples) {
+        test_convert_offsets<utf16_encoding>(s);
+    }
+}
+
+
+int main() {
+    // Each test is run with the implementations of every level that the
+    // processor supports, down to the scalar implementations.
+    for (int level = static_cast<int>(simd_level::avx512bw);
+         level >= static_cast<int>(simd_level::scalar);
+         --level)
+    {
+        set_simd_level_limit(static_cast<simd_level>(level));
+        if (get_simd_level() != static_cast<simd_level>(level)) {
+            continue;
+        }
+
+        test_convert_offsets();
+    }
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+// Ensure assert is enabled regardless of build type
+#if defined(NDEBUG)
+#undef NDEBUG
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <experimental/text_view>
+#include "test_samples.hpp"
+
+using namespace std;
+using namespace std::experimental;
+
+
+// Checks that iterating, and counting the characters of, a text view of a
+// basic_streambuf_view produces the same results as for a view of the same
+// code units in memory, for chunk sizes that place the boundaries of chunks
+// at every offset within characters.
+template<TextEncoding ET>
+void test_streambuf_view(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    using CUT = code_unit_type_t<ET>;
+    const CUT *first = cus.data();
+    const CUT *last = cus.data() + cus.size();
+    auto tv = make_text_view<ET, text_permissive_error_policy>(first, last);
+    vector<char32_t> expected;
+    for (const auto &ch : tv) {
+        expected.push_back(ch.get_code_point());
+    }
+
+    // A trailing partial code unit is discarded.
+    string bytes(reinterpret_cast<const char*>(first),
+                 cus.size() * sizeof(CUT));
+    if (sizeof(CUT) > 1) {
+        bytes += '\x01';
+    }
+
+    for (size_t chunk_size : { 1, 2, 3, 5, 64 }) {
+        stringbuf sb{bytes};
+        auto sv = make_streambuf_view<CUT>(&sb, chunk_size);
+        auto stv = make_text_view<ET, text_permissive_error_policy>(sv);
+        vector<char32_t> results;
+        for (const auto &ch : stv) {
+            results.push_back(ch.get_code_point());
+        }
+        assert(results == expected);
+
+        stringbuf csb{bytes};
+        auto csv = make_streambuf_view<CUT>(&csb, chunk_size);
+        auto cstv = make_text_view<ET>(csv);
+        assert(code_point_count(cstv) == ptrdiff_t(expected.size()));
+        assert(code_point_count(cstv) == 0);
+    }
+
+    // The code units at the current position are available as a chunk.
+    stringbuf sb{bytes};
+    auto sv = make_streambuf_view<CUT>(&sb, 4);
+    assert(ranges::size(sv.chunk()) == 0);
+    if (cus.size() >= 4) {
+        auto it = sv.begin();
+        assert(*it == cus[0]);
+        ++it;
+        assert(it.fill(2));
+        assert(*adl_begin(it.chunk()) == cus[1]);
+        assert(adl_begin(it.chunk())[1] == cus[2]);
+        it.consume(2);
+        assert(*it == cus[3]);
+        assert(*adl_begin(sv.chunk()) == cus[3]);
+    }
+}
+
+// A stream buffer that records the largest number of characters requested
+// by a call to sgetn().
+class sgetn_recording_stringbuf : public stringbuf {
+public:
+    using stringbuf::stringbuf;
+
+    streamsize max_request = 0;
+
+protected:
+    streamsize xsgetn(char *s, streamsize n) override {
+        max_request = max(max_request, n);
+        return stringbuf::xsgetn(s, n);
+    }
+};
+
+// Checks that counting the characters of a text view of a
+// basic_streambuf_view over runs of ill-formed code units much longer than
+// the chunk size produces the same count as for a view of the same code
+// units in memory, without buffering the runs.
+void test_streambuf_view_error_runs() {
+    string s = "a\xE0" + string(10000, '\x80') + "b\xC0" +
+               string(5000, '\xBF') + u8"\u00E9" + string(3000, '\xFF') +
+               "\xC0\xAF\xF0\x90\x80";
+    auto tv = make_text_view<utf8_encoding, text_permissive_error_policy>(
+        s.data(), s.data() + s.size());
+    ptrdiff_t expected = 0;
+    for (auto it = begin(tv); it != end(tv); ++it) {
+        ++expected;
+    }
+    assert(expected == 7);
+
+    for (size_t chunk_size : { 1, 2, 3, 7, 64 }) {
+        sgetn_recording_stringbuf sb{s};
+        auto sv = make_streambuf_view<char>(&sb, chunk_size);
+        auto stv = make_text_view<utf8_encoding>(sv);
+        assert(code_point_count(stv) == expected);
+        assert(size_t(sb.max_request) <=
+               max<size_t>(chunk_size, 2 * utf8_encoding::max_code_units));
+    }
+}
+
+void test_streambuf_view() {
+    for (const auto &s : utf8_samples) {
+        test_streambuf_view<utf8_encoding>(s);
+        test_streambuf_view<utf8bom_encoding>(u8"\uFEFF" + s);
+    }
+    for (const auto &s : make_random_utf8_samples(200, 40)) {
+        test_streambuf_view<utf8_encoding>(s);
+    }
+    // Runs of ill-formed code units that span several chunks are a single
+    // ill-formed code unit sequence.
+    test_streambuf_view<utf8_encoding>(
+        "a\xE0" + string(20, '\x80') + "b\xF0\x90\x80");
+    for (const auto &s : utf16_samples) {
+        test_streambuf_view<utf16_encoding>(s);
+    }
+}
+
+
+int main() {
+    // Each test is run with the implementations of every level that the
+    // processor supports, down to the scalar implementations.
+    for (int level = static_cast<int>(simd_level::avx512bw);
+         level >= static_cast<int>(simd_level::scalar);
+         --level)
+    {
+        set_simd_level_limit(static_cast<simd_level>(level));
+        if (get_simd_level() != static_cast<simd_level>(level)) {
+            continue;
+        }
+
+        test_streambuf_view();
+        test_streambuf_view_error_runs();
+    }
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+// Ensure assert is enabled regardless of build type
+#if defined(NDEBUG)
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <cstddef>
+#include <forward_list>
+#include <list>
+#include <string>
+#include <vector>
+#include <experimental/text_view>
+#include "test_samples.hpp"
+
+using namespace std;
+using namespace std::experimental;
+
+
+// Checks that iterators over an index of a text view reference the same
+// characters and code units as iterators of the view when advanced to any
+// position from any other.
+template<TextView TVT>
+void test_text_index(const TVT &tv, ptrdiff_t interval)
+{
+    vector<ranges::iterator_t<TVT>> refs;
+    for (auto it = begin(tv); it != end(tv); ++it) {
+        refs.push_back(it);
+    }
+    ptrdiff_t count = refs.size();
+
+    auto idx = make_text_index(tv, interval);
+    static_assert(ranges::RandomAccessIterator<decltype(begin(idx))>);
+    assert(idx.size() == count);
+    assert(idx.empty() == (count == 0));
+    assert(end(idx) - begin(idx) == count);
+    for (ptrdiff_t i = 0; i <= count; ++i) {
+        auto it = begin(idx) + i;
+        assert(it.ordinal() == i);
+        assert(it - begin(idx) == i);
+        assert(end(idx) - it == count - i);
+        assert(it == end(idx) - (count - i));
+        if (i < count) {
+            assert(*it == *refs[i]);
+            assert(it.base() == refs[i].base());
+            assert(it.get_error() == refs[i].get_error());
+        }
+    }
+    for (ptrdiff_t i = 0; i <= count; i += 7) {
+        for (ptrdiff_t j = 0; j <= count; j += 3) {
+            auto it = begin(idx) + i;
+            it += j - i;
+            assert(it.ordinal() == j);
+            assert(j == count || it.base() == refs[j].base());
+        }
+    }
+    if (count > 0) {
+        auto it = end(idx);
+        --it;
+        assert(it.ordinal() == count - 1);
+        assert(it.base() == refs[count - 1].base());
+    }
+}
+
+// Checks that locate() maps each code unit position of a text view to the
+// first character that is not decoded from code units that precede it.
+template<TextView TVT>
+requires ranges::RandomAccessIterator<typename TVT::code_unit_iterator>
+void test_text_index_locate(const TVT &tv, ptrdiff_t interval)
+{
+    auto idx = make_text_index(tv, interval);
+    auto cu_first = begin(tv.base());
+    auto cu_last = end(tv.base());
+    for (auto cu = cu_first; ; ++cu) {
+        auto it = idx.locate(cu);
+        assert(it == end(idx) || cu < end(it.base_range()));
+        if (it != begin(idx)) {
+            auto pit = it;
+            --pit;
+            assert(! (cu < end(pit.base_range())));
+        }
+        if (cu == cu_last) {
+            assert(it == end(idx));
+            break;
+        }
+    }
+}
+
+template<TextEncoding ET>
+void test_text_index(
+    const basic_string<code_unit_type_t<ET>> &cus)
+{
+    const code_unit_type_t<ET> *first = cus.data();
+    const code_unit_type_t<ET> *last = cus.data() + cus.size();
+    list<code_unit_type_t<ET>> cul(cus.begin(), cus.end());
+    forward_list<code_unit_type_t<ET>> cufl(cus.begin(), cus.end());
+    for (ptrdiff_t interval : { 1, 3, 16, 64 }) {
+        test_text_index(
+            make_text_view<ET, text_permissive_error_policy>(first, last),
+            interval);
+        test_text_index_locate(
+            make_text_view<ET, text_permissive_error_policy>(first, last),
+            interval);
+        test_text_index(
+            make_text_view<ET, text_permissive_error_policy>(cul),
+            interval);
+        test_text_index(
+            make_text_view<ET, text_permissive_error_policy>(cufl),
+            interval);
+    }
+}
+
+void test_text_index() {
+    for (const auto &s : utf8_samples) {
+        test_text_index<utf8_encoding>(s);
+        test_text_index<utf8bom_encoding>(u8"\uFEFF" + s);
+    }
+    for (const auto &s : make_random_utf8_samples(200, 40)) {
+        test_text_index<utf8_encoding>(s);
+    }
+    for (const auto &s : utf16_samples) {
+        test_text_index<utf16_encoding>(s);
+    }
+}
+
+
+int main() {
+    // Each test is run with the implementations of every level that the
+    // processor supports, down to the scalar implementations.
+    for (int level = static_cast<int>(simd_level::avx512bw);
+         level >= static_cast<int>(simd_level::scalar);
+         --level)
+    {
+        set_simd_level_limit(static_cast<simd_level>(level));
+        if (get_simd_level() != static_cast<simd_level>(level)) {
+            continue;
+        }
+
+        test_text_index();
+    }
+
+    return 0;
+}
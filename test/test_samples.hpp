@@ -0,0 +1,88 @@
+// Copyright (c) 2017, Tom Honermann
+//
+// This file is distributed under the MIT License. See the accompanying file
+// LICENSE.txt or http://www.opensource.org/licenses/mit-license.php for terms
+// and conditions.
+
+#ifndef TEXT_VIEW_TEST_SAMPLES_HPP // {
+#define TEXT_VIEW_TEST_SAMPLES_HPP
+
+
+#include <random>
+#include <string>
+#include <vector>
+
+
+// Code unit sequences that exercise each of the decoding rules of UTF-8.
+inline const std::vector<std::string> utf8_samples = {
+    "",
+    "a",
+    "Hello, world!  This is a sequence of ASCII characters.",
+    u8"\u00F8\u0800\uFFFD\U00010000\U0010FFFF",
+    u8"ASCII, then \u00E9, \u4E2D\u6587, and \U0001F600 mixed in",
+    "\x80",                     // Unexpected trailing code unit.
+    "abc\xC0\xAF",              // Overlong leading code unit.
+    "\xC2",                     // Truncated 2 code unit sequence.
+    "\xE0\x80\x80",             // Overlong 3 code unit sequence.
+    "\xE0\xA0",                 // Truncated 3 code unit sequence.
+    "\xED\xA0\x80",             // Surrogate code point.
+    "\xEF\xBF",                 // Truncated 3 code unit sequence.
+    "\xF0\x80\x80\x80",         // Overlong 4 code unit sequence.
+    "\xF0\x90\x80",             // Truncated 4 code unit sequence.
+    "\xF4\x90\x80\x80",         // Code point beyond U+10FFFF.
+    "\xF5\x80\x80\x80",         // Invalid leading code unit.
+    "\xE2\x82" "a",             // Missing third code unit.
+    "\xF0\x9F\x98" "a",         // Missing fourth code unit.
+    "abcdefgh\xFF",             // Invalid code unit after an ASCII block.
+    "abcdefghijklmnop\xC3\xA9", // Non-ASCII code unit after ASCII blocks.
+};
+
+
+// Code unit sequences that exercise each of the decoding rules of UTF-16.
+inline const std::vector<std::u16string> utf16_samples = {
+    u"",
+    u"a",
+    u"Hello, world!  This is a sequence of BMP characters.",
+    u"\u00E9\uD7FF\uE000\uFFFF\U00010000\U0010FFFF",
+    u"BMP, then \u4E2D\u6587, and \U0001F600\U0001F601 mixed in",
+    std::u16string{u'a', 0xD800, u'b'},     // Unpaired leading surrogate.
+    std::u16string{u'a', 0xDC00, u'b'},     // Unpaired trailing surrogate.
+    std::u16string{u'a', 0xDBFF},           // Truncated surrogate pair.
+    std::u16string{0xD800, 0xD800, 0xDC00}, // Leading surrogate, then a pair.
+    std::u16string{0xDFFF, 0xD800, 0xDC00}, // Trailing surrogate, then a pair.
+    std::u16string{0xD83D, 0xDE00, 0xDC00}, // Pair, then a trailing surrogate.
+};
+
+// Returns code unit sequences built by concatenating random pieces of valid
+// and invalid UTF-8 code unit sequences.
+inline std::vector<std::string>
+make_random_utf8_samples(
+    int count,
+    int max_length)
+{
+    static const char *pieces[] = {
+        "a", "Z", "0123456789", "\x7F", u8"\u00FF", u8"\u07FF",
+        u8"\u0800", u8"\uD7FF", u8"\uE000", u8"\uFFFF", u8"\U00010000",
+        u8"\U0010FFFF",
+        "\x80", "\xBF", "\xC0", "\xC1", "\xC2", "\xE0\x9F", "\xED\xA0",
+        "\xF0\x8F", "\xF4\x90", "\xF5", "\xFF", "\xE1", "\xF1\x80",
+        "\xF1\x80\x80"
+    };
+    std::mt19937 gen{20170101};
+    std::uniform_int_distribution<int> piece_dist(
+        0, sizeof(pieces) / sizeof(pieces[0]) - 1);
+    std::uniform_int_distribution<int> length_dist(0, max_length);
+    std::vector<std::string> samples;
+    for (int i = 0; i < count; ++i) {
+        std::string s;
+        int length = length_dist(gen);
+        for (int j = 0; j < length; ++j) {
+            s += pieces[piece_dist(gen)];
+        }
+        samples.push_back(s);
+    }
+    return samples;
+}
+
+
+#endif // } TEXT_VIEW_TEST_SAMPLES_HPP